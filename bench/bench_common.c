@@ -0,0 +1,213 @@
+/**
+ * @file bench_common.c
+ * @brief 벤치마크 공용 함수 (결정적 코퍼스 생성, 시계, 옵션 해석)
+ */
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench_common.h"
+
+#define CORPUS_SEED 0x5052424C // 코퍼스 시드 ("PRBL")
+
+const char *corpus_names[CORPUS_COUNT] = {"ascii", "hangul", "mixed", "emoji", "supplementary"};
+
+// 결정적 난수 (splitmix64)
+uint64_t next_random(uint64_t *state)
+{
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// 코드 포인트 하나를 UTF-8로 붙임 (자리가 없으면 false)
+static bool put_code(byte_t *buf, size_t size, size_t *pos, unicode_t code)
+{
+    size_t len = code < 0x80 ? 1 : code < 0x800 ? 2 : code < 0x10000 ? 3 : 4;
+    if (*pos + len > size)
+    {
+        return false;
+    }
+
+    byte_t *p = buf + *pos;
+    if (len == 1)
+    {
+        p[0] = (byte_t)code;
+    }
+    else if (len == 2)
+    {
+        p[0] = (byte_t)(0xC0 | (code >> 6));
+        p[1] = (byte_t)(0x80 | (code & 0x3F));
+    }
+    else if (len == 3)
+    {
+        p[0] = (byte_t)(0xE0 | (code >> 12));
+        p[1] = (byte_t)(0x80 | ((code >> 6) & 0x3F));
+        p[2] = (byte_t)(0x80 | (code & 0x3F));
+    }
+    else
+    {
+        p[0] = (byte_t)(0xF0 | (code >> 18));
+        p[1] = (byte_t)(0x80 | ((code >> 12) & 0x3F));
+        p[2] = (byte_t)(0x80 | ((code >> 6) & 0x3F));
+        p[3] = (byte_t)(0x80 | (code & 0x3F));
+    }
+    *pos += len;
+    return true;
+}
+
+// 문자열을 붙임 (자리가 없으면 false)
+static bool put_text(byte_t *buf, size_t size, size_t *pos, const char *text)
+{
+    size_t len = strlen(text);
+    if (*pos + len > size)
+    {
+        return false;
+    }
+    memcpy(buf + *pos, text, len);
+    *pos += len;
+    return true;
+}
+
+// 정확히 size 바이트의 유효한 UTF-8 코퍼스 생성 (끝에 남는 자리는 공백으로 채움)
+void generate_corpus(CorpusKind kind, byte_t *buf, size_t size)
+{
+    static const char *english[] = {"Hello", "World", "the", "quick", "brown", "fox", "jumps",
+                                     "over", "lazy", "dog", "cipher", "rotor", "Enigma", "AES",
+                                     "block", "key", "message", "secret", "and", "of"};
+    static const char *korean[] = {"안녕하세요", "세계", "암호화", "프로블레마", "애니그마",
+                                   "로터", "플러그보드", "비밀키", "한글", "메시지", "그리고", "입니다"};
+    static const char *punct[] = {" ", " ", " ", " ", ", ", ". ", "! ", "? "};
+    const size_t num_english = sizeof(english) / sizeof(english[0]);
+    const size_t num_korean = sizeof(korean) / sizeof(korean[0]);
+    const size_t num_punct = sizeof(punct) / sizeof(punct[0]);
+
+    uint64_t state = CORPUS_SEED + kind;
+    size_t pos = 0;
+    bool room = true;
+
+    while (room)
+    {
+        uint64_t r = next_random(&state);
+        switch (kind)
+        {
+        case CORPUS_ASCII:
+            room = put_text(buf, size, &pos, english[r % num_english]) &&
+                   put_text(buf, size, &pos, punct[(r >> 8) % num_punct]);
+            break;
+        case CORPUS_HANGUL:
+            // 2~5음절 단어와 띄어쓰기
+            for (uint64_t n = 2 + (r >> 8) % 4; room && n > 0; n--)
+            {
+                room = put_code(buf, size, &pos, 0xAC00 + (unicode_t)(next_random(&state) % 11172));
+            }
+            room = room && put_code(buf, size, &pos, ' ');
+            break;
+        case CORPUS_MIXED:
+            room = put_text(buf, size, &pos, (r & 1) ? korean[(r >> 8) % num_korean]
+                                                     : english[(r >> 8) % num_english]) &&
+                   put_text(buf, size, &pos, punct[(r >> 16) % num_punct]);
+            break;
+        case CORPUS_EMOJI:
+            // 이모지 세 개 중 하나 꼴로 한글이나 영어 단어를 섞음
+            if (r % 3 == 0)
+            {
+                room = put_text(buf, size, &pos, (r & 8) ? korean[(r >> 8) % num_korean]
+                                                         : english[(r >> 8) % num_english]);
+            }
+            else
+            {
+                room = put_code(buf, size, &pos, 0x1F300 + (unicode_t)((r >> 8) % 0x350));
+            }
+            room = room && ((r >> 20) % 4 != 0 || put_code(buf, size, &pos, ' '));
+            break;
+        default:
+            room = put_code(buf, size, &pos, 0x20000 + (unicode_t)((r >> 8) % 0xA6E0));
+            break;
+        }
+    }
+
+    memset(buf + pos, ' ', size - pos);
+}
+
+// 단조 시계 (초)
+double now_seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 이름 목록("a,b,c")에 name이 있는지 (목록이 NULL이면 모두 선택)
+bool selected(const char *list, const char *name)
+{
+    if (list == NULL)
+    {
+        return true;
+    }
+
+    size_t len = strlen(name);
+    for (const char *p = list; *p != '\0';)
+    {
+        const char *end = strchr(p, ',');
+        size_t n = end != NULL ? (size_t)(end - p) : strlen(p);
+        if (n == len && strncmp(p, name, n) == 0)
+        {
+            return true;
+        }
+        p += n + (end != NULL ? 1 : 0);
+    }
+    return false;
+}
+
+// 크기 인자 해석 ("64K", "16M", "1G" 허용, [min, max] 밖이면 false)
+bool parse_size(const char *text, uint64_t min, uint64_t max, uint64_t *size)
+{
+    char *end = NULL;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text)
+    {
+        return false;
+    }
+
+    int shift = 0;
+    switch (*end)
+    {
+    case 'K': case 'k': shift = 10; end++; break;
+    case 'M': case 'm': shift = 20; end++; break;
+    case 'G': case 'g': shift = 30; end++; break;
+    default: break;
+    }
+    if (value > (ULLONG_MAX >> shift))
+    {
+        return false;
+    }
+    value <<= shift;
+    *size = value;
+    return *end == '\0' && value >= min && value <= max;
+}
+
+// JSON 문자열 리터럴 출력 (따옴표, 역슬래시, 제어 문자 이스케이프)
+void print_json_string(FILE *out, const char *text)
+{
+    fputc('"', out);
+    for (const unsigned char *p = (const unsigned char *)text; *p != '\0'; p++)
+    {
+        if (*p == '"' || *p == '\\')
+        {
+            fprintf(out, "\\%c", *p);
+        }
+        else if (*p < 0x20)
+        {
+            fprintf(out, "\\u%04x", *p);
+        }
+        else
+        {
+            fputc(*p, out);
+        }
+    }
+    fputc('"', out);
+}
@@ -0,0 +1,45 @@
+/**
+ * @file bench_common.h
+ * @brief 벤치마크 공용 함수 (결정적 코퍼스 생성, 시계, 옵션 해석)
+ */
+
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "problema.h"
+
+// 코퍼스 종류
+typedef enum
+{
+    CORPUS_ASCII,         // 영어 단어와 문장 부호
+    CORPUS_HANGUL,        // 한글 음절
+    CORPUS_MIXED,         // README 예시 같은 한영 혼합 문장
+    CORPUS_EMOJI,         // 이모지 위주 (4바이트 UTF-8)
+    CORPUS_SUPPLEMENTARY, // 보충 평면 한자 (CJK 확장 B, 4바이트 UTF-8)
+    CORPUS_COUNT
+} CorpusKind;
+
+extern const char *corpus_names[CORPUS_COUNT];
+
+// 결정적 난수 (splitmix64)
+uint64_t next_random(uint64_t *state);
+
+// 정확히 size 바이트의 유효한 UTF-8 코퍼스 생성 (끝에 남는 자리는 공백으로 채움)
+void generate_corpus(CorpusKind kind, byte_t *buf, size_t size);
+
+// 단조 시계 (초)
+double now_seconds();
+
+// 이름 목록("a,b,c")에 name이 있는지 (목록이 NULL이면 모두 선택)
+bool selected(const char *list, const char *name);
+
+// 크기 인자 해석 ("64K", "16M", "1G" 허용, [min, max] 밖이거나 넘치면 false)
+bool parse_size(const char *text, uint64_t min, uint64_t max, uint64_t *size);
+
+// JSON 문자열 리터럴 출력 (따옴표, 역슬래시, 제어 문자 이스케이프)
+void print_json_string(FILE *out, const char *text);
+
+#endif
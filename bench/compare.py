@@ -0,0 +1,45 @@
+#!/usr/bin/env python3
+"""problema_bench 결과 두 개를 비교해 측정마다 처리량 변화를 출력합니다.
+
+사용법: bench/compare.py before.json after.json [--threshold 5]
+"""
+
+import argparse
+import json
+
+
+def load(path):
+    with open(path, encoding="utf-8") as f:
+        data = json.load(f)
+    return data, {(r["corpus"], r["size"], r["api"], r["profile"]): r for r in data["results"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="problema_bench 결과 비교")
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument("--threshold", type=float, default=5.0,
+                        help="이 비율(%%) 이상 바뀐 측정에 표시를 붙임 (기본 5)")
+    args = parser.parse_args()
+
+    before_info, before = load(args.before)
+    after_info, after = load(args.after)
+    print(f"{before_info.get('label') or args.before} -> {after_info.get('label') or args.after}")
+    print(f"{'corpus':<14}{'size':>12}  {'api':<24}{'before MB/s':>14}{'after MB/s':>14}{'change':>10}")
+
+    for key in sorted(before.keys() & after.keys(), key=lambda k: (k[0], k[1], k[2], k[3] or "")):
+        old = before[key]["mb_per_s"]
+        new = after[key]["mb_per_s"]
+        change = (new - old) / old * 100 if old > 0 else 0.0
+        mark = " *" if abs(change) >= args.threshold else ""
+        corpus, size, api, profile = key
+        name = f"{api}/{profile}" if profile else api
+        print(f"{corpus:<14}{size:>12}  {name:<24}{old:>14.2f}{new:>14.2f}{change:>+9.1f}%{mark}")
+
+    missing = before.keys() ^ after.keys()
+    if missing:
+        print(f"한쪽에만 있는 측정 {len(missing)}개는 건너뜀")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,349 @@
+/**
+ * @file problema_bench.c
+ * @brief 프로블레마 처리량 벤치마크
+ *
+ * 결정적으로 생성한 코퍼스(ASCII, 한글, 한영 혼합, 이모지, 보충 평면)와 16B~1GB 메시지 크기에서
+ * 문자열 API, 문자 API, 블록 API, UTF-8 변환 함수의 MB/s와 문자/s를 재어 JSON으로 출력합니다.
+ * 같은 옵션으로 커밋마다 실행한 결과를 bench/compare.py로 비교합니다.
+ *
+ * 빌드: gcc -O2 -pthread -I. -o problema_bench bench/problema_bench.c bench/bench_common.c problema.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <time.h>
+#include "problema.h"
+#include "bench_common.h"
+
+#define BENCH_MIN_SIZE 16                        // 가장 작은 메시지 크기 (바이트)
+#define BENCH_MAX_SIZE (1024ULL * 1024 * 1024)   // 가장 큰 메시지 크기 (바이트)
+#define BENCH_DEFAULT_MAX_SIZE (16 * 1024 * 1024) // 기본 최대 크기 (--max-size로 1GB까지)
+#define BENCH_SIZE_STEP 4                        // 크기 배수 (16B에서 1GB까지 정확히 닿음)
+#define BENCH_DEFAULT_MIN_TIME 0.2               // 측정 하나의 최소 시간 (초)
+#define BENCH_TRIALS 3                           // 반복 측정 횟수 (가장 빠른 값을 보고)
+
+// 측정 대상 API
+typedef enum
+{
+    API_ENCRYPT,        // problema_encrypt
+    API_DECRYPT,        // problema_decrypt
+    API_ENCRYPT_CHAR,   // problema_encrypt_char
+    API_DECRYPT_CHAR,   // problema_decrypt_char
+    API_ENCRYPT_BLOCKS, // problema_encrypt_blocks
+    API_DECRYPT_BLOCKS, // problema_decrypt_blocks
+    API_UTF8_DECODE,    // utf8_to_unicode
+    API_UTF8_ENCODE,    // unicode_to_utf8
+    API_COUNT
+} BenchApi;
+
+static const char *api_names[API_COUNT] = {
+    "encrypt", "decrypt", "encrypt_char", "decrypt_char", "encrypt_blocks", "decrypt_blocks",
+    "utf8_to_unicode", "unicode_to_utf8"};
+
+static const char *profile_names[] = {"compat", "full", "aes"};
+
+// 측정 하나에 필요한 입력과 버퍼
+typedef struct
+{
+    ProblemaContext *ctx;
+    const byte_t *text;      // 코퍼스 (UTF-8)
+    size_t text_len;
+    const byte_t *cipher;    // 코퍼스 암호문
+    size_t cipher_len;
+    unicode_t *codes;        // 코퍼스 코드 포인트
+    size_t num_chars;
+    byte_t *out;             // 출력 버퍼
+    size_t out_size;
+    unicode_t *code_out;     // 코드 포인트 출력 버퍼
+} BenchInput;
+
+// API 한 번 실행 (실패 시 오류 코드)
+int run_api(BenchApi api, BenchInput *in)
+{
+    size_t len = 0;
+    size_t blocks = in->text_len / PROBLEMA_BLOCK_SIZE;
+
+    switch (api)
+    {
+    case API_ENCRYPT:
+        problema_reset(in->ctx);
+        return problema_encrypt(in->ctx, in->text, in->text_len, in->out, in->out_size, &len);
+    case API_DECRYPT:
+        problema_reset(in->ctx);
+        return problema_decrypt(in->ctx, in->cipher, in->cipher_len, in->out, in->out_size, &len);
+    case API_ENCRYPT_CHAR:
+        problema_reset(in->ctx);
+        for (size_t i = 0; i < in->num_chars; i++)
+        {
+            in->code_out[i] = problema_encrypt_char(in->ctx, in->codes[i]);
+        }
+        return PROBLEMA_SUCCESS;
+    case API_DECRYPT_CHAR:
+        problema_reset(in->ctx);
+        for (size_t i = 0; i < in->num_chars; i++)
+        {
+            in->code_out[i] = problema_decrypt_char(in->ctx, in->codes[i]);
+        }
+        return PROBLEMA_SUCCESS;
+    case API_ENCRYPT_BLOCKS:
+        problema_reset(in->ctx);
+        return problema_encrypt_blocks(in->ctx, in->text, in->out, blocks);
+    case API_DECRYPT_BLOCKS:
+        problema_reset(in->ctx);
+        return problema_decrypt_blocks(in->ctx, in->text, in->out, blocks);
+    case API_UTF8_DECODE:
+        return utf8_to_unicode(in->text, in->text_len, in->code_out, in->num_chars, &len);
+    default:
+        return unicode_to_utf8(in->codes, in->num_chars, in->out, in->out_size, &len);
+    }
+}
+
+// 최소 시간을 넘을 때까지 반복해 가장 빠른 회차의 한 번당 시간을 구함
+int measure(BenchApi api, BenchInput *in, double min_time, double *seconds, uint64_t *iterations)
+{
+    int result = run_api(api, in); // 캐시와 페이지를 데우고 오류 확인
+    if (result != PROBLEMA_SUCCESS)
+    {
+        return result;
+    }
+
+    *seconds = 0;
+    *iterations = 0;
+    for (int t = 0; t < BENCH_TRIALS; t++)
+    {
+        uint64_t n = 0;
+        double start = now_seconds(), elapsed = 0;
+        do
+        {
+            run_api(api, in);
+            n++;
+            elapsed = now_seconds() - start;
+        } while (elapsed < min_time / BENCH_TRIALS);
+
+        if (*iterations == 0 || elapsed / n < *seconds)
+        {
+            *seconds = elapsed / n;
+        }
+        *iterations += n;
+    }
+    return PROBLEMA_SUCCESS;
+}
+
+// 다음 메시지 크기: BENCH_SIZE_STEP배씩 늘리되 마지막은 항상 max_size (끝이면 0)
+uint64_t next_size(uint64_t size, uint64_t max_size)
+{
+    if (size >= max_size)
+    {
+        return 0;
+    }
+    return size * BENCH_SIZE_STEP < max_size ? size * BENCH_SIZE_STEP : max_size;
+}
+
+// 결과 한 줄 출력 (JSON 배열 원소)
+void print_result(FILE *out, bool *first, const char *corpus, size_t size, BenchApi api,
+                  const char *profile, uint64_t bytes, uint64_t chars, uint64_t iterations,
+                  double seconds)
+{
+    fprintf(out, "%s\n    {\"corpus\": \"%s\", \"size\": %zu, \"api\": \"%s\", \"profile\": %s%s%s, "
+                 "\"bytes\": %" PRIu64 ", \"chars\": %" PRIu64 ", \"iterations\": %" PRIu64 ", "
+                 "\"seconds\": %.9f, \"mb_per_s\": %.3f, \"chars_per_s\": %.0f}",
+            *first ? "" : ",", corpus, size, api_names[api],
+            profile != NULL ? "\"" : "", profile != NULL ? profile : "null", profile != NULL ? "\"" : "",
+            bytes, chars, iterations, seconds, bytes / seconds / 1e6, chars / seconds);
+    *first = false;
+    fflush(out);
+}
+
+void print_usage()
+{
+    printf("사용법: problema_bench [옵션]\n");
+    printf("  --corpus LIST     코퍼스 (ascii,hangul,mixed,emoji,supplementary, 기본 모두)\n");
+    printf("  --api LIST        API (encrypt,decrypt,encrypt_char,decrypt_char,encrypt_blocks,\n");
+    printf("                    decrypt_blocks,utf8_to_unicode,unicode_to_utf8, 기본 모두)\n");
+    printf("  --max-size SIZE   가장 큰 메시지 크기 (16~1G, 기본 16M, 크기는 4배씩 늘고 마지막은 SIZE)\n");
+    printf("  --min-time SEC    측정 하나의 최소 시간 (기본 0.2초)\n");
+    printf("  --label TEXT      결과에 남길 이름 (예: 커밋 해시)\n");
+    printf("  -o, --output FILE 결과 JSON 파일 (기본 표준 출력)\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *corpus_list = NULL;
+    const char *api_list = NULL;
+    const char *label = "";
+    const char *output_file = NULL;
+    uint64_t max_size = BENCH_DEFAULT_MAX_SIZE;
+    double min_time = BENCH_DEFAULT_MIN_TIME;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--corpus") == 0 && has_value)
+        {
+            corpus_list = argv[++i];
+        }
+        else if (strcmp(argv[i], "--api") == 0 && has_value)
+        {
+            api_list = argv[++i];
+        }
+        else if (strcmp(argv[i], "--max-size") == 0 && has_value)
+        {
+            if (!parse_size(argv[++i], BENCH_MIN_SIZE, BENCH_MAX_SIZE, &max_size))
+            {
+                fprintf(stderr, "오류: 크기는 16부터 1G 사이여야 합니다.\n");
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--min-time") == 0 && has_value)
+        {
+            min_time = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--label") == 0 && has_value)
+        {
+            label = argv[++i];
+        }
+        else if ((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) && has_value)
+        {
+            output_file = argv[++i];
+        }
+        else
+        {
+            print_usage();
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    FILE *out = output_file != NULL ? fopen(output_file, "w") : stdout;
+    if (out == NULL)
+    {
+        fprintf(stderr, "오류: 출력 파일 '%s'을(를) 열 수 없습니다.\n", output_file);
+        return 1;
+    }
+
+    byte_t key[PROBLEMA_KEY_SIZE];
+    for (int i = 0; i < PROBLEMA_KEY_SIZE; i++)
+    {
+        key[i] = (byte_t)(i * 7 + 1);
+    }
+
+    ProblemaContext *ctx = NULL;
+    int result = problema_context_new(&ctx, key, NULL, PROBLEMA_CONTEXT_HUGE_PAGES);
+    if (result != PROBLEMA_SUCCESS)
+    {
+        fprintf(stderr, "오류: 컨텍스트 초기화 실패: %s\n", problema_error_string(result));
+        return 1;
+    }
+
+    time_t now = time(NULL);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    fprintf(out, "{\n  \"label\": ");
+    print_json_string(out, label);
+    fprintf(out, ", \"date\": \"%s\", \"block_kernel\": \"%s\", "
+                 "\"aes_kernel\": \"%s\", \"min_time\": %.3f,\n  \"results\": [",
+            date, problema_block_kernel(), problema_aes_kernel(), min_time);
+
+    bool first = true;
+    for (int c = 0; c < CORPUS_COUNT && result == PROBLEMA_SUCCESS; c++)
+    {
+        if (!selected(corpus_list, corpus_names[c]))
+        {
+            continue;
+        }
+
+        for (uint64_t size = BENCH_MIN_SIZE; size != 0 && result == PROBLEMA_SUCCESS;
+             size = next_size(size, max_size))
+        {
+            // 입력 준비: 코퍼스, 코드 포인트, 암호문 (출력 버퍼는 가장 긴 결과에 맞춤)
+            BenchInput in = {0};
+            in.ctx = ctx;
+            in.text_len = size;
+            byte_t *text = (byte_t *)malloc(size);
+            unicode_t *codes = (unicode_t *)malloc(size * sizeof(unicode_t));
+            in.code_out = (unicode_t *)malloc(size * sizeof(unicode_t));
+            if (text == NULL || codes == NULL || in.code_out == NULL)
+            {
+                fprintf(stderr, "오류: %" PRIu64 " 바이트 입력을 위한 메모리가 부족합니다.\n", size);
+                result = PROBLEMA_ERROR_OUT_OF_MEMORY;
+                free(text);
+                free(codes);
+                free(in.code_out);
+                break;
+            }
+            generate_corpus((CorpusKind)c, text, size);
+            in.text = text;
+            utf8_to_unicode(text, size, codes, size, &in.num_chars);
+            in.codes = codes;
+
+            size_t cipher_len = 0, plain_len = 0;
+            problema_reset(ctx);
+            problema_encrypt_length(ctx, text, size, &cipher_len);
+            byte_t *cipher = (byte_t *)malloc(cipher_len > 0 ? cipher_len : 1);
+            if (cipher != NULL)
+            {
+                problema_encrypt(ctx, text, size, cipher, cipher_len, &in.cipher_len);
+                problema_reset(ctx);
+                problema_decrypt_length(ctx, cipher, in.cipher_len, &plain_len);
+            }
+            in.cipher = cipher;
+            in.out_size = cipher_len > plain_len ? cipher_len : plain_len;
+            in.out_size = in.out_size > size ? in.out_size : size;
+            in.out = (byte_t *)malloc(in.out_size);
+
+            for (int a = 0; a < API_COUNT && cipher != NULL && in.out != NULL; a++)
+            {
+                BenchApi api = (BenchApi)a;
+                if (!selected(api_list, api_names[api]))
+                {
+                    continue;
+                }
+
+                // 블록 API는 코퍼스마다 프로필별로 잰다 (블록 하나보다 작은 크기는 건너뜀)
+                bool block_api = api == API_ENCRYPT_BLOCKS || api == API_DECRYPT_BLOCKS;
+                if (block_api && size < PROBLEMA_BLOCK_SIZE)
+                {
+                    continue;
+                }
+
+                int profiles = block_api ? 3 : 1;
+                for (int p = 0; p < profiles; p++)
+                {
+                    double seconds = 0;
+                    uint64_t iterations = 0;
+                    problema_set_block_profile(ctx, p);
+                    int status = measure(api, &in, min_time, &seconds, &iterations);
+                    problema_set_block_profile(ctx, PROBLEMA_BLOCK_PROFILE_COMPAT);
+                    if (status != PROBLEMA_SUCCESS)
+                    {
+                        fprintf(stderr, "경고: %s/%" PRIu64 "/%s 실패: %s\n", corpus_names[c], size,
+                                api_names[api], problema_error_string(status));
+                        continue;
+                    }
+
+                    uint64_t bytes = block_api ? size / PROBLEMA_BLOCK_SIZE * PROBLEMA_BLOCK_SIZE
+                                     : api == API_DECRYPT ? in.cipher_len : size;
+                    uint64_t chars = block_api ? 0 : in.num_chars;
+                    print_result(out, &first, corpus_names[c], size, api,
+                                 block_api ? profile_names[p] : NULL, bytes, chars, iterations, seconds);
+                }
+            }
+
+            free(in.out);
+            free(cipher);
+            free(in.code_out);
+            free(codes);
+            free(text);
+        }
+    }
+
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    problema_context_free(ctx);
+    return result == PROBLEMA_SUCCESS ? 0 : 1;
+}
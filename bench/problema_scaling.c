@@ -0,0 +1,489 @@
+/**
+ * @file problema_scaling.c
+ * @brief 프로블레마 스레드 확장성 벤치마크
+ *
+ * 스레드 N개(1부터 전체 코어까지)가 각자 메시지를 반복 암호화하는 동안의 처리량을 잽니다.
+ * shared 모드는 컨텍스트 하나의 테이블을 모든 스레드가 공유하고 스레드마다 ProblemaCursor를
+ * 쓰며, private 모드는 스레드마다 자기 컨텍스트(키당 테이블 한 벌)를 만듭니다.
+ * 합계/스레드별 처리량, 확장 효율, 작업 집합 대비 L3 크기를 JSON으로 출력하고,
+ * 효율이 처음 떨어지는 스레드 수를 포화 지점으로 보고합니다.
+ *
+ * 빌드: gcc -O2 -pthread -I. -o problema_scaling bench/problema_scaling.c bench/bench_common.c problema.c
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include "problema.h"
+#include "bench_common.h"
+
+#define SCALING_DEFAULT_SIZE (64 * 1024) // 기본 메시지 크기 (바이트)
+#define SCALING_DEFAULT_DURATION 1.0     // 측정 하나의 기본 시간 (초)
+#define SCALING_EFFICIENCY_LIMIT 0.8     // 이보다 효율이 낮아지면 포화로 본다
+#define SCALING_MAX_THREADS 1024         // 측정할 수 있는 최대 스레드 수
+
+// 테이블 배치
+typedef enum
+{
+    MODE_SHARED,  // 컨텍스트 하나 + 스레드별 커서
+    MODE_PRIVATE, // 스레드별 컨텍스트
+    MODE_COUNT
+} ScalingMode;
+
+static const char *mode_names[MODE_COUNT] = {"shared", "private"};
+
+// 한 번의 측정 (스레드 N개)
+typedef struct
+{
+    ScalingMode mode;
+    ProblemaContext *shared;     // shared 모드의 공유 컨텍스트
+    const byte_t *key;           // private 모드의 컨텍스트 키
+    const byte_t *text;          // 입력 메시지 (모든 스레드가 읽기만 함)
+    size_t text_len;
+    size_t out_size;             // 스레드별 출력 버퍼 크기
+    bool pin;                    // 스레드 i를 CPU i에 고정
+    atomic_int ready;            // 준비를 마친 스레드 수
+    atomic_bool start;           // 측정 시작 (모든 스레드가 함께 출발)
+    atomic_bool stop;            // 측정 종료
+} ScalingRun;
+
+// 스레드별 결과 (거짓 공유를 막으려고 캐시 라인 단위로 둔다)
+typedef struct
+{
+    _Alignas(64) ScalingRun *run;
+    int id;
+    uint64_t bytes;   // 암호화한 입력 바이트 수
+    double seconds;   // 측정 시간
+    int status;       // 실패 시 오류 코드
+} ScalingWorker;
+
+// 온라인 CPU 수
+int online_cpus()
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+// CPU 0에서 보이는 L3 캐시 크기 (바이트, 모르면 0). 소켓이 여럿이면 소켓 하나의 크기다
+uint64_t l3_cache_size()
+{
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    long size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (size > 0)
+    {
+        return (uint64_t)size;
+    }
+#endif
+    FILE *fp = fopen("/sys/devices/system/cpu/cpu0/cache/index3/size", "r");
+    if (fp == NULL)
+    {
+        return 0;
+    }
+    unsigned long long value = 0;
+    char unit = 0;
+    int n = fscanf(fp, "%llu%c", &value, &unit);
+    fclose(fp);
+    if (n < 1)
+    {
+        return 0;
+    }
+    return unit == 'K' ? value << 10 : unit == 'M' ? value << 20 : value;
+}
+
+// 작업 스레드: 준비(고정, 컨텍스트/버퍼 할당) 뒤 출발 신호부터 종료 신호까지 반복 암호화
+void *scaling_worker(void *arg)
+{
+    ScalingWorker *worker = (ScalingWorker *)arg;
+    ScalingRun *run = worker->run;
+    ProblemaContext *ctx = run->shared;
+    ProblemaCursor cursor;
+
+    if (run->pin)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(worker->id % online_cpus(), &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    // private 모드의 테이블은 스레드가 직접 만들어 자기 NUMA 노드에 놓이게 한다
+    byte_t *out = (byte_t *)malloc(run->out_size);
+    if (run->mode == MODE_PRIVATE)
+    {
+        ctx = NULL;
+        worker->status = problema_context_new(&ctx, run->key, NULL, PROBLEMA_CONTEXT_HUGE_PAGES);
+    }
+    if (out == NULL && worker->status == PROBLEMA_SUCCESS)
+    {
+        worker->status = PROBLEMA_ERROR_OUT_OF_MEMORY;
+    }
+    if (worker->status == PROBLEMA_SUCCESS)
+    {
+        worker->status = problema_cursor_init(&cursor, ctx);
+    }
+
+    atomic_fetch_add(&run->ready, 1);
+    while (!atomic_load(&run->start))
+    {
+        sched_yield();
+    }
+
+    double start = now_seconds();
+    uint64_t bytes = 0;
+    while (worker->status == PROBLEMA_SUCCESS && !atomic_load_explicit(&run->stop, memory_order_relaxed))
+    {
+        // 매 메시지를 키의 시작 상태에서 처리 (problema_encrypt 한 번과 같은 일)
+        ProblemaState initial = cursor.state;
+        size_t len = 0;
+        worker->status = problema_cursor_encrypt(&cursor, run->text, run->text_len, out, run->out_size, &len);
+        cursor.state = initial;
+        bytes += run->text_len;
+    }
+    worker->seconds = now_seconds() - start;
+    worker->bytes = bytes;
+
+    if (run->mode == MODE_PRIVATE)
+    {
+        problema_context_free(ctx);
+    }
+    free(out);
+    return NULL;
+}
+
+// 스레드 N개로 한 번 측정하고 스레드별 처리량(MB/s)을 채움 (실패 시 오류 코드)
+int run_scaling(ScalingRun *run, int threads, double duration, double *mb_per_s)
+{
+    ScalingWorker *workers = (ScalingWorker *)aligned_alloc(64, threads * sizeof(ScalingWorker));
+    pthread_t *handles = (pthread_t *)calloc(threads, sizeof(pthread_t));
+    if (workers == NULL || handles == NULL)
+    {
+        free(workers);
+        free(handles);
+        return PROBLEMA_ERROR_OUT_OF_MEMORY;
+    }
+
+    atomic_store(&run->ready, 0);
+    atomic_store(&run->start, false);
+    atomic_store(&run->stop, false);
+
+    int created = 0;
+    for (int t = 0; t < threads; t++)
+    {
+        memset(&workers[t], 0, sizeof(ScalingWorker));
+        workers[t].run = run;
+        workers[t].id = t;
+        if (pthread_create(&handles[t], NULL, scaling_worker, &workers[t]) != 0)
+        {
+            break;
+        }
+        created++;
+    }
+
+    int result = PROBLEMA_SUCCESS;
+    if (created < threads)
+    {
+        // 이미 만든 스레드는 출발하자마자 멈춘다
+        fprintf(stderr, "오류: 스레드 %d개 중 %d개만 만들었습니다.\n", threads, created);
+        atomic_store(&run->stop, true);
+        result = PROBLEMA_ERROR_OUT_OF_MEMORY;
+        for (int t = created; t < threads; t++)
+        {
+            workers[t].status = PROBLEMA_ERROR_OUT_OF_MEMORY;
+        }
+    }
+
+    if (created == threads)
+    {
+        while (atomic_load(&run->ready) < threads)
+        {
+            sched_yield();
+        }
+        atomic_store(&run->start, true);
+        struct timespec ts = {(time_t)duration, (long)((duration - (time_t)duration) * 1e9)};
+        nanosleep(&ts, NULL);
+        atomic_store(&run->stop, true);
+    }
+    atomic_store(&run->start, true);
+
+    for (int t = 0; t < created; t++)
+    {
+        pthread_join(handles[t], NULL);
+    }
+
+    for (int t = 0; t < threads && result == PROBLEMA_SUCCESS; t++)
+    {
+        if (workers[t].status != PROBLEMA_SUCCESS)
+        {
+            result = workers[t].status;
+        }
+        mb_per_s[t] = workers[t].seconds > 0 ? workers[t].bytes / workers[t].seconds / 1e6 : 0;
+    }
+
+    free(handles);
+    free(workers);
+    return result;
+}
+
+void print_usage()
+{
+    printf("사용법: problema_scaling [옵션]\n");
+    printf("  --mode LIST       테이블 배치 (shared,private, 기본 모두)\n");
+    printf("  --threads LIST    스레드 수 목록 (예: 1,2,4,8, 기본 1부터 2배씩 온라인 CPU 수까지)\n");
+    printf("  --corpus NAME     메시지 코퍼스 (ascii,hangul,mixed,emoji,supplementary, 기본 mixed)\n");
+    printf("  --size SIZE       메시지 크기 (기본 64K)\n");
+    printf("  --duration SEC    측정 하나의 시간 (기본 1초)\n");
+    printf("  --pin             스레드 i를 CPU i에 고정\n");
+    printf("  --label TEXT      결과에 남길 이름 (예: 커밋 해시, 호스트 이름)\n");
+    printf("  -o, --output FILE 결과 JSON 파일 (기본 표준 출력)\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *mode_list = NULL;
+    const char *label = "";
+    const char *output_file = NULL;
+    CorpusKind corpus = CORPUS_MIXED;
+    uint64_t size = SCALING_DEFAULT_SIZE;
+    double duration = SCALING_DEFAULT_DURATION;
+    bool pin = false;
+    int thread_counts[64];
+    int num_counts = 0;
+    int cpus = online_cpus();
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--mode") == 0 && has_value)
+        {
+            mode_list = argv[++i];
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && has_value)
+        {
+            char *p = argv[++i];
+            while (*p != '\0' && num_counts < 64)
+            {
+                char *end = NULL;
+                long n = strtol(p, &end, 10);
+                if (end == p || n < 1 || n > SCALING_MAX_THREADS || (*end != ',' && *end != '\0'))
+                {
+                    fprintf(stderr, "오류: 스레드 수는 1부터 %d 사이의 쉼표 목록이어야 합니다.\n",
+                            SCALING_MAX_THREADS);
+                    return 1;
+                }
+                thread_counts[num_counts++] = (int)n;
+                p = *end == ',' ? end + 1 : end;
+            }
+        }
+        else if (strcmp(argv[i], "--corpus") == 0 && has_value)
+        {
+            i++;
+            int c = 0;
+            while (c < CORPUS_COUNT && strcmp(argv[i], corpus_names[c]) != 0)
+            {
+                c++;
+            }
+            if (c == CORPUS_COUNT)
+            {
+                fprintf(stderr, "오류: 알 수 없는 코퍼스 '%s'\n", argv[i]);
+                return 1;
+            }
+            corpus = (CorpusKind)c;
+        }
+        else if (strcmp(argv[i], "--size") == 0 && has_value)
+        {
+            if (!parse_size(argv[++i], 16, 1ULL << 30, &size))
+            {
+                fprintf(stderr, "오류: 크기는 16부터 1G 사이여야 합니다.\n");
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--duration") == 0 && has_value)
+        {
+            duration = atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--pin") == 0)
+        {
+            pin = true;
+        }
+        else if (strcmp(argv[i], "--label") == 0 && has_value)
+        {
+            label = argv[++i];
+        }
+        else if ((strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) && has_value)
+        {
+            output_file = argv[++i];
+        }
+        else
+        {
+            print_usage();
+            return strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0 ? 0 : 1;
+        }
+    }
+
+    // 기본 스레드 수: 1, 2, 4, ... 와 온라인 CPU 수
+    if (num_counts == 0)
+    {
+        for (int n = 1; n < cpus && num_counts < 63; n *= 2)
+        {
+            thread_counts[num_counts++] = n;
+        }
+        thread_counts[num_counts++] = cpus;
+    }
+
+    FILE *out = output_file != NULL ? fopen(output_file, "w") : stdout;
+    if (out == NULL)
+    {
+        fprintf(stderr, "오류: 출력 파일 '%s'을(를) 열 수 없습니다.\n", output_file);
+        return 1;
+    }
+
+    byte_t key[PROBLEMA_KEY_SIZE];
+    for (int i = 0; i < PROBLEMA_KEY_SIZE; i++)
+    {
+        key[i] = (byte_t)(i * 7 + 1);
+    }
+
+    ProblemaContext *shared = NULL;
+    int result = problema_context_new(&shared, key, NULL, PROBLEMA_CONTEXT_HUGE_PAGES);
+    byte_t *text = (byte_t *)malloc(size);
+    if (result != PROBLEMA_SUCCESS || text == NULL)
+    {
+        fprintf(stderr, "오류: 벤치마크 준비 실패: %s\n",
+                problema_error_string(result != PROBLEMA_SUCCESS ? result : PROBLEMA_ERROR_OUT_OF_MEMORY));
+        return 1;
+    }
+    generate_corpus(corpus, text, size);
+
+    size_t out_size = 0;
+    problema_encrypt_length(shared, text, size, &out_size);
+
+    // 작업 집합 추정: 테이블 전체 + 스레드별 입출력 버퍼 (실제로 닿는 테이블 항목은 코퍼스에 따라 더 적다)
+    ProblemaMemoryUsage memory;
+    problema_memory_usage(shared, &memory);
+    uint64_t l3 = l3_cache_size();
+
+    time_t now = time(NULL);
+    char date[32];
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    fprintf(out, "{\n  \"label\": ");
+    print_json_string(out, label);
+    fprintf(out, ", \"date\": \"%s\", \"cpus\": %d, \"l3_bytes\": %" PRIu64 ", "
+                 "\"corpus\": \"%s\", \"message_size\": %" PRIu64 ", \"duration\": %.3f, \"pinned\": %s, "
+                 "\"table_bytes\": %zu,\n  \"results\": [",
+            date, cpus, l3, corpus_names[corpus], size, duration, pin ? "true" : "false",
+            memory.shared_bytes);
+
+    ScalingRun run;
+    memset(&run, 0, sizeof(run));
+    run.shared = shared;
+    run.key = key;
+    run.text = text;
+    run.text_len = size;
+    run.out_size = out_size > 0 ? out_size : 1;
+    run.pin = pin;
+
+    bool first = true;
+    int saturation[MODE_COUNT] = {0};
+    int l3_exceeded[MODE_COUNT] = {0};
+    for (int m = 0; m < MODE_COUNT && result == PROBLEMA_SUCCESS; m++)
+    {
+        if (!selected(mode_list, mode_names[m]))
+        {
+            continue;
+        }
+
+        run.mode = (ScalingMode)m;
+        double single = 0;
+        for (int k = 0; k < num_counts && result == PROBLEMA_SUCCESS; k++)
+        {
+            int threads = thread_counts[k];
+            double *mb_per_s = (double *)calloc(threads, sizeof(double));
+            result = mb_per_s != NULL ? run_scaling(&run, threads, duration, mb_per_s)
+                                      : PROBLEMA_ERROR_OUT_OF_MEMORY;
+            if (result != PROBLEMA_SUCCESS)
+            {
+                fprintf(stderr, "오류: %s 모드 스레드 %d개 측정 실패: %s\n", mode_names[m], threads,
+                        problema_error_string(result));
+                free(mb_per_s);
+                break;
+            }
+
+            double total = 0, lo = mb_per_s[0], hi = mb_per_s[0];
+            for (int t = 0; t < threads; t++)
+            {
+                total += mb_per_s[t];
+                lo = mb_per_s[t] < lo ? mb_per_s[t] : lo;
+                hi = mb_per_s[t] > hi ? mb_per_s[t] : hi;
+            }
+
+            // 효율은 같은 모드의 첫 측정(보통 스레드 1개)의 스레드당 처리량 기준
+            if (k == 0)
+            {
+                single = total / threads;
+            }
+            double efficiency = single > 0 ? total / (threads * single) : 0;
+            uint64_t buffers = (uint64_t)threads * (size + run.out_size);
+            uint64_t working_set = m == MODE_SHARED ? memory.shared_bytes + buffers
+                                                    : (uint64_t)threads * memory.allocated_bytes + buffers;
+            if (saturation[m] == 0 && efficiency < SCALING_EFFICIENCY_LIMIT)
+            {
+                saturation[m] = threads;
+            }
+            if (l3_exceeded[m] == 0 && l3 > 0 && working_set > l3)
+            {
+                l3_exceeded[m] = threads;
+            }
+
+            fprintf(out, "%s\n    {\"mode\": \"%s\", \"threads\": %d, \"aggregate_mb_per_s\": %.3f, "
+                         "\"per_thread_mb_per_s\": {\"min\": %.3f, \"mean\": %.3f, \"max\": %.3f, \"all\": [",
+                    first ? "" : ",", mode_names[m], threads, total, lo, total / threads, hi);
+            for (int t = 0; t < threads; t++)
+            {
+                fprintf(out, "%s%.3f", t > 0 ? ", " : "", mb_per_s[t]);
+            }
+            fprintf(out, "]}, \"efficiency\": %.3f, \"working_set_bytes\": %" PRIu64 "}", efficiency,
+                    working_set);
+            fflush(out);
+            first = false;
+
+            fprintf(stderr, "%-8s %4d 스레드: 합계 %10.2f MB/s, 스레드당 %8.2f~%8.2f MB/s, 효율 %5.1f%%\n",
+                    mode_names[m], threads, total, lo, hi, efficiency * 100);
+            free(mb_per_s);
+        }
+    }
+
+    // 포화 지점: 효율이 처음 한계 아래로 떨어진 스레드 수와 작업 집합이 처음 L3를 넘은 스레드 수 (없으면 null)
+    fprintf(out, "\n  ],\n  \"saturation\": {");
+    bool first_mode = true;
+    for (int m = 0; m < MODE_COUNT; m++)
+    {
+        if (!selected(mode_list, mode_names[m]))
+        {
+            continue;
+        }
+        fprintf(out, "%s\"%s\": {\"efficiency_limit\": %.2f, \"efficiency_below_at\": ",
+                first_mode ? "" : ", ", mode_names[m], SCALING_EFFICIENCY_LIMIT);
+        fprintf(out, saturation[m] > 0 ? "%d" : "null", saturation[m]);
+        fprintf(out, ", \"l3_exceeded_at\": ");
+        fprintf(out, l3_exceeded[m] > 0 ? "%d" : "null", l3_exceeded[m]);
+        fprintf(out, "}");
+        first_mode = false;
+    }
+    fprintf(out, "}\n}\n");
+
+    if (out != stdout)
+    {
+        fclose(out);
+    }
+    free(text);
+    problema_context_free(shared);
+    return result == PROBLEMA_SUCCESS ? 0 : 1;
+}
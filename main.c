@@ -1,11 +1,81 @@
+// fseeko, st_mtim 등 POSIX.1-2008 선언 (-std=c11에서도 보이도록 헤더보다 먼저 정의)
+#define _POSIX_C_SOURCE 200809L
+#define _FILE_OFFSET_BITS 64
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <inttypes.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
 #include "problema.h"
 
-#define MAX_INPUT_SIZE 4096
-#define MAX_OUTPUT_SIZE 8192
+#define READ_CHUNK_SIZE 65536
+#define DEFAULT_CHECKPOINT_INTERVAL (1024 * 1024)
+
+// 바이너리 모드 형식: 매직(4) 버전(1) 블록 프로필(1) 예약(2) 키 지문(8, LE) IV(16)
+#define BINARY_MAGIC "PRBB"
+#define BINARY_VERSION 1
+#define BINARY_HEADER_SIZE 32
+#define BINARY_CHUNK_SIZE (1024 * 1024)
+
+// 탐색 인덱스 파일 형식: 매직(4) 버전 간격 전체 문자 수 전체 바이트 수 항목 수 원본 수정 시각(ns)
+// 원본 표본 해시 (각 8바이트, LE) 뒤에 항목(문자 인덱스 8, 바이트 위치 8, LE) x 항목 수
+#define INDEX_MAGIC "PRBI"
+#define INDEX_VERSION 2
+#define INDEX_HEADER_WORDS 7
+#define INDEX_HEADER_SIZE (4 + INDEX_HEADER_WORDS * 8)
+#define INDEX_ENTRY_SIZE 16
+#define INDEX_SAMPLE_SIZE 4096
+
+// --stats 단계 (보고 순서)
+typedef enum
+{
+    PHASE_KEY,       // 키 유도
+    PHASE_SCHEDULE,  // 키 스케줄 확장
+    PHASE_READ,      // 입력 읽기
+    PHASE_TRANSCODE, // UTF-8 디코딩/인코딩
+    PHASE_CIPHER,    // 암호화 연산
+    PHASE_ENCODE,    // 결과 16진수 인코딩
+    PHASE_WRITE,     // 출력 쓰기
+    PHASE_FILE,      // 파일 모드 처리 (읽기+연산+쓰기)
+    PHASE_COUNT
+} RunPhase;
+
+static const char *phase_names[PHASE_COUNT] = {
+    "key_derivation", "schedule", "input_read", "transcode", "cipher", "encode", "output_write",
+    "file_processing"};
+static const char *phase_labels[PHASE_COUNT] = {
+    "키 유도", "키 스케줄 확장", "입력 읽기", "UTF-8 변환", "암호화 연산", "결과 인코딩", "출력 쓰기",
+    "파일 처리 (읽기+연산+쓰기)"};
+
+// --stats 메모리 영역 (ProblemaMemoryRegion 순서)
+static const char *memory_names[PROBLEMA_MEMORY_REGIONS] = {
+    "rotors", "inverse_rotors", "plugboard", "sboxes", "round_keys", "caches", "state", "scratch"};
+static const char *memory_labels[PROBLEMA_MEMORY_REGIONS] = {
+    "순방향 로터", "역방향 로터", "플러그보드", "S-Box", "라운드 키", "블록 변환 테이블", "가변 상태",
+    "스레드 작업 공간"};
+
+// --stats 측정 결과
+typedef struct
+{
+    double wall[PHASE_COUNT];  // 단계별 경과 시간 (초)
+    double cpu[PHASE_COUNT];   // 단계별 프로세스 CPU 시간 (초)
+    bool measured[PHASE_COUNT]; // 측정한 단계
+    double mark_wall;          // 진행 중인 단계의 시작 시각
+    double mark_cpu;
+    double start_wall;         // 전체 시작 시각
+    double start_cpu;
+    uint64_t bytes;            // 입력 바이트 수
+    uint64_t chars;            // 처리한 문자 수 (문자 모드)
+    ProblemaTimeline *timeline; // --timeline 구간 기록 (없으면 NULL)
+    uint64_t mark_ns;          // 진행 중인 단계의 타임라인 시작 시각
+} RunStats;
 
 void print_banner()
 {
@@ -26,7 +96,20 @@ void print_usage()
     printf("  -k, --key KEY    암호화/복호화에 사용할 키를 지정합니다 (필수)\n");
     printf("  -i, --input FILE 입력 파일을 지정합니다 (지정하지 않으면 표준 입력 사용)\n");
     printf("  -o, --output FILE 출력 파일을 지정합니다 (지정하지 않으면 표준 출력 사용)\n");
-    printf("  -v, --verbose    상세 출력 모드를 활성화합니다\n");
+    printf("  -c, --container  청크 단위 컨테이너 형식으로 암호화/복호화합니다\n");
+    printf("  -r, --range START:COUNT  암호문 파일의 START번째 문자부터 COUNT개만 복호화합니다\n");
+    printf("      --byte-range START:LEN 암호문 파일의 바이트 범위만 복호화합니다\n");
+    printf("      --index FILE 범위 복호화용 탐색 인덱스 파일 (없으면 만들어 저장)\n");
+    printf("      --checkpoint FILE 처리 중 체크포인트를 주기적으로 저장합니다 (-i, -o 필요)\n");
+    printf("      --checkpoint-interval BYTES 체크포인트 간격 (입력 바이트, 기본 1MB)\n");
+    printf("      --resume     체크포인트 파일의 위치부터 이어서 처리합니다\n");
+    printf("  -b, --binary     임의의 바이너리 파일을 블록 단위(CBC, PKCS#7 패딩)로 처리합니다 (-i, -o 필요)\n");
+    printf("      --block-profile aes|full 바이너리 모드의 블록 변환 (기본 aes)\n");
+    printf("  -v, --verbose    상세 출력 모드를 활성화합니다 (범위/바이너리/체크포인트 모드 포함)\n");
+    printf("      --trace-sample N 상세 출력에서 N번째 문자/블록마다 하나씩만 기록합니다 (기본 1)\n");
+    printf("      --trace-drop 상세 출력 버퍼가 가득 차면 기다리지 않고 이벤트를 버립니다\n");
+    printf("      --stats[=json] 단계별 경과/CPU 시간, 처리량, 최대 RSS를 표준 오류로 출력합니다\n");
+    printf("      --timeline FILE 단계/청크/스레드별 구간을 Chrome 추적 이벤트 JSON으로 저장합니다\n");
     printf("  -h, --help       이 도움말을 표시합니다\n");
     printf("\n");
     printf("예시:\n");
@@ -34,6 +117,42 @@ void print_usage()
     printf("  problema -d -k \"비밀키\" \"암호화된텍스트\"\n");
     printf("  echo \"안녕하세요 Hello World\" | problema -e -k \"비밀키\"\n");
     printf("  problema -e -k \"비밀키\" -i input.txt -o encrypted.txt\n");
+    printf("  problema -e -c -k \"비밀키\" -i input.txt -o encrypted.prbl\n");
+    printf("  problema -d -k \"비밀키\" -i encrypted.txt --index encrypted.idx -r 40000000:1000\n");
+    printf("  problema -e -k \"비밀키\" -i corpus.txt -o corpus.enc --checkpoint corpus.ckpt --resume\n");
+    printf("  problema -e -b -k \"비밀키\" -i archive.tar.gz -o archive.prbb\n");
+}
+
+// 스트림 전체를 동적 버퍼로 읽기
+byte_t *read_stream(FILE *fp, size_t *len)
+{
+    size_t capacity = READ_CHUNK_SIZE;
+    size_t used = 0;
+    byte_t *data = (byte_t *)malloc(capacity);
+    if (data == NULL)
+    {
+        return NULL;
+    }
+
+    size_t n;
+    while ((n = fread(data + used, 1, capacity - used, fp)) > 0)
+    {
+        used += n;
+        if (used == capacity)
+        {
+            byte_t *grown = (byte_t *)realloc(data, capacity * 2);
+            if (grown == NULL)
+            {
+                free(data);
+                return NULL;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+    }
+
+    *len = used;
+    return data;
 }
 
 // 문자열을 256비트(32바이트) 키로 변환
@@ -186,204 +305,265 @@ void print_decryption_process(const byte_t *input, size_t input_len,
     printf("\n복호화된 텍스트: %.*s\n\n", (int)output_len, output);
 }
 
-int main(int argc, char *argv[])
+// "START:COUNT" 형식의 범위 파싱
+bool parse_range(const char *text, uint64_t *start, uint64_t *count)
 {
-    bool encrypt_mode = true;
-    bool verbose_mode = false;
-    char *key_str = NULL;
-    char *input_file = NULL;
-    char *output_file = NULL;
-    char *input_text = NULL;
+    char *end = NULL;
+    *start = strtoull(text, &end, 10);
+    if (end == text || *end != ':')
+    {
+        return false;
+    }
 
-    // 명령행 인수 파싱
-    for (int i = 1; i < argc; i++)
+    const char *count_text = end + 1;
+    *count = strtoull(count_text, &end, 10);
+    return end != count_text && *end == '\0';
+}
+
+// 리틀 엔디언 64비트 쓰기
+void put_le64(byte_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
     {
-        if (strcmp(argv[i], "-e") == 0 || strcmp(argv[i], "--encrypt") == 0)
-        {
-            encrypt_mode = true;
-        }
-        else if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--decrypt") == 0)
-        {
-            encrypt_mode = false;
-        }
-        else if (strcmp(argv[i], "-k") == 0 || strcmp(argv[i], "--key") == 0)
-        {
-            if (i + 1 < argc)
-            {
-                key_str = argv[++i];
-            }
-            else
-            {
-                fprintf(stderr, "오류: 키가 지정되지 않았습니다.\n");
-                print_usage();
-                return 1;
-            }
-        }
-        else if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--input") == 0)
-        {
-            if (i + 1 < argc)
-            {
-                input_file = argv[++i];
-            }
-            else
-            {
-                fprintf(stderr, "오류: 입력 파일이 지정되지 않았습니다.\n");
-                print_usage();
-                return 1;
-            }
-        }
-        else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0)
-        {
-            if (i + 1 < argc)
-            {
-                output_file = argv[++i];
-            }
-            else
-            {
-                fprintf(stderr, "오류: 출력 파일이 지정되지 않았습니다.\n");
-                print_usage();
-                return 1;
-            }
-        }
-        else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0)
-        {
-            verbose_mode = true;
-        }
-        else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
-        {
-            print_banner();
-            print_usage();
-            return 0;
-        }
-        else if (argv[i][0] == '-')
+        p[i] = (byte_t)(v >> (8 * i));
+    }
+}
+
+// 리틀 엔디언 64비트 읽기
+uint64_t get_le64(const byte_t *p)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        v |= (uint64_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+// 원본 앞뒤 INDEX_SAMPLE_SIZE 바이트의 FNV-1a 해시 (같은 길이의 다른 파일을 가려내는 용도)
+uint64_t sample_hash(const byte_t *data, size_t data_len)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    size_t head = data_len < INDEX_SAMPLE_SIZE ? data_len : INDEX_SAMPLE_SIZE;
+    size_t tail = data_len - head < INDEX_SAMPLE_SIZE ? data_len - head : INDEX_SAMPLE_SIZE;
+    for (size_t i = 0; i < head; i++)
+    {
+        hash = (hash ^ data[i]) * 0x100000001B3ULL;
+    }
+    for (size_t i = data_len - tail; i < data_len; i++)
+    {
+        hash = (hash ^ data[i]) * 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+// 인덱스 항목이 원본 안을 가리키고 간격대로 정렬되어 있는지 확인
+bool index_entries_valid(const ProblemaSeekIndex *index, size_t data_len)
+{
+    for (size_t k = 0; k < index->num_entries; k++)
+    {
+        const ProblemaIndexEntry *entry = &index->entries[k];
+        if (entry->byte_offset > data_len || entry->char_index > index->total_chars)
         {
-            fprintf(stderr, "오류: 알 수 없는 옵션 '%s'\n", argv[i]);
-            print_usage();
-            return 1;
+            return false;
         }
-        else
+        if (k == 0 ? entry->char_index != 0 || entry->byte_offset != 0
+                   : entry->char_index - entry[-1].char_index != index->interval ||
+                         entry->byte_offset <= entry[-1].byte_offset)
         {
-            input_text = argv[i];
+            return false;
         }
     }
+    return true;
+}
 
-    // 키 검증
-    if (key_str == NULL)
+// 탐색 인덱스 파일 읽기 (원본 길이, 수정 시각, 표본 해시가 모두 맞아야 사용)
+bool load_index(const char *path, const byte_t *data, size_t data_len, uint64_t mtime_ns,
+                ProblemaSeekIndex *index)
+{
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL)
     {
-        fprintf(stderr, "오류: 키가 지정되지 않았습니다. -k 옵션을 사용하세요.\n");
-        print_usage();
-        return 1;
+        return false;
     }
 
-    print_banner();
+    struct stat st;
+    byte_t raw[INDEX_HEADER_SIZE];
+    uint64_t header[INDEX_HEADER_WORDS];
+    bool ok = fstat(fileno(fp), &st) == 0 && st.st_size >= INDEX_HEADER_SIZE &&
+              fread(raw, 1, INDEX_HEADER_SIZE, fp) == INDEX_HEADER_SIZE && memcmp(raw, INDEX_MAGIC, 4) == 0;
+    for (int w = 0; ok && w < INDEX_HEADER_WORDS; w++)
+    {
+        header[w] = get_le64(raw + 4 + 8 * w);
+    }
+    ok = ok && header[0] == INDEX_VERSION && header[1] > 0 && header[3] == data_len &&
+         header[5] == mtime_ns && header[6] == sample_hash(data, data_len);
 
-    // 입력 데이터 준비
-    byte_t input[MAX_INPUT_SIZE] = {0};
-    size_t input_len = 0;
+    // 항목 수는 파일에 실제로 들어 있는 만큼을 넘을 수 없다 (곱셈 넘침 방지)
+    if (ok && header[4] > ((uint64_t)st.st_size - INDEX_HEADER_SIZE) / INDEX_ENTRY_SIZE)
+    {
+        ok = false;
+    }
 
-    if (input_file != NULL)
+    if (ok)
     {
-        // 파일에서 입력 읽기
-        FILE *fp = fopen(input_file, "rb");
-        if (fp == NULL)
+        index->interval = header[1];
+        index->total_chars = header[2];
+        index->total_bytes = header[3];
+        index->num_entries = (size_t)header[4];
+        index->entries = (ProblemaIndexEntry *)malloc(index->num_entries * sizeof(ProblemaIndexEntry));
+        ok = index->entries != NULL;
+        for (size_t k = 0; ok && k < index->num_entries; k++)
         {
-            fprintf(stderr, "오류: 입력 파일 '%s'을(를) 열 수 없습니다.\n", input_file);
-            return 1;
+            byte_t entry[INDEX_ENTRY_SIZE];
+            ok = fread(entry, 1, INDEX_ENTRY_SIZE, fp) == INDEX_ENTRY_SIZE;
+            index->entries[k].char_index = get_le64(entry);
+            index->entries[k].byte_offset = get_le64(entry + 8);
         }
-        input_len = fread(input, 1, MAX_INPUT_SIZE - 1, fp);
-        fclose(fp);
-    }
-    else if (input_text != NULL)
-    {
-        // 명령행 인수에서 입력 읽기
-        input_len = strlen(input_text);
-        if (input_len >= MAX_INPUT_SIZE)
+        ok = ok && index_entries_valid(index, data_len);
+        if (!ok)
         {
-            fprintf(stderr, "오류: 입력 텍스트가 너무 깁니다.\n");
-            return 1;
+            problema_index_free(index);
         }
-        memcpy(input, input_text, input_len);
     }
-    else
+
+    fclose(fp);
+    if (!ok)
     {
-        // 표준 입력에서 읽기
-        fprintf(stderr, "입력 텍스트를 입력하세요 (최대 %d바이트):\n", MAX_INPUT_SIZE - 1);
-        input_len = fread(input, 1, MAX_INPUT_SIZE - 1, stdin);
+        memset(index, 0, sizeof(*index));
+    }
+    return ok;
+}
 
-        // 줄바꿈 문자 제거
-        if (input_len > 0 && input[input_len - 1] == '\n')
-        {
-            input_len--;
-        }
+// 탐색 인덱스 파일 저장
+void save_index(const char *path, const ProblemaSeekIndex *index, const byte_t *data, uint64_t mtime_ns)
+{
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL)
+    {
+        fprintf(stderr, "경고: 인덱스 파일 '%s'을(를) 저장할 수 없습니다.\n", path);
+        return;
     }
 
-    // 키 유도
-    byte_t key[PROBLEMA_KEY_SIZE];
-    derive_key_from_string(key_str, key);
+    uint64_t header[INDEX_HEADER_WORDS] = {INDEX_VERSION, index->interval, index->total_chars,
+                                           index->total_bytes, index->num_entries, mtime_ns,
+                                           sample_hash(data, index->total_bytes)};
+    byte_t raw[INDEX_HEADER_SIZE];
+    memcpy(raw, INDEX_MAGIC, 4);
+    for (int w = 0; w < INDEX_HEADER_WORDS; w++)
+    {
+        put_le64(raw + 4 + 8 * w, header[w]);
+    }
+    bool ok = fwrite(raw, 1, INDEX_HEADER_SIZE, fp) == INDEX_HEADER_SIZE;
+    for (size_t k = 0; ok && k < index->num_entries; k++)
+    {
+        byte_t entry[INDEX_ENTRY_SIZE];
+        put_le64(entry, index->entries[k].char_index);
+        put_le64(entry + 8, index->entries[k].byte_offset);
+        ok = fwrite(entry, 1, INDEX_ENTRY_SIZE, fp) == INDEX_ENTRY_SIZE;
+    }
+    if (fclose(fp) != 0 || !ok)
+    {
+        // 잘린 인덱스는 다음 실행에서 검증에 걸리지만 남겨 둘 이유도 없다
+        remove(path);
+        fprintf(stderr, "경고: 인덱스 파일 '%s'을(를) 저장할 수 없습니다.\n", path);
+    }
+}
 
-    // 프로블레마 컨텍스트 초기화
-    ProblemaContext ctx;
-    int result = problema_init(&ctx, key);
-    if (result != PROBLEMA_SUCCESS)
+// 암호문 파일의 문자/바이트 범위 복호화
+int decrypt_file_range(const ProblemaContext *ctx, const char *input_file, const char *output_file,
+                       const char *index_file, bool byte_range, uint64_t start, uint64_t count,
+                       ProblemaLogSink *trace_sink)
+{
+    byte_t *data = MAP_FAILED;
+    size_t data_len = 0;
+    byte_t *output = NULL;
+    size_t output_len = 0;
+    int status = 1;
+
+    int fd = open(input_file, O_RDONLY);
+    if (fd < 0)
     {
-        fprintf(stderr, "오류: 프로블레마 컨텍스트 초기화 실패: %s\n",
-                problema_error_string(result));
-        return 1;
+        fprintf(stderr, "오류: 입력 파일 '%s'을(를) 열 수 없습니다.\n", input_file);
+        goto cleanup;
     }
 
-    // 디버그 모드 설정
-    if (verbose_mode)
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
     {
-        problema_set_debug(true);
+        fprintf(stderr, "오류: 입력 파일 '%s'이(가) 비어 있습니다.\n", input_file);
+        close(fd);
+        goto cleanup;
     }
 
-    // 암호화 또는 복호화 수행
-    byte_t output[MAX_OUTPUT_SIZE] = {0};
-    size_t output_len = 0;
+    // 필요한 구간만 페이지 인되도록 파일 전체를 매핑
+    data_len = (size_t)st.st_size;
+    data = (byte_t *)mmap(NULL, data_len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        fprintf(stderr, "오류: 입력 파일을 메모리에 매핑할 수 없습니다.\n");
+        goto cleanup;
+    }
 
-    if (encrypt_mode)
+    // 문자 범위든 바이트 범위든 문자 하나는 최대 4바이트로 출력된다
+    size_t output_size = problema_output_bound(count) + 4;
+    if (output_size > problema_output_bound(data_len) + 4)
     {
-        printf("암호화 모드\n");
-        result = problema_encrypt(&ctx, input, input_len, output, MAX_OUTPUT_SIZE, &output_len);
-        if (result != PROBLEMA_SUCCESS)
-        {
-            fprintf(stderr, "오류: 암호화 실패: %s\n", problema_error_string(result));
-            problema_cleanup(&ctx);
-            return 1;
-        }
+        output_size = problema_output_bound(data_len) + 4;
+    }
+    output = (byte_t *)malloc(output_size);
+    int result = PROBLEMA_ERROR_OUT_OF_MEMORY;
 
-        if (verbose_mode)
-        {
-            print_encryption_process(input, input_len, output, output_len);
-        }
+    ProblemaContainerInfo info;
+    if (output != NULL && problema_container_open(NULL, data, data_len, &info) == PROBLEMA_SUCCESS)
+    {
+        // 컨테이너는 자체 청크 인덱스를 사용
+        result = byte_range ? PROBLEMA_ERROR_INVALID_FORMAT
+                            : problema_container_decrypt_range(ctx, data, data_len, start, count,
+                                                               output, output_size, &output_len);
     }
-    else
+    else if (output != NULL)
     {
-        printf("복호화 모드\n");
-        result = problema_decrypt(&ctx, input, input_len, output, MAX_OUTPUT_SIZE, &output_len);
-        if (result != PROBLEMA_SUCCESS)
+        ProblemaSeekIndex index = {0};
+        uint64_t mtime_ns = (uint64_t)st.st_mtim.tv_sec * 1000000000ULL + (uint64_t)st.st_mtim.tv_nsec;
+        bool have_index = index_file != NULL && load_index(index_file, data, data_len, mtime_ns, &index);
+        if (!have_index)
         {
-            fprintf(stderr, "오류: 복호화 실패: %s\n", problema_error_string(result));
-            problema_cleanup(&ctx);
-            return 1;
+            result = problema_index_build(data, data_len, 0, &index);
+            have_index = result == PROBLEMA_SUCCESS;
+            if (have_index && index_file != NULL)
+            {
+                save_index(index_file, &index, data, mtime_ns);
+            }
         }
 
-        if (verbose_mode)
+        if (have_index)
         {
-            print_decryption_process(input, input_len, output, output_len);
+            result = byte_range
+                         ? problema_decrypt_byte_range(ctx, data, data_len, &index, start, count,
+                                                       output, output_size, &output_len)
+                         : problema_decrypt_range(ctx, data, data_len, &index, start, count,
+                                                  output, output_size, &output_len);
         }
+        problema_index_free(&index);
+    }
+
+    // 추적 출력이 결과보다 먼저 나가도록 싱크를 비운다
+    problema_log_sink_flush(trace_sink);
+    if (result != PROBLEMA_SUCCESS)
+    {
+        fprintf(stderr, "오류: 범위 복호화 실패: %s\n", problema_error_string(result));
+        goto cleanup;
     }
 
-    // 결과 출력
     if (output_file != NULL)
     {
-        // 파일에 출력 쓰기
         FILE *fp = fopen(output_file, "wb");
         if (fp == NULL)
         {
             fprintf(stderr, "오류: 출력 파일 '%s'을(를) 열 수 없습니다.\n", output_file);
-            problema_cleanup(&ctx);
-            return 1;
+            goto cleanup;
         }
         fwrite(output, 1, output_len, fp);
         fclose(fp);
@@ -391,28 +571,1153 @@ int main(int argc, char *argv[])
     }
     else
     {
-        // 표준 출력에 쓰기
-        if (!verbose_mode)
+        printf("복호화된 결과: %.*s\n", (int)output_len, output);
+    }
+    status = 0;
+
+cleanup:
+    if (data != MAP_FAILED)
+    {
+        munmap(data, data_len);
+    }
+    free(output);
+    return status;
+}
+
+// 체크포인트 파일을 임시 파일에 쓴 뒤 교체 (중간에 죽어도 이전 체크포인트는 남는다)
+bool save_checkpoint(const char *path, const ProblemaStream *stream)
+{
+    byte_t checkpoint[PROBLEMA_CHECKPOINT_SIZE];
+    if (problema_stream_checkpoint(stream, checkpoint) != PROBLEMA_SUCCESS)
+    {
+        return false;
+    }
+
+    size_t path_len = strlen(path);
+    char *tmp_path = (char *)malloc(path_len + 5);
+    if (tmp_path == NULL)
+    {
+        return false;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", 5);
+
+    FILE *fp = fopen(tmp_path, "wb");
+    bool ok = fp != NULL && fwrite(checkpoint, 1, sizeof(checkpoint), fp) == sizeof(checkpoint) &&
+              fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+    if (fp != NULL)
+    {
+        ok = fclose(fp) == 0 && ok;
+    }
+    ok = ok && rename(tmp_path, path) == 0;
+
+    free(tmp_path);
+    return ok;
+}
+
+// 체크포인트를 남기며 파일을 조각 단위로 암호화/복호화
+int stream_file(const ProblemaContext *ctx, bool encrypt, const char *input_file,
+                const char *output_file, const char *checkpoint_file, size_t interval, bool resume,
+                ProblemaLogSink *trace_sink)
+{
+    ProblemaStream stream;
+    int result;
+    FILE *in = NULL;
+    int out = -1;
+    byte_t *in_buf = NULL;
+    byte_t *out_buf = NULL;
+    int status = 1;
+
+    if (resume)
+    {
+        byte_t checkpoint[PROBLEMA_CHECKPOINT_SIZE];
+        FILE *fp = fopen(checkpoint_file, "rb");
+        size_t len = 0;
+        if (fp != NULL)
         {
-            if (encrypt_mode)
-            {
-                printf("암호화된 결과: ");
-                // 암호화된 결과는 바이너리일 수 있으므로 16진수로 출력
-                for (size_t i = 0; i < output_len; i++)
-                {
-                    printf("%02X", output[i]);
-                }
-                printf("\n");
-            }
-            else
-            {
-                printf("복호화된 결과: %.*s\n", (int)output_len, output);
-            }
+            len = fread(checkpoint, 1, sizeof(checkpoint), fp);
+            fclose(fp);
+        }
+        else
+        {
+            fprintf(stderr, "오류: 체크포인트 파일 '%s'을(를) 열 수 없습니다.\n", checkpoint_file);
+            goto cleanup;
+        }
+
+        result = problema_stream_resume(&stream, ctx, checkpoint, len);
+        if (result == PROBLEMA_SUCCESS && stream.cursor.state.encrypt_mode != encrypt)
+        {
+            fprintf(stderr, "오류: 체크포인트의 처리 방향이 요청과 다릅니다.\n");
+            goto cleanup;
+        }
+        if (result != PROBLEMA_SUCCESS)
+        {
+            fprintf(stderr, "오류: 체크포인트를 읽을 수 없습니다: %s\n", problema_error_string(result));
+            goto cleanup;
         }
+        printf("체크포인트에서 재개: 문자 %" PRIu64 ", 입력 %" PRIu64 " 바이트, 출력 %" PRIu64 " 바이트\n",
+               stream.char_index, stream.input_offset, stream.output_offset);
+    }
+    else
+    {
+        problema_stream_init(&stream, ctx, encrypt);
     }
 
-    // 정리
-    problema_cleanup(&ctx);
+    in = fopen(input_file, "rb");
+    if (in == NULL || fseeko(in, (off_t)stream.input_offset, SEEK_SET) != 0)
+    {
+        fprintf(stderr, "오류: 입력 파일 '%s'을(를) 열 수 없습니다.\n", input_file);
+        goto cleanup;
+    }
 
-    return 0;
-}
\ No newline at end of file
+    // 재개할 때는 마지막 체크포인트 이후에 쓴 출력을 잘라낸다
+    out = open(output_file, O_WRONLY | O_CREAT | (resume ? 0 : O_TRUNC), 0644);
+    if (out < 0 || ftruncate(out, (off_t)stream.output_offset) != 0 ||
+        lseek(out, (off_t)stream.output_offset, SEEK_SET) < 0)
+    {
+        fprintf(stderr, "오류: 출력 파일 '%s'을(를) 열 수 없습니다.\n", output_file);
+        goto cleanup;
+    }
+
+    // 조각 끝에서 잘린 문자(최대 3바이트)는 다음 조각 앞으로 옮긴다
+    size_t in_size = interval + 3;
+    size_t out_size = problema_output_bound(in_size);
+    in_buf = (byte_t *)malloc(in_size);
+    out_buf = (byte_t *)malloc(out_size);
+    size_t carry = 0;
+
+    if (in_buf == NULL || out_buf == NULL)
+    {
+        fprintf(stderr, "오류: 버퍼를 위한 메모리를 할당할 수 없습니다.\n");
+        goto cleanup;
+    }
+
+    status = 0;
+    while (status == 0)
+    {
+        size_t n = fread(in_buf + carry, 1, interval, in);
+        size_t len = carry + n;
+        if (len == 0)
+        {
+            break;
+        }
+
+        size_t out_len = 0, consumed = 0;
+        result = problema_stream_update(&stream, in_buf, len, out_buf, out_size, &out_len, &consumed);
+        if (result == PROBLEMA_SUCCESS && n == 0)
+        {
+            // 입력이 잘린 문자로 끝남
+            result = PROBLEMA_ERROR_INVALID_UTF8;
+        }
+        if (result != PROBLEMA_SUCCESS)
+        {
+            fprintf(stderr, "오류: %s 실패: %s\n", encrypt ? "암호화" : "복호화",
+                    problema_error_string(result));
+            status = 1;
+            break;
+        }
+
+        for (size_t written = 0; written < out_len;)
+        {
+            ssize_t w = write(out, out_buf + written, out_len - written);
+            if (w <= 0)
+            {
+                fprintf(stderr, "오류: 출력 파일 '%s'에 쓸 수 없습니다.\n", output_file);
+                status = 1;
+                break;
+            }
+            written += (size_t)w;
+        }
+
+        carry = len - consumed;
+        memmove(in_buf, in_buf + consumed, carry);
+
+        // 출력을 디스크에 내린 뒤에 체크포인트를 갱신해야 재개 위치가 출력과 맞는다
+        if (status == 0 && (fsync(out) != 0 || !save_checkpoint(checkpoint_file, &stream)))
+        {
+            fprintf(stderr, "오류: 체크포인트 '%s'을(를) 저장할 수 없습니다.\n", checkpoint_file);
+            status = 1;
+        }
+    }
+
+    if (close(out) != 0)
+    {
+        status = 1;
+    }
+    out = -1;
+
+    problema_log_sink_flush(trace_sink);
+    if (status == 0)
+    {
+        // 끝까지 처리했으면 체크포인트는 더 필요 없다
+        remove(checkpoint_file);
+        printf("%" PRIu64 " 문자 처리 완료. 결과가 '%s' 파일에 저장되었습니다.\n",
+               stream.char_index, output_file);
+    }
+
+cleanup:
+    free(in_buf);
+    free(out_buf);
+    if (in != NULL)
+    {
+        fclose(in);
+    }
+    if (out >= 0)
+    {
+        close(out);
+    }
+    return status;
+}
+
+// 파일 끝이나 count 바이트까지 읽기
+size_t read_full(FILE *fp, byte_t *buf, size_t count)
+{
+    size_t total = 0;
+    size_t n;
+    while (total < count && (n = fread(buf + total, 1, count - total, fp)) > 0)
+    {
+        total += n;
+    }
+    return total;
+}
+
+// 운영체제 난수로 IV 생성
+bool random_bytes(byte_t *buf, size_t len)
+{
+    FILE *fp = fopen("/dev/urandom", "rb");
+    if (fp == NULL)
+    {
+        return false;
+    }
+    bool ok = read_full(fp, buf, len) == len;
+    fclose(fp);
+    return ok;
+}
+
+// 바이너리 파일을 블록 계층으로 암호화/복호화 (헤더 + CBC 체인 + PKCS#7 패딩)
+int binary_file(ProblemaContext *ctx, bool encrypt, const char *input_file,
+                const char *output_file, int profile, ProblemaLogSink *trace_sink)
+{
+    FILE *out = NULL;
+    byte_t *buf = NULL;
+    uint64_t total = 0;
+    int status = 1;
+
+    FILE *in = fopen(input_file, "rb");
+    if (in == NULL)
+    {
+        fprintf(stderr, "오류: 입력 파일 '%s'을(를) 열 수 없습니다.\n", input_file);
+        goto cleanup;
+    }
+
+    byte_t header[BINARY_HEADER_SIZE];
+    uint64_t fingerprint = problema_key_fingerprint(ctx);
+    if (encrypt)
+    {
+        memset(header, 0, sizeof(header));
+        memcpy(header, BINARY_MAGIC, 4);
+        header[4] = BINARY_VERSION;
+        header[5] = (byte_t)profile;
+        for (int i = 0; i < 8; i++)
+        {
+            header[8 + i] = (byte_t)(fingerprint >> (8 * i));
+        }
+        if (!random_bytes(header + 16, PROBLEMA_BLOCK_SIZE))
+        {
+            fprintf(stderr, "오류: IV를 만들 수 없습니다.\n");
+            goto cleanup;
+        }
+    }
+    else
+    {
+        uint64_t stored = 0;
+        bool ok = read_full(in, header, sizeof(header)) == sizeof(header) &&
+                  memcmp(header, BINARY_MAGIC, 4) == 0 && header[4] == BINARY_VERSION;
+        for (int i = 0; ok && i < 8; i++)
+        {
+            stored |= (uint64_t)header[8 + i] << (8 * i);
+        }
+        if (!ok)
+        {
+            fprintf(stderr, "오류: 복호화 실패: %s\n", problema_error_string(PROBLEMA_ERROR_INVALID_FORMAT));
+            goto cleanup;
+        }
+        if (stored != fingerprint)
+        {
+            fprintf(stderr, "오류: 복호화 실패: %s\n", problema_error_string(PROBLEMA_ERROR_KEY_MISMATCH));
+            goto cleanup;
+        }
+        profile = header[5];
+    }
+
+    int result = problema_set_block_profile(ctx, profile);
+    if (result != PROBLEMA_SUCCESS || profile == PROBLEMA_BLOCK_PROFILE_COMPAT)
+    {
+        // 호환 프로필은 역변환이 원문을 되살리지 못하므로 바이너리 모드에 쓸 수 없다
+        fprintf(stderr, "오류: 바이너리 모드에서 사용할 수 없는 블록 프로필입니다.\n");
+        goto cleanup;
+    }
+
+    out = fopen(output_file, "wb");
+    if (out == NULL)
+    {
+        fprintf(stderr, "오류: 출력 파일 '%s'을(를) 열 수 없습니다.\n", output_file);
+        goto cleanup;
+    }
+
+    // 피드백을 IV로 두면 블록 API의 피드백 사슬이 그대로 CBC가 된다
+    memcpy(ctx->feedback, header + 16, PROBLEMA_BLOCK_SIZE);
+
+    // 복호화는 패딩을 확인하기 위해 마지막 블록을 다음 조각까지 들고 간다
+    buf = (byte_t *)malloc(BINARY_CHUNK_SIZE + PROBLEMA_BLOCK_SIZE);
+    size_t held = 0;
+    status = 0;
+
+    if (buf == NULL)
+    {
+        fprintf(stderr, "오류: 버퍼를 위한 메모리를 할당할 수 없습니다.\n");
+        status = 1;
+    }
+    else if (encrypt && fwrite(header, 1, sizeof(header), out) != sizeof(header))
+    {
+        status = 1;
+    }
+
+    while (status == 0)
+    {
+        size_t n = read_full(in, buf + held, BINARY_CHUNK_SIZE);
+        size_t len = held + n;
+        bool last = n < BINARY_CHUNK_SIZE;
+
+        if (encrypt)
+        {
+            if (last)
+            {
+                // PKCS#7: 블록 크기의 배수여도 패딩 블록 하나를 붙인다
+                byte_t pad = (byte_t)(PROBLEMA_BLOCK_SIZE - len % PROBLEMA_BLOCK_SIZE);
+                memset(buf + len, pad, pad);
+                len += pad;
+            }
+            problema_encrypt_blocks(ctx, buf, buf, len / PROBLEMA_BLOCK_SIZE);
+            total += len;
+            if (fwrite(buf, 1, len, out) != len)
+            {
+                status = 1;
+            }
+        }
+        else
+        {
+            if (len % PROBLEMA_BLOCK_SIZE != 0 || (last && len == 0))
+            {
+                fprintf(stderr, "오류: 암호문 길이가 블록 크기의 배수가 아닙니다.\n");
+                status = 1;
+                break;
+            }
+
+            size_t ready = last ? len : len - PROBLEMA_BLOCK_SIZE;
+            problema_decrypt_blocks(ctx, buf, buf, ready / PROBLEMA_BLOCK_SIZE);
+
+            if (last)
+            {
+                byte_t pad = buf[ready - 1];
+                bool valid = pad >= 1 && pad <= PROBLEMA_BLOCK_SIZE;
+                for (size_t i = 0; valid && i < pad; i++)
+                {
+                    valid = buf[ready - 1 - i] == pad;
+                }
+                if (!valid)
+                {
+                    fprintf(stderr, "오류: 패딩이 올바르지 않습니다 (키가 다르거나 파일이 손상됨).\n");
+                    status = 1;
+                    break;
+                }
+                ready -= pad;
+            }
+
+            total += ready;
+            if (fwrite(buf, 1, ready, out) != ready)
+            {
+                status = 1;
+            }
+
+            held = len - (last ? len : ready);
+            memmove(buf, buf + (len - held), held);
+        }
+
+        if (last)
+        {
+            break;
+        }
+    }
+
+    if (fclose(out) != 0 && status == 0)
+    {
+        fprintf(stderr, "오류: 출력 파일 '%s'에 쓸 수 없습니다.\n", output_file);
+        status = 1;
+    }
+    out = NULL;
+
+    problema_log_sink_flush(trace_sink);
+    if (status == 0)
+    {
+        printf("%" PRIu64 " 바이트 %s 완료 (블록 프로필 %s). 결과가 '%s' 파일에 저장되었습니다.\n",
+               total, encrypt ? "암호화" : "복호화",
+               profile == PROBLEMA_BLOCK_PROFILE_AES ? problema_aes_kernel() : "full", output_file);
+    }
+
+cleanup:
+    free(buf);
+    if (in != NULL)
+    {
+        fclose(in);
+    }
+    if (out != NULL)
+    {
+        fclose(out);
+    }
+    return status;
+}
+
+// 단조 시계와 프로세스 CPU 시계 (초)
+void clock_pair(double *wall, double *cpu)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    *wall = ts.tv_sec + ts.tv_nsec * 1e-9;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    *cpu = ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 단계 시작 시각 기록
+void phase_begin(RunStats *run)
+{
+    clock_pair(&run->mark_wall, &run->mark_cpu);
+    run->mark_ns = problema_timeline_clock();
+}
+
+// 시작 시각부터 지금까지를 phase에 더하고 다음 단계 시작 시각으로 삼음
+void phase_end(RunStats *run, RunPhase phase)
+{
+    double wall, cpu;
+    clock_pair(&wall, &cpu);
+    run->wall[phase] += wall - run->mark_wall;
+    run->cpu[phase] += cpu - run->mark_cpu;
+    run->measured[phase] = true;
+    run->mark_wall = wall;
+    run->mark_cpu = cpu;
+
+    problema_timeline_span(run->timeline, "cli", phase_names[phase], run->mark_ns, NULL, 0);
+    run->mark_ns = problema_timeline_clock();
+}
+
+// 암호화 연산 시간 중 UTF-8 변환 몫을 라이브러리 카운터 비율로 나눔
+void split_transcode(RunStats *run, const ProblemaStats *stats)
+{
+    uint64_t transcode = stats->cycles[PROBLEMA_STAT_DECODE] + stats->cycles[PROBLEMA_STAT_ENCODE];
+    uint64_t total = transcode + stats->cycles[PROBLEMA_STAT_PLUGBOARD] +
+                     stats->cycles[PROBLEMA_STAT_ROTORS] + stats->cycles[PROBLEMA_STAT_FEEDBACK];
+    run->chars = stats->chars;
+    if (total == 0)
+    {
+        return;
+    }
+
+    double share = (double)transcode / (double)total;
+    run->wall[PHASE_TRANSCODE] = run->wall[PHASE_CIPHER] * share;
+    run->cpu[PHASE_TRANSCODE] = run->cpu[PHASE_CIPHER] * share;
+    run->wall[PHASE_CIPHER] -= run->wall[PHASE_TRANSCODE];
+    run->cpu[PHASE_CIPHER] -= run->cpu[PHASE_TRANSCODE];
+    run->measured[PHASE_TRANSCODE] = true;
+}
+
+// 터미널 표시 폭에 맞춰 라벨 출력 (한글 등 3바이트 UTF-8 문자는 두 칸)
+void print_label(const char *label, int width)
+{
+    int cols = 0;
+    for (const unsigned char *p = (const unsigned char *)label; *p != '\0'; p++)
+    {
+        if ((*p & 0xC0) != 0x80)
+        {
+            cols += (*p & 0xF0) == 0xE0 ? 2 : 1;
+        }
+    }
+    fprintf(stderr, "  %s%*s", label, width > cols ? width - cols : 0, "");
+}
+
+// 메모리 영역 속성 문자열 (JSON 배열 원소 또는 쉼표 목록)
+void print_memory_flags(unsigned flags, bool json)
+{
+    static const char *names[] = {"shared", "lazy", "huge_pages"};
+    bool first = true;
+    for (int b = 0; b < 3; b++)
+    {
+        if (flags & (1u << b))
+        {
+            fprintf(stderr, json ? "%s\"%s\"" : "%s%s", first ? "" : ", ", names[b]);
+            first = false;
+        }
+    }
+}
+
+// 단계별 시간, 처리량, 최대 RSS, 컨텍스트 메모리를 표준 오류로 출력
+void print_run_stats(const RunStats *run, const ProblemaContext *ctx, bool json)
+{
+    fflush(stdout);
+
+    double wall, cpu;
+    clock_pair(&wall, &cpu);
+    double total_wall = wall - run->start_wall;
+    double total_cpu = cpu - run->start_cpu;
+
+    // 처리량은 데이터를 실제로 다룬 단계(키 유도와 스케줄 확장 제외) 기준
+    double work = 0;
+    for (int p = PHASE_READ; p < PHASE_COUNT; p++)
+    {
+        work += run->wall[p];
+    }
+    double bytes_per_sec = work > 0 ? run->bytes / work : 0;
+    double chars_per_sec = work > 0 ? run->chars / work : 0;
+
+    struct rusage usage;
+    long peak_rss_kb = getrusage(RUSAGE_SELF, &usage) == 0 ? usage.ru_maxrss : 0;
+
+    ProblemaMemoryUsage memory;
+    problema_memory_usage(ctx, &memory);
+
+    if (json)
+    {
+        fprintf(stderr, "{\"phases\": {");
+        bool first = true;
+        for (int p = 0; p < PHASE_COUNT; p++)
+        {
+            if (!run->measured[p])
+            {
+                continue;
+            }
+            fprintf(stderr, "%s\"%s\": {\"wall_s\": %.6f, \"cpu_s\": %.6f}",
+                    first ? "" : ", ", phase_names[p], run->wall[p], run->cpu[p]);
+            first = false;
+        }
+        fprintf(stderr, "}, \"total\": {\"wall_s\": %.6f, \"cpu_s\": %.6f}, ", total_wall, total_cpu);
+        fprintf(stderr, "\"bytes\": %" PRIu64 ", \"chars\": %" PRIu64 ", ", run->bytes, run->chars);
+        fprintf(stderr, "\"bytes_per_sec\": %.0f, \"chars_per_sec\": %.0f, ", bytes_per_sec, chars_per_sec);
+        fprintf(stderr, "\"peak_rss_kb\": %ld, \"memory\": {", peak_rss_kb);
+        for (int m = 0; m < PROBLEMA_MEMORY_REGIONS; m++)
+        {
+            fprintf(stderr, "\"%s\": {\"bytes\": %zu, \"flags\": [", memory_names[m],
+                    memory.regions[m].bytes);
+            print_memory_flags(memory.regions[m].flags, true);
+            fprintf(stderr, "]}, ");
+        }
+        fprintf(stderr, "\"context_bytes\": %zu, \"allocated_bytes\": %zu, \"shared_bytes\": %zu}}\n",
+                memory.context_bytes, memory.allocated_bytes, memory.shared_bytes);
+        return;
+    }
+
+    fprintf(stderr, "\n[통계] 단계별 시간 (경과 / CPU)\n");
+    for (int p = 0; p < PHASE_COUNT; p++)
+    {
+        if (run->measured[p])
+        {
+            print_label(phase_labels[p], 28);
+            fprintf(stderr, "%10.3f ms / %10.3f ms\n", run->wall[p] * 1e3, run->cpu[p] * 1e3);
+        }
+    }
+    print_label("전체", 28);
+    fprintf(stderr, "%10.3f ms / %10.3f ms\n", total_wall * 1e3, total_cpu * 1e3);
+    fprintf(stderr, "[통계] 처리량: %.2f MB/s", bytes_per_sec / 1e6);
+    if (run->chars > 0)
+    {
+        fprintf(stderr, ", %.2f M문자/s", chars_per_sec / 1e6);
+    }
+    fprintf(stderr, " (%" PRIu64 " 바이트, %" PRIu64 " 문자)\n", run->bytes, run->chars);
+    fprintf(stderr, "[통계] 최대 RSS: %ld KB\n", peak_rss_kb);
+
+    fprintf(stderr, "[통계] 컨텍스트 메모리\n");
+    for (int m = 0; m < PROBLEMA_MEMORY_REGIONS; m++)
+    {
+        print_label(memory_labels[m], 28);
+        fprintf(stderr, "%10.1f KB", memory.regions[m].bytes / 1024.0);
+        if (memory.regions[m].flags != 0)
+        {
+            fprintf(stderr, "  (");
+            print_memory_flags(memory.regions[m].flags, false);
+            fprintf(stderr, ")");
+        }
+        fprintf(stderr, "\n");
+    }
+    print_label("할당 (공유 가능)", 28);
+    fprintf(stderr, "%10.1f KB (%.1f KB)\n", memory.allocated_bytes / 1024.0, memory.shared_bytes / 1024.0);
+}
+
+// 타임라인을 JSON 파일로 저장하고 해제
+void save_timeline(ProblemaTimeline *timeline, const char *path)
+{
+    if (timeline == NULL)
+    {
+        return;
+    }
+
+    FILE *fp = fopen(path, "w");
+    if (fp == NULL || problema_timeline_write(timeline, fp) != PROBLEMA_SUCCESS)
+    {
+        fprintf(stderr, "경고: 타임라인 파일 '%s'을(를) 쓸 수 없습니다.\n", path);
+    }
+    if (fp != NULL)
+    {
+        fclose(fp);
+    }
+    problema_timeline_destroy(timeline);
+}
+
+// 파일 크기 (알 수 없으면 0)
+uint64_t file_size(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 ? (uint64_t)st.st_size : 0;
+}
+
+int main(int argc, char *argv[])
+{
+    bool encrypt_mode = true;
+    bool verbose_mode = false;
+    bool container_mode = false;
+    bool range_mode = false;
+    bool byte_range = false;
+    uint64_t range_start = 0;
+    uint64_t range_count = 0;
+    char *index_file = NULL;
+    char *checkpoint_file = NULL;
+    size_t checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL;
+    bool resume = false;
+    bool binary_mode = false;
+    int block_profile = PROBLEMA_BLOCK_PROFILE_AES;
+    unsigned trace_sample = 1;
+    unsigned trace_flags = PROBLEMA_LOG_SINK_BLOCK;
+    bool stats_mode = false;
+    bool stats_json = false;
+    char *timeline_file = NULL;
+    RunStats run = {0};
+    char *key_str = NULL;
+    char *input_file = NULL;
+    char *output_file = NULL;
+    char *input_text = NULL;
+
+    // 명령행 인수 파싱
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-e") == 0 || strcmp(argv[i], "--encrypt") == 0)
+        {
+            encrypt_mode = true;
+        }
+        else if (strcmp(argv[i], "-d") == 0 || strcmp(argv[i], "--decrypt") == 0)
+        {
+            encrypt_mode = false;
+        }
+        else if (strcmp(argv[i], "-k") == 0 || strcmp(argv[i], "--key") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                key_str = argv[++i];
+            }
+            else
+            {
+                fprintf(stderr, "오류: 키가 지정되지 않았습니다.\n");
+                print_usage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--input") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                input_file = argv[++i];
+            }
+            else
+            {
+                fprintf(stderr, "오류: 입력 파일이 지정되지 않았습니다.\n");
+                print_usage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                output_file = argv[++i];
+            }
+            else
+            {
+                fprintf(stderr, "오류: 출력 파일이 지정되지 않았습니다.\n");
+                print_usage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "-c") == 0 || strcmp(argv[i], "--container") == 0)
+        {
+            container_mode = true;
+        }
+        else if (strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--range") == 0 ||
+                 strcmp(argv[i], "--byte-range") == 0)
+        {
+            byte_range = strcmp(argv[i], "--byte-range") == 0;
+            if (i + 1 < argc && parse_range(argv[i + 1], &range_start, &range_count))
+            {
+                range_mode = true;
+                i++;
+            }
+            else
+            {
+                fprintf(stderr, "오류: 범위는 START:COUNT 형식으로 지정해야 합니다.\n");
+                print_usage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--index") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                index_file = argv[++i];
+            }
+            else
+            {
+                fprintf(stderr, "오류: 인덱스 파일이 지정되지 않았습니다.\n");
+                print_usage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--checkpoint") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                checkpoint_file = argv[++i];
+            }
+            else
+            {
+                fprintf(stderr, "오류: 체크포인트 파일이 지정되지 않았습니다.\n");
+                print_usage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--checkpoint-interval") == 0)
+        {
+            char *end = NULL;
+            if (i + 1 < argc && (checkpoint_interval = strtoull(argv[i + 1], &end, 10)) > 0 &&
+                *end == '\0')
+            {
+                i++;
+            }
+            else
+            {
+                fprintf(stderr, "오류: 체크포인트 간격은 양의 정수(바이트)여야 합니다.\n");
+                print_usage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--resume") == 0)
+        {
+            resume = true;
+        }
+        else if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--binary") == 0)
+        {
+            binary_mode = true;
+        }
+        else if (strcmp(argv[i], "--block-profile") == 0)
+        {
+            if (i + 1 < argc && (strcmp(argv[i + 1], "aes") == 0 || strcmp(argv[i + 1], "full") == 0))
+            {
+                block_profile = strcmp(argv[++i], "aes") == 0 ? PROBLEMA_BLOCK_PROFILE_AES
+                                                              : PROBLEMA_BLOCK_PROFILE_FULL;
+            }
+            else
+            {
+                fprintf(stderr, "오류: 블록 프로필은 aes 또는 full이어야 합니다.\n");
+                print_usage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "-v") == 0 || strcmp(argv[i], "--verbose") == 0)
+        {
+            verbose_mode = true;
+        }
+        else if (strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=text") == 0 ||
+                 strcmp(argv[i], "--stats=json") == 0)
+        {
+            stats_mode = true;
+            stats_json = strcmp(argv[i], "--stats=json") == 0;
+        }
+        else if (strcmp(argv[i], "--timeline") == 0)
+        {
+            if (i + 1 < argc)
+            {
+                timeline_file = argv[++i];
+            }
+            else
+            {
+                fprintf(stderr, "오류: 타임라인 파일이 지정되지 않았습니다.\n");
+                print_usage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--trace-drop") == 0)
+        {
+            trace_flags = 0;
+        }
+        else if (strcmp(argv[i], "--trace-sample") == 0)
+        {
+            char *end = NULL;
+            unsigned long n = 0;
+            if (i + 1 < argc && (n = strtoul(argv[i + 1], &end, 10)) > 0 && *end == '\0' &&
+                n <= UINT32_MAX)
+            {
+                trace_sample = (unsigned)n;
+                i++;
+            }
+            else
+            {
+                fprintf(stderr, "오류: 추적 표본 간격은 양의 정수여야 합니다.\n");
+                print_usage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0)
+        {
+            print_banner();
+            print_usage();
+            return 0;
+        }
+        else if (argv[i][0] == '-')
+        {
+            fprintf(stderr, "오류: 알 수 없는 옵션 '%s'\n", argv[i]);
+            print_usage();
+            return 1;
+        }
+        else
+        {
+            input_text = argv[i];
+        }
+    }
+
+    // 키 검증
+    if (key_str == NULL)
+    {
+        fprintf(stderr, "오류: 키가 지정되지 않았습니다. -k 옵션을 사용하세요.\n");
+        print_usage();
+        return 1;
+    }
+
+    if (range_mode && (encrypt_mode || input_file == NULL))
+    {
+        fprintf(stderr, "오류: 범위 복호화는 -d 와 -i 옵션이 필요합니다.\n");
+        print_usage();
+        return 1;
+    }
+
+    if ((checkpoint_file != NULL || resume) &&
+        (checkpoint_file == NULL || input_file == NULL || output_file == NULL ||
+         container_mode || range_mode))
+    {
+        fprintf(stderr, "오류: 체크포인트는 --checkpoint, -i, -o 옵션이 필요하며 컨테이너/범위 모드와 함께 쓸 수 없습니다.\n");
+        print_usage();
+        return 1;
+    }
+
+    if (binary_mode && (input_file == NULL || output_file == NULL || container_mode ||
+                        range_mode || checkpoint_file != NULL))
+    {
+        fprintf(stderr, "오류: 바이너리 모드는 -i, -o 옵션이 필요하며 다른 파일 모드와 함께 쓸 수 없습니다.\n");
+        print_usage();
+        return 1;
+    }
+
+    print_banner();
+
+    // 아래부터는 오류가 나도 cleanup에서 타임라인, 추적 싱크, 버퍼를 모두 정리한다
+    int status = 1;
+    ProblemaContext *ctx = NULL;
+    ProblemaLogSink *trace_sink = NULL;
+    byte_t *input = NULL;
+    byte_t *output = NULL;
+    size_t input_len = 0;
+    size_t output_len = 0;
+
+    // 타임라인은 키 유도부터 기록
+    if (timeline_file != NULL)
+    {
+        run.timeline = problema_timeline_create(0);
+        problema_timeline_thread_name(run.timeline, "main");
+    }
+
+    clock_pair(&run.start_wall, &run.start_cpu);
+    phase_begin(&run);
+
+    // 키 유도
+    byte_t key[PROBLEMA_KEY_SIZE];
+    derive_key_from_string(key_str, key);
+    phase_end(&run, PHASE_KEY);
+
+    // 프로블레마 컨텍스트 초기화 (4MB가 넘으므로 힙에 할당)
+    int result = problema_context_new(&ctx, key, NULL, PROBLEMA_CONTEXT_HUGE_PAGES);
+    if (result != PROBLEMA_SUCCESS)
+    {
+        fprintf(stderr, "오류: 프로블레마 컨텍스트 초기화 실패: %s\n",
+                problema_error_string(result));
+        goto cleanup;
+    }
+    phase_end(&run, PHASE_SCHEDULE);
+    problema_set_timeline(ctx, run.timeline);
+
+    // 디버그 모드 설정 (모든 모드에 적용)
+    // 단계별 추적은 비동기 싱크에 기록하고 배경 스레드가 출력 (싱크를 못 만들면 직접 출력)
+    if (verbose_mode)
+    {
+        problema_set_debug(true);
+        trace_sink = problema_log_sink_create(stdout, 0, trace_sample, trace_flags);
+        if (trace_sink != NULL)
+        {
+            problema_set_trace(ctx, problema_log_sink_trace, trace_sink);
+        }
+        else
+        {
+            problema_set_trace(ctx, problema_trace_print, NULL);
+        }
+    }
+
+    // 파일 모드는 읽기, 연산, 쓰기가 섞여 있으므로 한 단계로 잰다
+    if (stats_mode && (range_mode || binary_mode || checkpoint_file != NULL))
+    {
+        run.bytes = file_size(input_file);
+    }
+
+    // 범위 복호화는 입력 파일을 직접 매핑하여 필요한 구간만 처리
+    // 바이너리 모드는 UTF-8 경로를 거치지 않고 블록 계층으로 처리
+    // 체크포인트 모드는 입력 파일을 조각 단위로 읽으며 처리
+    if (range_mode || binary_mode || checkpoint_file != NULL)
+    {
+        if (range_mode)
+        {
+            printf("범위 복호화 모드\n");
+            status = decrypt_file_range(ctx, input_file, output_file, index_file, byte_range,
+                                        range_start, range_count, trace_sink);
+        }
+        else if (binary_mode)
+        {
+            printf("바이너리 %s 모드\n", encrypt_mode ? "암호화" : "복호화");
+            status = binary_file(ctx, encrypt_mode, input_file, output_file, block_profile, trace_sink);
+        }
+        else
+        {
+            printf("%s 모드 (체크포인트: %s)\n", encrypt_mode ? "암호화" : "복호화", checkpoint_file);
+            status = stream_file(ctx, encrypt_mode, input_file, output_file, checkpoint_file,
+                                 checkpoint_interval, resume, trace_sink);
+        }
+        phase_end(&run, PHASE_FILE);
+        if (stats_mode && status == 0)
+        {
+            print_run_stats(&run, ctx, stats_json);
+        }
+        goto cleanup;
+    }
+
+    // 입력 데이터 준비
+    if (input_file != NULL)
+    {
+        // 파일에서 입력 읽기
+        FILE *fp = fopen(input_file, "rb");
+        if (fp == NULL)
+        {
+            fprintf(stderr, "오류: 입력 파일 '%s'을(를) 열 수 없습니다.\n", input_file);
+            goto cleanup;
+        }
+        input = read_stream(fp, &input_len);
+        fclose(fp);
+    }
+    else if (input_text != NULL)
+    {
+        // 명령행 인수에서 입력 읽기
+        input_len = strlen(input_text);
+        input = (byte_t *)malloc(input_len + 1);
+        if (input != NULL)
+        {
+            memcpy(input, input_text, input_len);
+        }
+    }
+    else
+    {
+        // 표준 입력에서 읽기
+        fprintf(stderr, "입력 텍스트를 입력하세요 (EOF로 종료):\n");
+        input = read_stream(stdin, &input_len);
+
+        // 줄바꿈 문자 제거 (컨테이너 복호화 입력은 바이너리이므로 그대로 둔다)
+        if (input != NULL && (encrypt_mode || !container_mode) &&
+            input_len > 0 && input[input_len - 1] == '\n')
+        {
+            input_len--;
+        }
+    }
+
+    if (input == NULL)
+    {
+        fprintf(stderr, "오류: 입력을 위한 메모리를 할당할 수 없습니다.\n");
+        goto cleanup;
+    }
+    phase_end(&run, PHASE_READ);
+    run.bytes = input_len;
+
+    // UTF-8 변환 몫을 나누기 위해 라이브러리 카운터 수집
+    if (stats_mode)
+    {
+        problema_set_stats(ctx, true);
+    }
+
+    // 암호화 또는 복호화 수행
+    // 계산 없이 알 수 있는 상한으로 출력 버퍼를 한 번만 할당
+    size_t output_size = problema_output_bound(input_len);
+    if (container_mode && encrypt_mode)
+    {
+        output_size = problema_container_bound(input_len, 0);
+    }
+
+    output = (byte_t *)calloc(output_size > 0 ? output_size : 1, 1);
+    if (output == NULL)
+    {
+        fprintf(stderr, "오류: 출력을 위한 메모리를 할당할 수 없습니다.\n");
+        goto cleanup;
+    }
+
+    if (encrypt_mode)
+    {
+        printf("암호화 모드\n");
+        phase_begin(&run);
+        if (container_mode)
+        {
+            result = problema_container_encrypt(ctx, input, input_len, 0,
+                                                output, output_size, &output_len);
+        }
+        else
+        {
+            result = problema_encrypt(ctx, input, input_len, output, output_size, &output_len);
+        }
+        phase_end(&run, PHASE_CIPHER);
+        problema_log_sink_flush(trace_sink);
+        if (result != PROBLEMA_SUCCESS)
+        {
+            fprintf(stderr, "오류: 암호화 실패: %s\n", problema_error_string(result));
+            goto cleanup;
+        }
+
+        if (verbose_mode)
+        {
+            print_encryption_process(input, input_len, output, output_len);
+        }
+    }
+    else
+    {
+        printf("복호화 모드\n");
+        phase_begin(&run);
+        if (container_mode)
+        {
+            result = problema_container_decrypt(ctx, input, input_len,
+                                                output, output_size, &output_len);
+        }
+        else
+        {
+            result = problema_decrypt(ctx, input, input_len, output, output_size, &output_len);
+        }
+        phase_end(&run, PHASE_CIPHER);
+        problema_log_sink_flush(trace_sink);
+        if (result != PROBLEMA_SUCCESS)
+        {
+            fprintf(stderr, "오류: 복호화 실패: %s\n", problema_error_string(result));
+            goto cleanup;
+        }
+
+        if (verbose_mode)
+        {
+            print_decryption_process(input, input_len, output, output_len);
+        }
+    }
+
+    if (stats_mode)
+    {
+        ProblemaStats lib_stats;
+        problema_get_stats(&lib_stats);
+        split_transcode(&run, &lib_stats);
+    }
+
+    // 결과 출력
+    phase_begin(&run);
+    if (output_file != NULL)
+    {
+        // 파일에 출력 쓰기
+        FILE *fp = fopen(output_file, "wb");
+        if (fp == NULL)
+        {
+            fprintf(stderr, "오류: 출력 파일 '%s'을(를) 열 수 없습니다.\n", output_file);
+            goto cleanup;
+        }
+        fwrite(output, 1, output_len, fp);
+        fclose(fp);
+        printf("결과가 '%s' 파일에 저장되었습니다.\n", output_file);
+    }
+    else
+    {
+        // 표준 출력에 쓰기
+        if (!verbose_mode)
+        {
+            if (encrypt_mode)
+            {
+                // 암호화된 결과는 바이너리일 수 있으므로 16진수로 출력
+                static const char hex_digits[] = "0123456789ABCDEF";
+                char *hex = (char *)malloc(output_len * 2 + 1);
+                if (hex == NULL)
+                {
+                    fprintf(stderr, "오류: 출력을 위한 메모리를 할당할 수 없습니다.\n");
+                    goto cleanup;
+                }
+                for (size_t i = 0; i < output_len; i++)
+                {
+                    hex[2 * i] = hex_digits[output[i] >> 4];
+                    hex[2 * i + 1] = hex_digits[output[i] & 0x0F];
+                }
+                hex[2 * output_len] = '\0';
+                phase_end(&run, PHASE_ENCODE);
+
+                printf("암호화된 결과: %s\n", hex);
+                free(hex);
+            }
+            else
+            {
+                printf("복호화된 결과: %.*s\n", (int)output_len, output);
+            }
+        }
+    }
+    fflush(stdout);
+    phase_end(&run, PHASE_WRITE);
+
+    if (stats_mode)
+    {
+        print_run_stats(&run, ctx, stats_json);
+    }
+    status = 0;
+
+    // 정리
+cleanup:
+    save_timeline(run.timeline, timeline_file);
+    if (trace_sink != NULL)
+    {
+        ProblemaLogSinkStats trace_stats;
+        problema_log_sink_stats(trace_sink, &trace_stats);
+        problema_log_sink_destroy(trace_sink);
+        if (trace_stats.dropped > 0)
+        {
+            fprintf(stderr, "경고: 추적 버퍼가 가득 차 이벤트 %" PRIu64 "개를 기록하지 못했습니다.\n",
+                    trace_stats.dropped);
+        }
+    }
+    problema_context_free(ctx);
+    free(output);
+    free(input);
+
+    return status;
+}
@@ -11,9 +11,28 @@
 #include "problema.h"
 #include <string.h>
 #include <stdio.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) && !defined(PROBLEMA_NO_SIMD)
+#include <immintrin.h>
+#define PROBLEMA_HAVE_X86_SIMD 1
+#endif
+
+/* USDT 정적 추적점: sys/sdt.h(systemtap-sdt-dev)가 있으면 nop 명령 하나로 심고, 없으면 뺀다 */
+#if defined(__has_include) && !defined(PROBLEMA_NO_USDT)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define PROBLEMA_HAVE_USDT 1
+#endif
+#endif
 
 /* 디버그 모드 플래그 */
-static bool debug_mode = false;
+static _Thread_local bool debug_mode = false; // 스레드별 디버그 출력 설정
 
 /* 오류 코드 */
 #define PROBLEMA_SUCCESS 0
@@ -23,19 +42,387 @@ static bool debug_mode = false;
 #define PROBLEMA_ERROR_BUFFER_TOO_SMALL -4
 #define PROBLEMA_ERROR_INVALID_UTF8 -5
 
+/* 추적 훅: PROBLEMA_TRACE가 0이면 컴파일에서 빠지고, 켜져 있으면 분기 하나만 남는다 */
+#if PROBLEMA_TRACE
+#define TRACE_ON(ctx) __builtin_expect((ctx)->trace != NULL, 0)
+#define TIMELINE_ON(ctx) __builtin_expect((ctx)->timeline != NULL, 0)
+#else
+#define TRACE_ON(ctx) 0
+#define TIMELINE_ON(ctx) 0
+#endif
+/* 컨텍스트가 없는 경로(UTF-8 변환, 초기화)의 디버그 출력: 호출 스레드가 디버그 모드일 때만 출력하고
+   PROBLEMA_TRACE=0이면 컴파일에서 빠진다 */
+#if PROBLEMA_TRACE
+#define DEBUG_LOG(...)                            \
+    do                                            \
+    {                                             \
+        if (__builtin_expect(debug_mode, 0))      \
+        {                                         \
+            printf(__VA_ARGS__);                  \
+        }                                         \
+    } while (0)
+#else
+#define DEBUG_LOG(...) \
+    do                 \
+    {                  \
+    } while (0)
+#endif
+#define TRACE_STR_(x) #x
+#define TRACE_STR(x) TRACE_STR_(x)
+
+/* USDT 추적점 (공급자 이름 problema) */
+#ifdef PROBLEMA_HAVE_USDT
+#define PROBE1(name, a) DTRACE_PROBE1(problema, name, a)
+#define PROBE2(name, a, b) DTRACE_PROBE2(problema, name, a, b)
+#define PROBE3(name, a, b, c) DTRACE_PROBE3(problema, name, a, b, c)
+#else
+#define PROBE1(name, a) ((void)0)
+#define PROBE2(name, a, b) ((void)0)
+#define PROBE3(name, a, b, c) ((void)0)
+#endif
+
+/* 문자 단위 호출 진입/반환 (버퍼 부족은 필요한 길이와 함께 따로 알린다) */
+#define PROBE_CIPHER_ENTRY(encrypt, ctx, input_len)      \
+    do                                                   \
+    {                                                    \
+        if (encrypt)                                     \
+        {                                                \
+            PROBE2(encrypt_entry, (ctx), (input_len));   \
+        }                                                \
+        else                                             \
+        {                                                \
+            PROBE2(decrypt_entry, (ctx), (input_len));   \
+        }                                                \
+    } while (0)
+#define PROBE_CIPHER_RETURN(encrypt, ctx, output_len, output_size, result) \
+    do                                                                     \
+    {                                                                      \
+        if ((result) == PROBLEMA_ERROR_BUFFER_TOO_SMALL)                   \
+        {                                                                  \
+            PROBE2(buffer_too_small, (output_len), (output_size));         \
+        }                                                                  \
+        if (encrypt)                                                       \
+        {                                                                  \
+            PROBE3(encrypt_return, (ctx), (output_len), (result));         \
+        }                                                                  \
+        else                                                               \
+        {                                                                  \
+            PROBE3(decrypt_return, (ctx), (output_len), (result));         \
+        }                                                                  \
+    } while (0)
+
+/* 성능 카운터: 스레드마다 따로 두고 동기화 없이 갱신한다 */
+#if PROBLEMA_STATS
+#define STATS_ON(ctx) __builtin_expect((ctx)->stats_enabled, 0)
+#else
+#define STATS_ON(ctx) 0
+#endif
+#define STATS_TIMING_INTERVAL 64 // 문자 단계 시간은 이 간격마다 한 문자만 재고 간격만큼 곱한다
+static _Thread_local ProblemaStats thread_stats;
+static _Thread_local uint64_t thread_stats_mark;   // 마지막 구간이 끝난 시각
+static _Thread_local uint64_t thread_stats_weight; // 현재 문자의 시간 가중치 (0이면 재지 않음)
+
+/* 다중 블록 커널 */
+#define BLOCK_KERNEL_SCALAR 0
+#define BLOCK_KERNEL_SSSE3 1
+#define BLOCK_KERNEL_AVX2 2
+
+/* 실행 중 선택한 다중 블록 커널 (detect_block_kernel에서 한 번 설정) */
+static pthread_once_t block_kernel_once = PTHREAD_ONCE_INIT;
+static int block_kernel = BLOCK_KERNEL_SCALAR;
+static bool aesni_available = false;
+
+/* 전체 라운드 블록 변환의 열 단위 워드 읽기/쓰기 (빅엔디언) */
+#define LOAD_WORD(p) (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | \
+                      ((uint32_t)(p)[2] << 8) | (uint32_t)(p)[3])
+#define STORE_WORD(p, v)              \
+    do                                \
+    {                                 \
+        (p)[0] = (byte_t)((v) >> 24); \
+        (p)[1] = (byte_t)((v) >> 16); \
+        (p)[2] = (byte_t)((v) >> 8);  \
+        (p)[3] = (byte_t)(v);         \
+    } while (0)
+
+/* 컨테이너 형식 식별자 */
+static const byte_t container_magic[4] = {'P', 'R', 'B', 'L'};
+static const byte_t container_index_magic[4] = {'P', 'R', 'B', 'X'};
+static const byte_t checkpoint_magic[4] = {'P', 'R', 'B', 'C'};
+
+/**
+ * @brief 문자 단위 암호화 커서
+ *
+ * 문자 암호화에 필요한 가변 상태는 로터 위치와 직전 암호문 문자(피드백 워드)뿐이다.
+ * 테이블은 컨텍스트에서 읽기만 하므로 커서를 따로 두면 같은 컨텍스트 위에서
+ * 임의의 위치부터 처리를 시작할 수 있다.
+ */
+typedef struct
+{
+    int positions[PROBLEMA_NUM_ROTORS]; // 로터 위치
+    unicode_t feedback;                 // 피드백 워드 (feedback[0..3]의 빅엔디언 값)
+} CharCursor;
+
+/**
+ * @brief 작업 스레드별 배치 구간 [lo, hi) (하위 32비트 lo, 상위 32비트 hi)
+ *
+ * 캐시 라인 하나를 통째로 써서 스레드 간 거짓 공유를 막는다.
+ */
+typedef struct
+{
+    _Atomic uint64_t range;
+    char padding[64 - sizeof(uint64_t)];
+} WorkerRange;
+
+/**
+ * @brief 배치 작업 하나
+ */
+typedef struct
+{
+    const ProblemaContext *ctx; // 공유 스케줄
+    ProblemaBatchItem *items;   // 메시지 서술자
+    bool encrypt;               // 암호화 여부
+    int num_workers;            // 참여 스레드 수
+    WorkerRange *ranges;        // 스레드별 구간
+    ProblemaStats stats;        // 보조 스레드 카운터 합 (pool->lock으로 보호, 끝나면 호출 스레드에 더함)
+} BatchJob;
+
+/**
+ * @brief 컨텍스트 풀
+ */
+struct ProblemaContextPool
+{
+    _Atomic(ProblemaContext *) *slots; // 쉬는 컨텍스트 슬롯 (NULL은 빈 슬롯)
+    size_t capacity;                   // 슬롯 수
+    atomic_size_t cursor;              // 다음 탐색 시작 슬롯 (경합 분산)
+    byte_t key[PROBLEMA_KEY_SIZE];     // 새 컨텍스트용 키
+    ProblemaAllocator allocator;       // 컨텍스트 할당자
+    bool has_allocator;                // 사용자 할당자 지정 여부
+    unsigned flags;                    // 컨텍스트 할당 플래그
+    atomic_uint_fast64_t acquires;     // 대여 횟수
+    atomic_uint_fast64_t hits;         // 풀 적중 횟수
+    atomic_uint_fast64_t misses;       // 새 초기화 횟수
+    atomic_uint_fast64_t releases;     // 반납 횟수
+    atomic_uint_fast64_t discards;     // 초과 반납으로 해제한 횟수
+};
+
+/* 비동기 추적 싱크 */
+#define LOG_SINK_DEFAULT_CAPACITY 65536 // 스레드별 기본 링 버퍼 레코드 수
+#define LOG_SINK_IDLE_NS 1000000        // 배경 스레드가 빈 버퍼를 다시 볼 때까지 쉬는 시간
+#define LOG_RECORD_POSITIONS 0x1        // 레코드에 로터 위치가 있음
+#define LOG_RECORD_BLOCK 0x2            // 레코드에 블록 상태가 있음
+
+/**
+ * @brief 추적 레코드 (캐시 라인 하나 크기의 고정 레코드)
+ */
+typedef struct
+{
+    const char *label;                        // 단계 이름 (정적 문자열)
+    uint64_t bytes;                           // 바이트 수
+    uint64_t chars;                           // 문자 수
+    unicode_t code;                           // 코드 포인트
+    uint16_t positions[PROBLEMA_NUM_ROTORS];  // 로터 위치 (PROBLEMA_ROTOR_SIZE 미만)
+    byte_t block[PROBLEMA_BLOCK_SIZE];        // 블록 상태
+    uint8_t stage;                            // ProblemaTraceStage
+    uint8_t flags;                            // LOG_RECORD_*
+} LogRecord;
+
+/**
+ * @brief 스레드 하나의 단일 생산자/단일 소비자 링 버퍼
+ *
+ * 생산자(기록 스레드)만 head를, 소비자(배경 스레드)만 tail을 바꾼다.
+ * 두 인덱스를 다른 캐시 라인에 두어 서로의 쓰기가 상대 라인을 무효화하지 않게 한다.
+ * 기록 스레드가 끝나면 released를 세우고, 다음에 새로 기록하는 스레드가 링을 넘겨받는다.
+ */
+typedef struct
+{
+    _Alignas(PROBLEMA_CACHE_LINE) atomic_uint_fast64_t head; // 다음에 쓸 위치
+    _Alignas(PROBLEMA_CACHE_LINE) atomic_uint_fast64_t tail; // 다음에 읽을 위치
+    _Alignas(PROBLEMA_CACHE_LINE) atomic_bool released;      // 기록 스레드가 끝나 비어 있는지
+    uint64_t units;                                          // 지금까지 본 문자/블록 단위 수
+    bool sampling;                                           // 현재 단위를 기록하는지
+    atomic_uint_fast64_t recorded;                           // 기록한 이벤트 수
+    atomic_uint_fast64_t sampled_out;                        // 건너뛴 이벤트 수
+    atomic_uint_fast64_t dropped;                            // 버린 이벤트 수
+    _Alignas(PROBLEMA_CACHE_LINE) LogRecord records[];       // 레코드 (용량은 싱크에 기록)
+} LogRing;
+
+/**
+ * @brief 비동기 추적 싱크
+ */
+struct ProblemaLogSink
+{
+    FILE *out;                                           // 출력 스트림
+    size_t capacity;                                     // 링 버퍼 레코드 수 (2의 거듭제곱)
+    unsigned sample_every;                               // 표본 추출 간격
+    unsigned flags;                                      // PROBLEMA_LOG_SINK_*
+    _Atomic(LogRing *) rings[PROBLEMA_LOG_SINK_MAX_THREADS]; // 스레드별 링 버퍼
+    atomic_size_t num_rings;                             // 예약된 링 슬롯 수
+    pthread_key_t ring_key;                              // 호출 스레드의 링 (스레드가 끝나면 반납)
+    atomic_uint_fast64_t overflow;                       // 슬롯이 없어 버린 이벤트 수
+    atomic_uint_fast64_t written;                        // 출력한 이벤트 수
+    atomic_bool stop;                                    // 종료 요청
+    pthread_t thread;                                    // 배경 출력 스레드
+};
+
+/* 구간 타임라인 */
+#define TIMELINE_DEFAULT_CAPACITY 65536 // 스레드별 기본 구간 수
+#define TIMELINE_NAME_SIZE 32           // 스레드 이름 최대 길이 (NUL 포함)
+
+/**
+ * @brief 구간 하나 (Chrome 추적 이벤트의 "X" 이벤트)
+ */
+typedef struct
+{
+    uint64_t start;       // 시작 시각 (타임라인 기준 시각부터 나노초)
+    uint64_t duration;    // 길이 (나노초)
+    const char *category; // 분류 (정적 문자열)
+    const char *name;     // 이름 (정적 문자열)
+    const char *arg_name; // 인자 이름 (정적 문자열, NULL이면 인자 없음)
+    uint64_t arg;         // 인자 값
+} TimelineSpan;
+
+/**
+ * @brief 스레드 하나의 구간 버퍼
+ *
+ * 기록 스레드만 count를 늘리고, 출력은 기록이 멈춘 뒤에 한다.
+ */
+typedef struct
+{
+    pthread_t owner;                 // 기록 스레드
+    char name[TIMELINE_NAME_SIZE];   // 표시 이름 (빈 문자열이면 번호로 표시)
+    atomic_size_t count;             // 기록한 구간 수
+    atomic_uint_fast64_t dropped;    // 가득 차서 버린 구간 수
+    _Alignas(PROBLEMA_CACHE_LINE) TimelineSpan spans[]; // 구간 (용량은 타임라인에 기록)
+} TimelineBuffer;
+
+/**
+ * @brief 구간 타임라인
+ */
+struct ProblemaTimeline
+{
+    size_t capacity;                                                // 스레드별 구간 수
+    uint64_t origin;                                                // 기준 시각 (생성 시각)
+    _Atomic(TimelineBuffer *) buffers[PROBLEMA_TIMELINE_MAX_THREADS]; // 스레드별 버퍼
+    atomic_size_t num_buffers;                                      // 예약된 버퍼 슬롯 수
+    atomic_uint_fast64_t overflow;                                  // 슬롯이 없어 버린 구간 수
+};
+
+/**
+ * @brief 스레드 풀
+ */
+struct ProblemaThreadPool
+{
+    pthread_t *threads;     // 보조 작업 스레드 (호출 스레드는 0번 작업자)
+    int num_threads;        // 호출 스레드를 포함한 작업자 수
+    pthread_mutex_t submit; // 배치 제출 잠금 (작업 슬롯이 하나이므로 배치는 한 번에 하나)
+    pthread_mutex_t lock;   // 작업 배포용 잠금
+    pthread_cond_t wake;    // 새 작업 알림
+    pthread_cond_t done;    // 작업 완료 알림
+    uint64_t generation;    // 작업 세대 번호
+    int pending;            // 아직 끝나지 않은 보조 스레드 수
+    int next_id;            // 다음 보조 스레드 작업자 번호
+    bool shutdown;          // 종료 요청
+    BatchJob *job;          // 현재 작업
+};
+
 /* 내부 함수 선언 */
+static void *default_alloc(size_t size, size_t alignment, void *user);
+static int pool_new_context(ProblemaContextPool *pool, ProblemaContext **ctx);
+static void default_free(void *ptr, size_t size, void *user);
 static void init_rotors(ProblemaContext *ctx);
 static void init_plugboard(ProblemaContext *ctx);
 static void init_aes_components(ProblemaContext *ctx);
-static void rotate_rotors(ProblemaContext *ctx);
-static unicode_t apply_plugboard(ProblemaContext *ctx, unicode_t input);
-static unicode_t apply_rotors_forward(ProblemaContext *ctx, unicode_t input);
-static unicode_t apply_rotors_backward(ProblemaContext *ctx, unicode_t input);
-static void apply_aes_transformation(ProblemaContext *ctx, byte_t *block);
-static void apply_inverse_aes_transformation(ProblemaContext *ctx, byte_t *block);
+static void init_options(ProblemaContext *ctx);
+static void rotate_rotors(const ProblemaContext *ctx, int *positions);
+static unicode_t apply_plugboard(const ProblemaContext *ctx, unicode_t input);
+static unicode_t apply_rotors_forward(const ProblemaContext *ctx, const int *positions, unicode_t input);
+static unicode_t apply_rotors_backward(const ProblemaContext *ctx, const int *positions, unicode_t input);
+static void load_cursor(const ProblemaContext *ctx, CharCursor *cur);
+static void key_rotor_positions(const ProblemaContext *ctx, int *positions);
+static void seek_rotors(const ProblemaContext *ctx, int *positions, uint64_t steps);
+static int cipher_context(ProblemaContext *ctx, bool encrypt, const byte_t *input, size_t input_len,
+                          byte_t *output, size_t output_size, size_t *output_len);
+static int measure_context(const ProblemaContext *ctx, bool encrypt, const byte_t *input,
+                           size_t input_len, size_t *required);
+static void nonce_cursor(const ProblemaContext *ctx, const byte_t *nonce, CharCursor *cur);
+static int cipher_nonce(const ProblemaContext *ctx, const byte_t *nonce, bool encrypt,
+                        const byte_t *input, size_t input_len,
+                        byte_t *output, size_t output_size, size_t *output_len);
+static size_t skip_utf8_chars(const byte_t *data, size_t data_len, size_t offset, uint64_t count);
+static unicode_t previous_utf8_char(const byte_t *data, size_t offset);
+static int locate_char(const byte_t *data, size_t data_len, const ProblemaSeekIndex *index,
+                       uint64_t char_index, size_t *byte_offset);
+static void store_cursor(ProblemaContext *ctx, const CharCursor *cur);
+static int cipher_cursor(ProblemaCursor *cursor, bool encrypt, const byte_t *input, size_t input_len,
+                         byte_t *output, size_t output_size, size_t *output_len);
+static unicode_t encrypt_char_core(const ProblemaContext *ctx, CharCursor *cur, unicode_t input);
+static unicode_t decrypt_char_core(const ProblemaContext *ctx, CharCursor *cur, unicode_t input);
+static size_t decode_utf8_char(const byte_t *utf8, size_t avail, unicode_t *code);
+static size_t utf8_char_length(unicode_t code);
+static bool utf8_truncated(const byte_t *utf8, size_t avail);
+static void encode_utf8_char(unicode_t code, size_t len, byte_t *utf8);
+static int cipher_utf8(const ProblemaContext *ctx, CharCursor *cur, bool encrypt,
+                       const byte_t *input, size_t input_len, uint64_t max_chars,
+                       byte_t *output, size_t output_size, size_t *output_len,
+                       size_t *consumed, uint64_t *num_chars);
+static int run_batch(const ProblemaContext *ctx, ProblemaThreadPool *pool, bool encrypt,
+                     ProblemaBatchItem *items, size_t count);
+static void run_batch_worker(BatchJob *job, int id);
+static bool take_batch_item(WorkerRange *range, uint32_t *item);
+static void *thread_pool_main(void *arg);
+static void put_le16(byte_t *p, uint16_t v);
+static void put_le32(byte_t *p, uint32_t v);
+static void put_le64(byte_t *p, uint64_t v);
+static uint16_t get_le16(const byte_t *p);
+static uint32_t get_le32(const byte_t *p);
+static uint64_t get_le64(const byte_t *p);
+static void apply_aes_transformation(const ProblemaContext *ctx, byte_t *block);
+static void apply_inverse_aes_transformation(const ProblemaContext *ctx, byte_t *block);
 static void update_feedback(ProblemaContext *ctx, const byte_t *block);
-static void debug_print_state(const char *label, const byte_t *data, size_t len);
-static void debug_print_unicode(const char *label, unicode_t code);
+static byte_t gf_mul(byte_t a, byte_t b);
+static void encrypt_block_transform(const ProblemaContext *ctx, byte_t *block);
+static void decrypt_block_transform(const ProblemaContext *ctx, byte_t *block);
+static void encrypt_block_transform_untraced(const ProblemaContext *ctx, byte_t *block);
+static void decrypt_block_transform_untraced(const ProblemaContext *ctx, byte_t *block);
+static void init_standard_aes(ProblemaContext *ctx);
+static void init_block_tables(ProblemaAES *aes);
+static void encrypt_block_full(const ProblemaAES *aes, byte_t *block);
+static void decrypt_block_full(const ProblemaAES *aes, byte_t *block);
+static void detect_block_kernel(void);
+static void encrypt_blocks_scalar(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                                  size_t num_blocks);
+static void decrypt_blocks_scalar(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                                  size_t num_blocks);
+#ifdef PROBLEMA_HAVE_X86_SIMD
+static void encrypt_blocks_ssse3(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                                 size_t num_blocks);
+static void decrypt_blocks_ssse3(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                                 size_t num_blocks);
+static void decrypt_blocks_avx2(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                                size_t num_blocks);
+static void encrypt_blocks_aesni(const ProblemaAES *aes, byte_t *blocks, size_t num_blocks);
+static void decrypt_blocks_aesni(const ProblemaAES *aes, byte_t *blocks, size_t num_blocks);
+static void encrypt_chain_aesni(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                                size_t num_blocks);
+static void decrypt_chain_aesni(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                                size_t num_blocks);
+#endif
+static void trace_message(const ProblemaContext *ctx, const char *label);
+static LogRing *log_sink_ring(ProblemaLogSink *sink);
+static void log_ring_release(void *ring);
+static TimelineBuffer *timeline_buffer(ProblemaTimeline *timeline);
+static void timeline_json_string(FILE *out, const char *text);
+static size_t log_sink_drain(ProblemaLogSink *sink);
+static void *log_sink_main(void *arg);
+static void counter_add(atomic_uint_fast64_t *counter, uint64_t value);
+static uint64_t stats_clock(void);
+static void stats_merge(ProblemaStats *dst, const ProblemaStats *src);
+static void stats_lap(ProblemaStatStage stage);
+static void sleep_ns(long ns);
+static void trace_char(const ProblemaContext *ctx, ProblemaTraceStage stage, const char *label,
+                       unicode_t code, const int *positions);
+static void trace_block(const ProblemaContext *ctx, ProblemaTraceStage stage, const char *label,
+                        const byte_t *block);
 
 /* 오류 메시지 */
 static const char *error_messages[] = {
@@ -44,7 +431,13 @@ static const char *error_messages[] = {
     "유효하지 않은 키",
     "초기화되지 않은 컨텍스트",
     "버퍼 크기 부족",
-    "유효하지 않은 UTF-8 시퀀스"};
+    "유효하지 않은 UTF-8 시퀀스",
+    "유효하지 않은 컨테이너 형식",
+    "키 지문 불일치",
+    "메모리 할당 실패",
+    "범위를 벗어난 위치",
+    "지원하지 않는 블록 프로필",
+    "입출력 오류"};
 
 /**
  * @brief 프로블레마 컨텍스트 초기화
@@ -56,6 +449,8 @@ int problema_init(ProblemaContext *ctx, const byte_t *key)
         return PROBLEMA_ERROR_NULL_POINTER;
     }
 
+    PROBE1(init_start, ctx);
+
     /* 키 복사 */
     memcpy(ctx->key, key, PROBLEMA_KEY_SIZE);
 
@@ -68,16 +463,19 @@ int problema_init(ProblemaContext *ctx, const byte_t *key)
     memset(ctx->feedback, 0, PROBLEMA_BLOCK_SIZE);
     memset(ctx->initial_feedback, 0, PROBLEMA_BLOCK_SIZE);
 
-    /* 기본값은 암호화 모드 */
+    /* 기본값은 암호화 모드, 기존 블록 변환 */
     ctx->encrypt_mode = true;
+    init_options(ctx);
+
+    /* 직접 선언한 컨텍스트는 할당 정보가 없다 (problema_context_new가 이후에 채움) */
+    ctx->alloc_size = 0;
+    ctx->huge_pages = false;
 
     ctx->initialized = true;
 
-    if (debug_mode)
-    {
-        printf("[DEBUG] 프로블레마 컨텍스트 초기화 완료\n");
-    }
+    DEBUG_LOG("[DEBUG] 프로블레마 컨텍스트 초기화 완료\n");
 
+    PROBE1(init_done, ctx);
     return PROBLEMA_SUCCESS;
 }
 
@@ -98,258 +496,357 @@ void problema_cleanup(ProblemaContext *ctx)
     /* 초기화 상태 재설정 */
     ctx->initialized = false;
 
-    if (debug_mode)
-    {
-        printf("[DEBUG] 프로블레마 컨텍스트 해제 완료\n");
-    }
+    DEBUG_LOG("[DEBUG] 프로블레마 컨텍스트 해제 완료\n");
 }
 
 /**
- * @brief 단일 유니코드 문자 암호화
+ * @brief 힙에 컨텍스트를 할당하고 초기화
  */
-unicode_t problema_encrypt_char(ProblemaContext *ctx, unicode_t input)
+int problema_context_new(ProblemaContext **out, const byte_t *key,
+                         const ProblemaAllocator *allocator, unsigned flags)
 {
-    if (ctx == NULL || !ctx->initialized)
+    if (out == NULL || key == NULL)
     {
-        return input; /* 오류 시 원본 반환 */
+        return PROBLEMA_ERROR_NULL_POINTER;
     }
 
-    /* 암호화 모드로 설정 */
-    ctx->encrypt_mode = true;
-
-    if (debug_mode)
+    ProblemaAllocator alloc = {default_alloc, default_free, NULL};
+    if (allocator != NULL)
     {
-        debug_print_unicode("암호화 전 문자", input);
+        if (allocator->alloc == NULL || allocator->free == NULL)
+        {
+            return PROBLEMA_ERROR_NULL_POINTER;
+        }
+        alloc = *allocator;
     }
 
-    /* 암호화 과정 */
-    unicode_t output = input;
+    /* 대용량(huge) 페이지는 2MB 경계에 맞추고 크기도 2MB 단위로 올린다 */
+    bool huge = (flags & PROBLEMA_CONTEXT_HUGE_PAGES) != 0;
+    size_t alignment = huge ? PROBLEMA_HUGE_PAGE_SIZE : PROBLEMA_CACHE_LINE;
+    size_t size = (sizeof(ProblemaContext) + alignment - 1) / alignment * alignment;
 
-    /* 1. 플러그보드 적용 */
-    output = apply_plugboard(ctx, output);
-    if (debug_mode)
+    ProblemaContext *ctx = (ProblemaContext *)alloc.alloc(size, alignment, alloc.user);
+    if (ctx == NULL)
     {
-        debug_print_unicode("플러그보드 적용 후", output);
+        return PROBLEMA_ERROR_OUT_OF_MEMORY;
     }
 
-    /* 2. 순방향 로터 적용 */
-    output = apply_rotors_forward(ctx, output);
-    if (debug_mode)
+    bool huge_pages = false;
+#ifdef MADV_HUGEPAGE
+    if (huge)
     {
-        debug_print_unicode("순방향 로터 적용 후", output);
+        huge_pages = madvise(ctx, size, MADV_HUGEPAGE) == 0;
     }
+#endif
 
-    /* 3. 로터 회전 */
-    rotate_rotors(ctx);
-
-    /* 4. 역방향 로터 적용 */
-    output = apply_rotors_backward(ctx, output);
-    if (debug_mode)
+    int result = problema_init(ctx, key);
+    if (result != PROBLEMA_SUCCESS)
     {
-        debug_print_unicode("역방향 로터 적용 후", output);
+        alloc.free(ctx, size, alloc.user);
+        return result;
     }
 
-    /* 5. 피드백 적용 (문자의 바이트 표현을 XOR) */
-    byte_t char_bytes[4] = {0};
-    char_bytes[0] = (output >> 24) & 0xFF;
-    char_bytes[1] = (output >> 16) & 0xFF;
-    char_bytes[2] = (output >> 8) & 0xFF;
-    char_bytes[3] = output & 0xFF;
+    /* problema_init은 스택 컨텍스트 기준으로 할당 정보를 비우므로 그 뒤에 기록 */
+    ctx->allocator = alloc;
+    ctx->alloc_size = size;
+    ctx->huge_pages = huge_pages;
+    *out = ctx;
+    return PROBLEMA_SUCCESS;
+}
 
-    /* 피드백 상태 저장 (첫 번째 문자인 경우) */
-    if (memcmp(ctx->feedback, ctx->initial_feedback, PROBLEMA_BLOCK_SIZE) == 0)
+/**
+ * @brief problema_context_new로 만든 컨텍스트 정리 및 해제
+ */
+void problema_context_free(ProblemaContext *ctx)
+{
+    if (ctx == NULL)
     {
-        memcpy(ctx->initial_feedback, ctx->feedback, PROBLEMA_BLOCK_SIZE);
+        return;
     }
 
-    for (int i = 0; i < 4; i++)
-    {
-        char_bytes[i] ^= ctx->feedback[i % PROBLEMA_BLOCK_SIZE];
-    }
+    problema_cleanup(ctx);
 
-    output = ((unicode_t)char_bytes[0] << 24) |
-             ((unicode_t)char_bytes[1] << 16) |
-             ((unicode_t)char_bytes[2] << 8) |
-             char_bytes[3];
+    ProblemaAllocator alloc = ctx->allocator;
+    alloc.free(ctx, ctx->alloc_size, alloc.user);
+}
 
-    /* 피드백 상태 업데이트 */
-    for (int i = 0; i < 4; i++)
+/**
+ * @brief 컨텍스트를 키에서 유도한 시작 상태로 되돌림
+ */
+int problema_reset(ProblemaContext *ctx)
+{
+    if (ctx == NULL)
     {
-        ctx->feedback[i % PROBLEMA_BLOCK_SIZE] = char_bytes[i];
+        return PROBLEMA_ERROR_NULL_POINTER;
     }
 
-    if (debug_mode)
+    if (!ctx->initialized)
     {
-        debug_print_unicode("암호화 후 문자", output);
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
     }
 
-    return output;
+    CharCursor cur;
+    key_rotor_positions(ctx, cur.positions);
+    cur.feedback = 0;
+    store_cursor(ctx, &cur);
+
+    memset(ctx->feedback, 0, PROBLEMA_BLOCK_SIZE);
+    memset(ctx->initial_feedback, 0, PROBLEMA_BLOCK_SIZE);
+    ctx->encrypt_mode = true;
+
+    /* 풀에서 다음 사용자에게 넘어갈 때 앞 사용자의 콜백과 타임라인이 남지 않도록 */
+    init_options(ctx);
+
+    return PROBLEMA_SUCCESS;
 }
 
 /**
- * @brief 단일 유니코드 문자 복호화
+ * @brief 컨텍스트가 차지하는 메모리를 영역별로 조회
+ *
+ * 테이블 영역은 구조체 필드 크기로 세고, STATE는 나머지(가변 필드와 정렬 여백)로 두어
+ * SCRATCH를 뺀 영역의 합이 sizeof(ProblemaContext)와 같게 한다.
  */
-unicode_t problema_decrypt_char(ProblemaContext *ctx, unicode_t input)
+int problema_memory_usage(const ProblemaContext *ctx, ProblemaMemoryUsage *usage)
 {
-    if (ctx == NULL || !ctx->initialized)
+    if (ctx == NULL || usage == NULL)
     {
-        return input; /* 오류 시 원본 반환 */
+        return PROBLEMA_ERROR_NULL_POINTER;
     }
 
-    /* 복호화 모드로 설정 */
-    ctx->encrypt_mode = false;
-
-    if (debug_mode)
+    memset(usage, 0, sizeof(ProblemaMemoryUsage));
+    ProblemaMemoryRegionUsage *r = usage->regions;
+    const ProblemaAES *aes = &ctx->aes;
+
+    r[PROBLEMA_MEMORY_ROTORS].bytes = sizeof(ctx->rotors);
+    r[PROBLEMA_MEMORY_INVERSE_ROTORS].bytes = sizeof(ctx->inverse_rotors);
+    r[PROBLEMA_MEMORY_PLUGBOARD].bytes = sizeof(ctx->plugboard);
+    /* 블록 변환용 aes와 표준 AES용 aes_std 두 벌 */
+    r[PROBLEMA_MEMORY_SBOXES].bytes = 2 * (sizeof(aes->sbox) + sizeof(aes->inv_sbox));
+    r[PROBLEMA_MEMORY_ROUND_KEYS].bytes = 2 * (sizeof(aes->round_keys) + sizeof(aes->enc_keys) +
+                                               sizeof(aes->dec_keys) + sizeof(aes->inv_round_keys));
+    r[PROBLEMA_MEMORY_CACHES].bytes = 2 * (sizeof(aes->enc_tables) + sizeof(aes->dec_tables));
+
+    size_t tables = 0;
+    for (int i = 0; i < PROBLEMA_MEMORY_STATE; i++)
     {
-        debug_print_unicode("복호화 전 문자", input);
+        tables += r[i].bytes;
     }
+    r[PROBLEMA_MEMORY_STATE].bytes = sizeof(ProblemaContext) - tables;
+    r[PROBLEMA_MEMORY_SCRATCH].bytes = sizeof(thread_stats) + sizeof(thread_stats_mark) +
+                                       sizeof(thread_stats_weight) + sizeof(debug_mode);
+
+    /* 테이블은 초기화 뒤 읽기만 하고, 작업 공간은 스레드가 처음 쓸 때 만들어진다.
+       할당 정보는 problema_context_new로 만든 컨텍스트에만 있다 */
+    bool heap = ctx->alloc_size != 0;
+    unsigned huge = heap && ctx->huge_pages ? PROBLEMA_MEMORY_HUGE_PAGES : 0;
+    for (int i = 0; i < PROBLEMA_MEMORY_STATE; i++)
+    {
+        r[i].flags = PROBLEMA_MEMORY_SHARED | huge;
+        usage->shared_bytes += r[i].bytes;
+    }
+    r[PROBLEMA_MEMORY_STATE].flags = huge;
+    r[PROBLEMA_MEMORY_SCRATCH].flags = PROBLEMA_MEMORY_LAZY;
 
-    /* 복호화 과정 (암호화의 역순) */
-    unicode_t output = input;
-
-    /* 1. 현재 입력 저장 (피드백 업데이트용) */
-    byte_t input_bytes[4] = {0};
-    input_bytes[0] = (input >> 24) & 0xFF;
-    input_bytes[1] = (input >> 16) & 0xFF;
-    input_bytes[2] = (input >> 8) & 0xFF;
-    input_bytes[3] = input & 0xFF;
+    usage->context_bytes = sizeof(ProblemaContext);
+    usage->allocated_bytes = heap ? ctx->alloc_size : sizeof(ProblemaContext);
+    return PROBLEMA_SUCCESS;
+}
 
-    /* 2. 피드백 적용 (문자의 바이트 표현을 XOR) */
-    byte_t char_bytes[4] = {0};
-    char_bytes[0] = (output >> 24) & 0xFF;
-    char_bytes[1] = (output >> 16) & 0xFF;
-    char_bytes[2] = (output >> 8) & 0xFF;
-    char_bytes[3] = output & 0xFF;
+/**
+ * @brief 풀 설정으로 새 컨텍스트 생성
+ */
+static int pool_new_context(ProblemaContextPool *pool, ProblemaContext **ctx)
+{
+    return problema_context_new(ctx, pool->key, pool->has_allocator ? &pool->allocator : NULL,
+                                pool->flags);
+}
 
-    for (int i = 0; i < 4; i++)
+/**
+ * @brief 같은 키의 컨텍스트 풀 생성
+ */
+ProblemaContextPool *problema_context_pool_create(const byte_t *key, size_t capacity, size_t prewarm,
+                                                  const ProblemaAllocator *allocator, unsigned flags)
+{
+    if (key == NULL || capacity == 0)
     {
-        char_bytes[i] ^= ctx->feedback[i % PROBLEMA_BLOCK_SIZE];
+        return NULL;
     }
 
-    output = ((unicode_t)char_bytes[0] << 24) |
-             ((unicode_t)char_bytes[1] << 16) |
-             ((unicode_t)char_bytes[2] << 8) |
-             char_bytes[3];
-
-    /* 3. 피드백 상태 업데이트 (다음 문자를 위해) */
-    for (int i = 0; i < 4; i++)
+    ProblemaContextPool *pool = (ProblemaContextPool *)calloc(1, sizeof(ProblemaContextPool));
+    if (pool == NULL)
     {
-        ctx->feedback[i % PROBLEMA_BLOCK_SIZE] = input_bytes[i];
+        return NULL;
     }
 
-    /* 4. 역방향 로터 적용 (암호화의 순방향 로터에 해당) */
-    output = apply_rotors_backward(ctx, output);
-    if (debug_mode)
+    pool->slots = calloc(capacity, sizeof(*pool->slots));
+    if (pool->slots == NULL)
     {
-        debug_print_unicode("역방향 로터 적용 후", output);
+        free(pool);
+        return NULL;
     }
 
-    /* 5. 로터 회전 */
-    rotate_rotors(ctx);
-
-    /* 6. 순방향 로터 적용 (암호화의 역방향 로터에 해당) */
-    output = apply_rotors_forward(ctx, output);
-    if (debug_mode)
+    pool->capacity = capacity;
+    memcpy(pool->key, key, PROBLEMA_KEY_SIZE);
+    if (allocator != NULL)
     {
-        debug_print_unicode("순방향 로터 적용 후", output);
+        pool->allocator = *allocator;
+        pool->has_allocator = true;
     }
+    pool->flags = flags;
 
-    /* 7. 플러그보드 적용 */
-    output = apply_plugboard(ctx, output);
-    if (debug_mode)
+    for (size_t i = 0; i < capacity; i++)
+    {
+        atomic_init(&pool->slots[i], NULL);
+    }
+    atomic_init(&pool->cursor, 0);
+    atomic_init(&pool->acquires, 0);
+    atomic_init(&pool->hits, 0);
+    atomic_init(&pool->misses, 0);
+    atomic_init(&pool->releases, 0);
+    atomic_init(&pool->discards, 0);
+
+    if (prewarm > capacity)
     {
-        debug_print_unicode("플러그보드 적용 후", output);
+        prewarm = capacity;
     }
 
-    if (debug_mode)
+    for (size_t i = 0; i < prewarm; i++)
     {
-        debug_print_unicode("복호화 후 문자", output);
+        ProblemaContext *ctx = NULL;
+        if (pool_new_context(pool, &ctx) != PROBLEMA_SUCCESS)
+        {
+            problema_context_pool_destroy(pool);
+            return NULL;
+        }
+        atomic_store_explicit(&pool->slots[i], ctx, memory_order_relaxed);
     }
 
-    return output;
+    return pool;
 }
 
 /**
- * @brief 블록 암호화
+ * @brief 컨텍스트 풀 해제
  */
-void problema_encrypt_block(ProblemaContext *ctx, const byte_t *input, byte_t *output)
+void problema_context_pool_destroy(ProblemaContextPool *pool)
 {
-    if (ctx == NULL || input == NULL || output == NULL || !ctx->initialized)
+    if (pool == NULL)
     {
         return;
     }
 
-    if (debug_mode)
+    for (size_t i = 0; i < pool->capacity; i++)
     {
-        debug_print_state("암호화 전 블록", input, PROBLEMA_BLOCK_SIZE);
+        ProblemaContext *ctx = atomic_exchange(&pool->slots[i], NULL);
+        problema_context_free(ctx);
     }
 
-    /* 입력 블록 복사 */
-    memcpy(output, input, PROBLEMA_BLOCK_SIZE);
+    memset(pool->key, 0, PROBLEMA_KEY_SIZE);
+    free(pool->slots);
+    free(pool);
+}
 
-    /* 1. 피드백과 XOR */
-    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+/**
+ * @brief 풀에서 시작 상태의 컨텍스트를 빌림
+ *
+ * 슬롯을 한 바퀴 돌며 NULL과 교환해 컨텍스트를 꺼낸다. 탐색 시작점은 호출마다
+ * 바뀌므로 여러 스레드가 같은 슬롯을 두고 경합하는 일이 줄어든다.
+ */
+int problema_context_pool_acquire(ProblemaContextPool *pool, ProblemaContext **ctx)
+{
+    if (pool == NULL || ctx == NULL)
     {
-        output[i] ^= ctx->feedback[i];
+        return PROBLEMA_ERROR_NULL_POINTER;
     }
 
-    /* 2. AES 변환 적용 */
-    apply_aes_transformation(ctx, output);
-
-    /* 3. 피드백 업데이트 */
-    update_feedback(ctx, output);
+    atomic_fetch_add_explicit(&pool->acquires, 1, memory_order_relaxed);
 
-    if (debug_mode)
+    size_t start = atomic_fetch_add_explicit(&pool->cursor, 1, memory_order_relaxed);
+    for (size_t i = 0; i < pool->capacity; i++)
     {
-        debug_print_state("암호화 후 블록", output, PROBLEMA_BLOCK_SIZE);
+        _Atomic(ProblemaContext *) *slot = &pool->slots[(start + i) % pool->capacity];
+        if (atomic_load_explicit(slot, memory_order_relaxed) == NULL)
+        {
+            continue;
+        }
+
+        ProblemaContext *found = atomic_exchange_explicit(slot, NULL, memory_order_acquire);
+        if (found != NULL)
+        {
+            atomic_fetch_add_explicit(&pool->hits, 1, memory_order_relaxed);
+            *ctx = found;
+            return PROBLEMA_SUCCESS;
+        }
     }
+
+    atomic_fetch_add_explicit(&pool->misses, 1, memory_order_relaxed);
+    return pool_new_context(pool, ctx);
 }
 
 /**
- * @brief 블록 복호화
+ * @brief 빌린 컨텍스트를 시작 상태로 되돌려 풀에 반납
  */
-void problema_decrypt_block(ProblemaContext *ctx, const byte_t *input, byte_t *output)
+void problema_context_pool_release(ProblemaContextPool *pool, ProblemaContext *ctx)
 {
-    if (ctx == NULL || input == NULL || output == NULL || !ctx->initialized)
+    if (pool == NULL || ctx == NULL)
     {
         return;
     }
 
-    if (debug_mode)
+    atomic_fetch_add_explicit(&pool->releases, 1, memory_order_relaxed);
+
+    if (problema_reset(ctx) == PROBLEMA_SUCCESS)
     {
-        debug_print_state("복호화 전 블록", input, PROBLEMA_BLOCK_SIZE);
+        size_t start = atomic_fetch_add_explicit(&pool->cursor, 1, memory_order_relaxed);
+        for (size_t i = 0; i < pool->capacity; i++)
+        {
+            _Atomic(ProblemaContext *) *slot = &pool->slots[(start + i) % pool->capacity];
+            ProblemaContext *expected = NULL;
+            if (atomic_compare_exchange_strong_explicit(slot, &expected, ctx,
+                                                        memory_order_release,
+                                                        memory_order_relaxed))
+            {
+                return;
+            }
+        }
     }
 
-    /* 입력 블록 복사 및 임시 저장 (피드백 업데이트용) */
-    byte_t temp_block[PROBLEMA_BLOCK_SIZE];
-    memcpy(temp_block, input, PROBLEMA_BLOCK_SIZE);
-    memcpy(output, input, PROBLEMA_BLOCK_SIZE);
-
-    /* 1. 역 AES 변환 적용 */
-    apply_inverse_aes_transformation(ctx, output);
+    /* 풀이 가득 찼거나 정리된 컨텍스트는 해제 */
+    atomic_fetch_add_explicit(&pool->discards, 1, memory_order_relaxed);
+    problema_context_free(ctx);
+}
 
-    /* 2. 피드백과 XOR */
-    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+/**
+ * @brief 컨텍스트 풀 통계 조회
+ */
+void problema_context_pool_stats(ProblemaContextPool *pool, ProblemaPoolStats *stats)
+{
+    if (pool == NULL || stats == NULL)
     {
-        output[i] ^= ctx->feedback[i];
+        return;
     }
 
-    /* 3. 피드백 업데이트 */
-    update_feedback(ctx, temp_block);
-
-    if (debug_mode)
+    stats->acquires = atomic_load_explicit(&pool->acquires, memory_order_relaxed);
+    stats->hits = atomic_load_explicit(&pool->hits, memory_order_relaxed);
+    stats->misses = atomic_load_explicit(&pool->misses, memory_order_relaxed);
+    stats->releases = atomic_load_explicit(&pool->releases, memory_order_relaxed);
+    stats->discards = atomic_load_explicit(&pool->discards, memory_order_relaxed);
+    stats->capacity = pool->capacity;
+    stats->idle = 0;
+    for (size_t i = 0; i < pool->capacity; i++)
     {
-        debug_print_state("복호화 후 블록", output, PROBLEMA_BLOCK_SIZE);
+        if (atomic_load_explicit(&pool->slots[i], memory_order_relaxed) != NULL)
+        {
+            stats->idle++;
+        }
     }
 }
 
 /**
- * @brief UTF-8 문자열 암호화
+ * @brief 컨텍스트의 가변 상태 저장
  */
-int problema_encrypt(ProblemaContext *ctx, const byte_t *input, size_t input_len,
-                     byte_t *output, size_t output_size, size_t *output_len)
+int problema_snapshot(const ProblemaContext *ctx, ProblemaState *state)
 {
-    if (ctx == NULL || input == NULL || output == NULL || output_len == NULL)
+    if (ctx == NULL || state == NULL)
     {
         return PROBLEMA_ERROR_NULL_POINTER;
     }
@@ -359,55 +856,23 @@ int problema_encrypt(ProblemaContext *ctx, const byte_t *input, size_t input_len
         return PROBLEMA_ERROR_NOT_INITIALIZED;
     }
 
-    /* 암호화 모드로 설정 */
-    ctx->encrypt_mode = true;
-
-    /* 초기 상태 저장 */
-    byte_t initial_rotors_pos[PROBLEMA_NUM_ROTORS];
     for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
     {
-        initial_rotors_pos[r] = ctx->rotors[r].position;
+        state->positions[r] = ctx->rotors[r].position;
     }
+    memcpy(state->feedback, ctx->feedback, PROBLEMA_BLOCK_SIZE);
+    memcpy(state->initial_feedback, ctx->initial_feedback, PROBLEMA_BLOCK_SIZE);
+    state->encrypt_mode = ctx->encrypt_mode;
 
-    /* 피드백 초기화 */
-    memset(ctx->feedback, 0, PROBLEMA_BLOCK_SIZE);
-    memset(ctx->initial_feedback, 0, PROBLEMA_BLOCK_SIZE);
-
-    /* UTF-8 입력을 유니코드로 변환 */
-    unicode_t *unicode_buffer = (unicode_t *)malloc(input_len * sizeof(unicode_t));
-    if (unicode_buffer == NULL)
-    {
-        return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
-    }
-
-    size_t unicode_len = 0;
-    int result = utf8_to_unicode(input, input_len, unicode_buffer, input_len, &unicode_len);
-    if (result != PROBLEMA_SUCCESS)
-    {
-        free(unicode_buffer);
-        return result;
-    }
-
-    /* 각 유니코드 문자 암호화 */
-    for (size_t i = 0; i < unicode_len; i++)
-    {
-        unicode_buffer[i] = problema_encrypt_char(ctx, unicode_buffer[i]);
-    }
-
-    /* 암호화된 유니코드를 UTF-8로 변환 */
-    result = unicode_to_utf8(unicode_buffer, unicode_len, output, output_size, output_len);
-
-    free(unicode_buffer);
-    return result;
+    return PROBLEMA_SUCCESS;
 }
 
 /**
- * @brief UTF-8 문자열 복호화
+ * @brief 저장한 상태로 컨텍스트 되돌림
  */
-int problema_decrypt(ProblemaContext *ctx, const byte_t *input, size_t input_len,
-                     byte_t *output, size_t output_size, size_t *output_len)
+int problema_restore(ProblemaContext *ctx, const ProblemaState *state)
 {
-    if (ctx == NULL || input == NULL || output == NULL || output_len == NULL)
+    if (ctx == NULL || state == NULL)
     {
         return PROBLEMA_ERROR_NULL_POINTER;
     }
@@ -417,663 +882,4561 @@ int problema_decrypt(ProblemaContext *ctx, const byte_t *input, size_t input_len
         return PROBLEMA_ERROR_NOT_INITIALIZED;
     }
 
-    /* 복호화 모드로 설정 */
-    ctx->encrypt_mode = false;
+    for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+    {
+        if (state->positions[r] < 0 || state->positions[r] >= PROBLEMA_ROTOR_SIZE)
+        {
+            return PROBLEMA_ERROR_OUT_OF_RANGE;
+        }
+    }
 
-    /* 초기 상태 저장 */
-    byte_t initial_rotors_pos[PROBLEMA_NUM_ROTORS];
     for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
     {
-        initial_rotors_pos[r] = ctx->rotors[r].position;
+        ctx->rotors[r].position = state->positions[r];
+        ctx->inverse_rotors[r].position = state->positions[r];
     }
+    memcpy(ctx->feedback, state->feedback, PROBLEMA_BLOCK_SIZE);
+    memcpy(ctx->initial_feedback, state->initial_feedback, PROBLEMA_BLOCK_SIZE);
+    ctx->encrypt_mode = state->encrypt_mode;
 
-    /* 피드백 초기화 - 암호화와 동일한 초기 상태 사용 */
-    memset(ctx->feedback, 0, PROBLEMA_BLOCK_SIZE);
+    return PROBLEMA_SUCCESS;
+}
 
-    /* UTF-8 입력을 유니코드로 변환 */
-    unicode_t *unicode_buffer = (unicode_t *)malloc(input_len * sizeof(unicode_t));
-    if (unicode_buffer == NULL)
+/**
+ * @brief 컨텍스트의 현재 상태에서 커서 복제
+ */
+int problema_cursor_init(ProblemaCursor *cursor, const ProblemaContext *ctx)
+{
+    if (cursor == NULL)
     {
-        return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
+        return PROBLEMA_ERROR_NULL_POINTER;
     }
 
-    size_t unicode_len = 0;
-    int result = utf8_to_unicode(input, input_len, unicode_buffer, input_len, &unicode_len);
+    int result = problema_snapshot(ctx, &cursor->state);
     if (result != PROBLEMA_SUCCESS)
     {
-        free(unicode_buffer);
         return result;
     }
 
-    /* 각 유니코드 문자 복호화 */
-    for (size_t i = 0; i < unicode_len; i++)
-    {
-        unicode_buffer[i] = problema_decrypt_char(ctx, unicode_buffer[i]);
-    }
-
-    /* 복호화된 유니코드를 UTF-8로 변환 */
-    result = unicode_to_utf8(unicode_buffer, unicode_len, output, output_size, output_len);
-
-    free(unicode_buffer);
-    return result;
+    cursor->schedule = ctx;
+    return PROBLEMA_SUCCESS;
 }
 
 /**
- * @brief 디버그 모드 설정
+ * @brief 커서로 UTF-8 문자열 암호화
  */
-void problema_set_debug(bool enable)
+int problema_cursor_encrypt(ProblemaCursor *cursor, const byte_t *input, size_t input_len,
+                            byte_t *output, size_t output_size, size_t *output_len)
 {
-    debug_mode = enable;
-    if (debug_mode)
-    {
-        printf("[DEBUG] 디버그 모드 활성화\n");
-    }
+    return cipher_cursor(cursor, true, input, input_len, output, output_size, output_len);
 }
 
 /**
- * @brief 오류 코드에 대한 설명 문자열 반환
+ * @brief 커서로 UTF-8 문자열 복호화
  */
-const char *problema_error_string(int error_code)
+int problema_cursor_decrypt(ProblemaCursor *cursor, const byte_t *input, size_t input_len,
+                            byte_t *output, size_t output_size, size_t *output_len)
 {
-    error_code = -error_code;
-    if (error_code >= 0 && error_code < (int)(sizeof(error_messages) / sizeof(error_messages[0])))
-    {
-        return error_messages[error_code];
-    }
-    return "알 수 없는 오류";
+    return cipher_cursor(cursor, false, input, input_len, output, output_size, output_len);
 }
 
-/* UTF-8 관련 유틸리티 함수 구현 */
-
 /**
- * @brief UTF-8 문자열을 유니코드 코드 포인트 배열로 변환
+ * @brief 컨텍스트의 현재 로터 위치에서 스트림 시작
  */
-int utf8_to_unicode(const byte_t *utf8, size_t utf8_len,
-                    unicode_t *unicode, size_t unicode_size, size_t *unicode_len)
+int problema_stream_init(ProblemaStream *stream, const ProblemaContext *ctx, bool encrypt)
 {
-    if (utf8 == NULL || unicode == NULL || unicode_len == NULL)
+    if (stream == NULL)
     {
         return PROBLEMA_ERROR_NULL_POINTER;
     }
 
+    int result = problema_cursor_init(&stream->cursor, ctx);
+    if (result != PROBLEMA_SUCCESS)
+    {
+        return result;
+    }
+
+    /* problema_encrypt / problema_decrypt와 같이 0 피드백에서 시작 */
+    ProblemaState *state = &stream->cursor.state;
+    memset(state->feedback, 0, PROBLEMA_BLOCK_SIZE);
+    memset(state->initial_feedback, 0, PROBLEMA_BLOCK_SIZE);
+    state->encrypt_mode = encrypt;
+
+    stream->char_index = 0;
+    stream->input_offset = 0;
+    stream->output_offset = 0;
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 스트림에 입력 조각 하나 처리
+ */
+int problema_stream_update(ProblemaStream *stream, const byte_t *input, size_t input_len,
+                           byte_t *output, size_t output_size, size_t *output_len,
+                           size_t *consumed)
+{
+    if (stream == NULL || stream->cursor.schedule == NULL || input == NULL || output == NULL ||
+        output_len == NULL || consumed == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    const ProblemaContext *ctx = stream->cursor.schedule;
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    ProblemaState *state = &stream->cursor.state;
+    CharCursor cur;
+    memcpy(cur.positions, state->positions, sizeof(cur.positions));
+    cur.feedback = ((unicode_t)state->feedback[0] << 24) |
+                   ((unicode_t)state->feedback[1] << 16) |
+                   ((unicode_t)state->feedback[2] << 8) |
+                   state->feedback[3];
+
+    /* 조각 끝에서 잘린 문자는 다음 조각에서 처리 */
+    size_t complete = input_len;
+    for (size_t k = 1; k < 4 && k <= input_len; k++)
+    {
+        if ((input[input_len - k] & 0xC0) != 0x80)
+        {
+            if (utf8_truncated(input + input_len - k, k))
+            {
+                complete = input_len - k;
+            }
+            break;
+        }
+    }
+
+    size_t used = 0;
+    uint64_t chars = 0;
+    uint64_t span_start = TIMELINE_ON(ctx) ? problema_timeline_clock() : 0;
+    int result = cipher_utf8(ctx, &cur, state->encrypt_mode, input, complete, UINT64_MAX,
+                             output, output_size, output_len, &used, &chars);
+    if (TIMELINE_ON(ctx))
+    {
+        problema_timeline_span(ctx->timeline, "stream", "update", span_start, "bytes", complete);
+    }
+
+    *consumed = used;
+    if (result != PROBLEMA_SUCCESS)
+    {
+        return result;
+    }
+
+    memcpy(state->positions, cur.positions, sizeof(cur.positions));
+    state->feedback[0] = (cur.feedback >> 24) & 0xFF;
+    state->feedback[1] = (cur.feedback >> 16) & 0xFF;
+    state->feedback[2] = (cur.feedback >> 8) & 0xFF;
+    state->feedback[3] = cur.feedback & 0xFF;
+
+    stream->char_index += chars;
+    stream->input_offset += used;
+    stream->output_offset += *output_len;
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 스트림 진행 상태를 체크포인트로 직렬화
+ *
+ * 형식: 매직 "PRBC"(4) 버전(2) 방향(1) 예약(1) 키 지문(8) 문자 위치(8)
+ *       입력 위치(8) 출력 위치(8) 로터 위치(2 x 8) 피드백 워드(4) 예약(4)
+ */
+int problema_stream_checkpoint(const ProblemaStream *stream, byte_t *checkpoint)
+{
+    if (stream == NULL || stream->cursor.schedule == NULL || checkpoint == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    const ProblemaState *state = &stream->cursor.state;
+    memset(checkpoint, 0, PROBLEMA_CHECKPOINT_SIZE);
+    memcpy(checkpoint, checkpoint_magic, 4);
+    put_le16(checkpoint + 4, PROBLEMA_CHECKPOINT_VERSION);
+    checkpoint[6] = state->encrypt_mode ? 1 : 0;
+    put_le64(checkpoint + 8, problema_key_fingerprint(stream->cursor.schedule));
+    put_le64(checkpoint + 16, stream->char_index);
+    put_le64(checkpoint + 24, stream->input_offset);
+    put_le64(checkpoint + 32, stream->output_offset);
+    for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+    {
+        put_le16(checkpoint + 40 + 2 * r, (uint16_t)state->positions[r]);
+    }
+    memcpy(checkpoint + 56, state->feedback, 4);
+
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 체크포인트에서 스트림 복원
+ */
+int problema_stream_resume(ProblemaStream *stream, const ProblemaContext *ctx,
+                           const byte_t *checkpoint, size_t checkpoint_len)
+{
+    if (stream == NULL || ctx == NULL || checkpoint == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    if (checkpoint_len < PROBLEMA_CHECKPOINT_SIZE ||
+        memcmp(checkpoint, checkpoint_magic, 4) != 0 ||
+        get_le16(checkpoint + 4) != PROBLEMA_CHECKPOINT_VERSION || checkpoint[6] > 1)
+    {
+        return PROBLEMA_ERROR_INVALID_FORMAT;
+    }
+
+    if (get_le64(checkpoint + 8) != problema_key_fingerprint(ctx))
+    {
+        return PROBLEMA_ERROR_KEY_MISMATCH;
+    }
+
+    int result = problema_stream_init(stream, ctx, checkpoint[6] == 1);
+    if (result != PROBLEMA_SUCCESS)
+    {
+        return result;
+    }
+
+    stream->char_index = get_le64(checkpoint + 16);
+    stream->input_offset = get_le64(checkpoint + 24);
+    stream->output_offset = get_le64(checkpoint + 32);
+    for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+    {
+        stream->cursor.state.positions[r] = get_le16(checkpoint + 40 + 2 * r);
+    }
+    memcpy(stream->cursor.state.feedback, checkpoint + 56, 4);
+
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 단일 유니코드 문자 암호화
+ */
+unicode_t problema_encrypt_char(ProblemaContext *ctx, unicode_t input)
+{
+    if (ctx == NULL || !ctx->initialized)
+    {
+        return input; /* 오류 시 원본 반환 */
+    }
+
+    /* 암호화 모드로 설정 */
+    ctx->encrypt_mode = true;
+
+    CharCursor cur;
+    load_cursor(ctx, &cur);
+    if (STATS_ON(ctx))
+    {
+        thread_stats.chars++;
+        thread_stats_weight = 1;
+        thread_stats_mark = stats_clock();
+    }
+    unicode_t output = encrypt_char_core(ctx, &cur, input);
+    store_cursor(ctx, &cur);
+
+    return output;
+}
+
+/**
+ * @brief 단일 유니코드 문자 복호화
+ */
+unicode_t problema_decrypt_char(ProblemaContext *ctx, unicode_t input)
+{
+    if (ctx == NULL || !ctx->initialized)
+    {
+        return input; /* 오류 시 원본 반환 */
+    }
+
+    /* 복호화 모드로 설정 */
+    ctx->encrypt_mode = false;
+
+    CharCursor cur;
+    load_cursor(ctx, &cur);
+    if (STATS_ON(ctx))
+    {
+        thread_stats.chars++;
+        thread_stats_weight = 1;
+        thread_stats_mark = stats_clock();
+    }
+    unicode_t output = decrypt_char_core(ctx, &cur, input);
+    store_cursor(ctx, &cur);
+
+    return output;
+}
+
+/**
+ * @brief 블록 암호화
+ */
+void problema_encrypt_block(ProblemaContext *ctx, const byte_t *input, byte_t *output)
+{
+    if (ctx == NULL || input == NULL || output == NULL || !ctx->initialized)
+    {
+        return;
+    }
+
+    uint64_t start = STATS_ON(ctx) ? stats_clock() : 0;
+    if (TRACE_ON(ctx))
+    {
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_IN, "암호화 전 블록", input);
+    }
+
+    /* 입력 블록 복사 */
+    memcpy(output, input, PROBLEMA_BLOCK_SIZE);
+
+    /* 1. 피드백과 XOR */
+    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+    {
+        output[i] ^= ctx->feedback[i];
+    }
+
+    /* 2. AES 변환 적용 */
+    encrypt_block_transform(ctx, output);
+
+    /* 3. 피드백 업데이트 */
+    update_feedback(ctx, output);
+
+    if (TRACE_ON(ctx))
+    {
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_OUT, "암호화 후 블록", output);
+    }
+
+    if (STATS_ON(ctx))
+    {
+        thread_stats.blocks++;
+        thread_stats.cycles[PROBLEMA_STAT_BLOCK] += stats_clock() - start;
+    }
+}
+
+/**
+ * @brief 블록 복호화
+ */
+void problema_decrypt_block(ProblemaContext *ctx, const byte_t *input, byte_t *output)
+{
+    if (ctx == NULL || input == NULL || output == NULL || !ctx->initialized)
+    {
+        return;
+    }
+
+    uint64_t start = STATS_ON(ctx) ? stats_clock() : 0;
+    if (TRACE_ON(ctx))
+    {
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_IN, "복호화 전 블록", input);
+    }
+
+    /* 입력 블록 복사 및 임시 저장 (피드백 업데이트용) */
+    byte_t temp_block[PROBLEMA_BLOCK_SIZE];
+    memcpy(temp_block, input, PROBLEMA_BLOCK_SIZE);
+    memcpy(output, input, PROBLEMA_BLOCK_SIZE);
+
+    /* 1. 역 AES 변환 적용 */
+    decrypt_block_transform(ctx, output);
+
+    /* 2. 피드백과 XOR */
+    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+    {
+        output[i] ^= ctx->feedback[i];
+    }
+
+    /* 3. 피드백 업데이트 */
+    update_feedback(ctx, temp_block);
+
+    if (TRACE_ON(ctx))
+    {
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_OUT, "복호화 후 블록", output);
+    }
+
+    if (STATS_ON(ctx))
+    {
+        thread_stats.blocks++;
+        thread_stats.cycles[PROBLEMA_STAT_BLOCK] += stats_clock() - start;
+    }
+}
+
+/**
+ * @brief 블록 변환 프로필 선택
+ */
+int problema_set_block_profile(ProblemaContext *ctx, int profile)
+{
+    if (ctx == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (profile != PROBLEMA_BLOCK_PROFILE_COMPAT && profile != PROBLEMA_BLOCK_PROFILE_FULL &&
+        profile != PROBLEMA_BLOCK_PROFILE_AES)
+    {
+        return PROBLEMA_ERROR_INVALID_PROFILE;
+    }
+
+    ctx->block_profile = profile;
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 여러 블록을 한 번에 암호화
+ */
+int problema_encrypt_blocks(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                            size_t num_blocks)
+{
+    if (ctx == NULL || ((input == NULL || output == NULL) && num_blocks > 0))
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    pthread_once(&block_kernel_once, detect_block_kernel);
+
+    /* 추적은 블록 단위 함수가 담당 */
+    if (TRACE_ON(ctx))
+    {
+        for (size_t i = 0; i < num_blocks; i++)
+        {
+            problema_encrypt_block(ctx, input + i * PROBLEMA_BLOCK_SIZE,
+                                   output + i * PROBLEMA_BLOCK_SIZE);
+        }
+        return PROBLEMA_SUCCESS;
+    }
+
+    uint64_t start = STATS_ON(ctx) ? stats_clock() : 0;
+    uint64_t span_start = TIMELINE_ON(ctx) ? problema_timeline_clock() : 0;
+    PROBE2(blocks_encrypt, ctx, num_blocks);
+
+    /* 암호화는 피드백 사슬 때문에 직렬이므로 블록 하나 폭의 커널을 쓴다 */
+#ifdef PROBLEMA_HAVE_X86_SIMD
+    if (ctx->block_profile == PROBLEMA_BLOCK_PROFILE_AES && aesni_available)
+    {
+        encrypt_chain_aesni(ctx, input, output, num_blocks);
+    }
+    else if (ctx->block_profile == PROBLEMA_BLOCK_PROFILE_COMPAT && block_kernel != BLOCK_KERNEL_SCALAR)
+    {
+        encrypt_blocks_ssse3(ctx, input, output, num_blocks);
+    }
+    else
+#endif
+    {
+        encrypt_blocks_scalar(ctx, input, output, num_blocks);
+    }
+
+    if (STATS_ON(ctx))
+    {
+        thread_stats.blocks += num_blocks;
+        thread_stats.cycles[PROBLEMA_STAT_BLOCK] += stats_clock() - start;
+    }
+    if (TIMELINE_ON(ctx))
+    {
+        problema_timeline_span(ctx->timeline, "block", "encrypt_blocks", span_start, "blocks", num_blocks);
+    }
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 여러 블록을 한 번에 복호화
+ */
+int problema_decrypt_blocks(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                            size_t num_blocks)
+{
+    if (ctx == NULL || ((input == NULL || output == NULL) && num_blocks > 0))
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    pthread_once(&block_kernel_once, detect_block_kernel);
+
+    if (TRACE_ON(ctx))
+    {
+        /* 제자리 처리에서도 직전 암호문을 피드백으로 쓰도록 블록마다 복사 */
+        byte_t block[PROBLEMA_BLOCK_SIZE];
+        for (size_t i = 0; i < num_blocks; i++)
+        {
+            memcpy(block, input + i * PROBLEMA_BLOCK_SIZE, PROBLEMA_BLOCK_SIZE);
+            problema_decrypt_block(ctx, block, output + i * PROBLEMA_BLOCK_SIZE);
+        }
+        return PROBLEMA_SUCCESS;
+    }
+
+    uint64_t start = STATS_ON(ctx) ? stats_clock() : 0;
+    uint64_t span_start = TIMELINE_ON(ctx) ? problema_timeline_clock() : 0;
+    PROBE2(blocks_decrypt, ctx, num_blocks);
+
+#ifdef PROBLEMA_HAVE_X86_SIMD
+    if (ctx->block_profile == PROBLEMA_BLOCK_PROFILE_AES && aesni_available)
+    {
+        decrypt_chain_aesni(ctx, input, output, num_blocks);
+    }
+    else if (ctx->block_profile == PROBLEMA_BLOCK_PROFILE_COMPAT && block_kernel == BLOCK_KERNEL_AVX2)
+    {
+        decrypt_blocks_avx2(ctx, input, output, num_blocks);
+    }
+    else if (ctx->block_profile == PROBLEMA_BLOCK_PROFILE_COMPAT && block_kernel == BLOCK_KERNEL_SSSE3)
+    {
+        decrypt_blocks_ssse3(ctx, input, output, num_blocks);
+    }
+    else
+#endif
+    {
+        decrypt_blocks_scalar(ctx, input, output, num_blocks);
+    }
+
+    if (STATS_ON(ctx))
+    {
+        thread_stats.blocks += num_blocks;
+        thread_stats.cycles[PROBLEMA_STAT_BLOCK] += stats_clock() - start;
+    }
+    if (TIMELINE_ON(ctx))
+    {
+        problema_timeline_span(ctx->timeline, "block", "decrypt_blocks", span_start, "blocks", num_blocks);
+    }
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief PROBLEMA_BLOCK_PROFILE_AES가 사용하는 구현 이름
+ */
+const char *problema_aes_kernel(void)
+{
+    pthread_once(&block_kernel_once, detect_block_kernel);
+    return aesni_available ? "aesni" : "table";
+}
+
+/**
+ * @brief 카운터 모드 암호화/복호화
+ */
+int problema_ctr_crypt(const ProblemaContext *ctx, const byte_t *nonce, uint64_t block_index,
+                       const byte_t *input, byte_t *output, size_t len)
+{
+    if (ctx == NULL || nonce == NULL || ((input == NULL || output == NULL) && len > 0))
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    /* 호환 프로필은 서로 다른 카운터 블록을 같은 키스트림으로 보낼 수 있으므로 거부 */
+    if (ctx->block_profile == PROBLEMA_BLOCK_PROFILE_COMPAT)
+    {
+        return PROBLEMA_ERROR_INVALID_PROFILE;
+    }
+
+    /* 카운터가 한 바퀴 돌면 키스트림이 반복되므로 거부 */
+    uint64_t num_blocks = (len + PROBLEMA_BLOCK_SIZE - 1) / PROBLEMA_BLOCK_SIZE;
+    if (num_blocks > 0 && block_index > UINT64_MAX - (num_blocks - 1))
+    {
+        return PROBLEMA_ERROR_OUT_OF_RANGE;
+    }
+
+    uint64_t start = STATS_ON(ctx) ? stats_clock() : 0;
+    uint64_t span_start = TIMELINE_ON(ctx) ? problema_timeline_clock() : 0;
+    PROBE3(ctr_crypt, ctx, block_index, num_blocks);
+    byte_t counter[PROBLEMA_BLOCK_SIZE];
+    memcpy(counter, nonce, PROBLEMA_CTR_NONCE_SIZE);
+
+    for (size_t offset = 0; offset < len; offset += PROBLEMA_BLOCK_SIZE, block_index++)
+    {
+        byte_t keystream[PROBLEMA_BLOCK_SIZE];
+        for (int i = 0; i < 8; i++)
+        {
+            counter[PROBLEMA_CTR_NONCE_SIZE + i] = (byte_t)(block_index >> (56 - 8 * i));
+        }
+        memcpy(keystream, counter, PROBLEMA_BLOCK_SIZE);
+        encrypt_block_transform(ctx, keystream);
+
+        size_t n = len - offset < PROBLEMA_BLOCK_SIZE ? len - offset : PROBLEMA_BLOCK_SIZE;
+        for (size_t i = 0; i < n; i++)
+        {
+            output[offset + i] = input[offset + i] ^ keystream[i];
+        }
+    }
+
+    if (STATS_ON(ctx))
+    {
+        thread_stats.blocks += num_blocks;
+        thread_stats.cycles[PROBLEMA_STAT_BLOCK] += stats_clock() - start;
+    }
+    if (TIMELINE_ON(ctx))
+    {
+        problema_timeline_span(ctx->timeline, "block", "ctr_crypt", span_start, "blocks", num_blocks);
+    }
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 다중 블록 API가 사용하는 커널 이름
+ */
+const char *problema_block_kernel(void)
+{
+    static const char *names[] = {"scalar", "ssse3", "avx2"};
+
+    pthread_once(&block_kernel_once, detect_block_kernel);
+    return names[block_kernel];
+}
+
+/**
+ * @brief UTF-8 문자열 암호화
+ */
+int problema_encrypt(ProblemaContext *ctx, const byte_t *input, size_t input_len,
+                     byte_t *output, size_t output_size, size_t *output_len)
+{
+    if (ctx == NULL || input == NULL || output == NULL || output_len == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    /* 암호화 모드로 설정 */
+    ctx->encrypt_mode = true;
+
+    /* 피드백 초기화 */
+    memset(ctx->feedback, 0, PROBLEMA_BLOCK_SIZE);
+    memset(ctx->initial_feedback, 0, PROBLEMA_BLOCK_SIZE);
+
+    return cipher_context(ctx, true, input, input_len, output, output_size, output_len);
+}
+
+/**
+ * @brief UTF-8 문자열 복호화
+ */
+int problema_decrypt(ProblemaContext *ctx, const byte_t *input, size_t input_len,
+                     byte_t *output, size_t output_size, size_t *output_len)
+{
+    if (ctx == NULL || input == NULL || output == NULL || output_len == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    /* 복호화 모드로 설정 */
+    ctx->encrypt_mode = false;
+
+    /* 피드백 초기화 - 암호화와 동일한 초기 상태 사용 */
+    memset(ctx->feedback, 0, PROBLEMA_BLOCK_SIZE);
+
+    return cipher_context(ctx, false, input, input_len, output, output_size, output_len);
+}
+
+/**
+ * @brief 암호화/복호화 출력 크기의 상한
+ */
+size_t problema_output_bound(size_t input_len)
+{
+    if (input_len > SIZE_MAX / 4)
+    {
+        return SIZE_MAX;
+    }
+    return input_len * 4;
+}
+
+/**
+ * @brief problema_encrypt 출력의 정확한 길이
+ */
+int problema_encrypt_length(const ProblemaContext *ctx, const byte_t *input, size_t input_len,
+                            size_t *required)
+{
+    return measure_context(ctx, true, input, input_len, required);
+}
+
+/**
+ * @brief problema_decrypt 출력의 정확한 길이
+ */
+int problema_decrypt_length(const ProblemaContext *ctx, const byte_t *input, size_t input_len,
+                            size_t *required)
+{
+    return measure_context(ctx, false, input, input_len, required);
+}
+
+/**
+ * @brief 논스로 시작 상태를 정하는 메시지 단위 암호화
+ */
+int problema_encrypt_nonce(const ProblemaContext *ctx, const byte_t *nonce,
+                           const byte_t *input, size_t input_len,
+                           byte_t *output, size_t output_size, size_t *output_len)
+{
+    return cipher_nonce(ctx, nonce, true, input, input_len, output, output_size, output_len);
+}
+
+/**
+ * @brief 논스로 시작 상태를 정하는 메시지 단위 복호화
+ */
+int problema_decrypt_nonce(const ProblemaContext *ctx, const byte_t *nonce,
+                           const byte_t *input, size_t input_len,
+                           byte_t *output, size_t output_size, size_t *output_len)
+{
+    return cipher_nonce(ctx, nonce, false, input, input_len, output, output_size, output_len);
+}
+
+/**
+ * @brief 배치 처리용 스레드 풀 생성
+ */
+ProblemaThreadPool *problema_thread_pool_create(int num_threads)
+{
+    if (num_threads <= 0)
+    {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = cores > 0 ? (int)cores : 1;
+    }
+
+    ProblemaThreadPool *pool = (ProblemaThreadPool *)calloc(1, sizeof(ProblemaThreadPool));
+    if (pool == NULL)
+    {
+        return NULL;
+    }
+
+    pool->threads = (pthread_t *)calloc(num_threads, sizeof(pthread_t));
+    if (pool->threads == NULL)
+    {
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->submit, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    /* 호출 스레드가 0번 작업자이므로 보조 스레드는 하나 적게 만든다 */
+    pool->num_threads = 1;
+    for (int i = 1; i < num_threads; i++)
+    {
+        if (pthread_create(&pool->threads[i], NULL, thread_pool_main, pool) != 0)
+        {
+            break;
+        }
+        pool->num_threads++;
+    }
+
+    return pool;
+}
+
+/**
+ * @brief 스레드 풀 해제
+ */
+void problema_thread_pool_destroy(ProblemaThreadPool *pool)
+{
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 1; i < pool->num_threads; i++)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->submit);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->done);
+    free(pool->threads);
+    free(pool);
+}
+
+/**
+ * @brief 같은 키의 여러 메시지를 스레드 풀에서 나누어 암호화
+ */
+int problema_encrypt_batch(const ProblemaContext *ctx, ProblemaThreadPool *pool,
+                           ProblemaBatchItem *items, size_t count)
+{
+    return run_batch(ctx, pool, true, items, count);
+}
+
+/**
+ * @brief 같은 키의 여러 메시지를 스레드 풀에서 나누어 복호화
+ */
+int problema_decrypt_batch(const ProblemaContext *ctx, ProblemaThreadPool *pool,
+                           ProblemaBatchItem *items, size_t count)
+{
+    return run_batch(ctx, pool, false, items, count);
+}
+
+/**
+ * @brief 컨테이너 출력에 필요한 최대 크기
+ */
+size_t problema_container_bound(size_t input_len, uint32_t chunk_chars)
+{
+    if (chunk_chars == 0)
+    {
+        chunk_chars = PROBLEMA_DEFAULT_CHUNK_CHARS;
+    }
+
+    /* 문자 수는 입력 바이트 수를 넘지 않고, 문자 하나는 최대 4바이트로 인코딩된다 */
+    size_t max_chunks = input_len / chunk_chars + (input_len % chunk_chars != 0);
+    size_t fixed = PROBLEMA_CONTAINER_HEADER_SIZE + PROBLEMA_CONTAINER_FOOTER_SIZE;
+    size_t per_chunk = PROBLEMA_CHUNK_HEADER_SIZE + sizeof(uint64_t);
+
+    /* 넘치면 problema_output_bound처럼 할당할 수 없는 크기를 돌려준다 */
+    if (input_len > (SIZE_MAX - fixed) / 4 ||
+        max_chunks > (SIZE_MAX - fixed - input_len * 4) / per_chunk)
+    {
+        return SIZE_MAX;
+    }
+    return fixed + max_chunks * per_chunk + input_len * 4;
+}
+
+/**
+ * @brief UTF-8 문자열을 청크 단위 컨테이너로 암호화
+ *
+ * 형식 (리틀 엔디언):
+ *   헤더   : "PRBL", 버전(2), 프로파일(2), 키 지문(8), 청크 문자 수(4), 예약(4),
+ *            전체 문자 수(8), 청크 개수(8)
+ *   청크   : 시작 문자 인덱스(8), 로터 위치(2 x 8), 피드백 워드(4), 문자 수(4),
+ *            페이로드 길이(4), 예약(4), 페이로드
+ *   인덱스 : 청크 헤더 위치(8) x 청크 개수
+ *   푸터   : 인덱스 위치(8), "PRBX", 예약(4)
+ */
+int problema_container_encrypt(ProblemaContext *ctx, const byte_t *input, size_t input_len,
+                               uint32_t chunk_chars, byte_t *output, size_t output_size,
+                               size_t *output_len)
+{
+    if (ctx == NULL || input == NULL || output == NULL || output_len == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    if (chunk_chars == 0)
+    {
+        chunk_chars = PROBLEMA_DEFAULT_CHUNK_CHARS;
+    }
+
+    /* 청크 헤더의 문자 수와 페이로드 길이는 32비트이므로 최악의 경우(문자당 4바이트)도 들어가야 한다 */
+    if (chunk_chars > PROBLEMA_MAX_CHUNK_CHARS)
+    {
+        return PROBLEMA_ERROR_OUT_OF_RANGE;
+    }
+
+    if (output_size < PROBLEMA_CONTAINER_HEADER_SIZE + PROBLEMA_CONTAINER_FOOTER_SIZE)
+    {
+        return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    /* problema_encrypt와 같은 시작 상태 (현재 로터 위치, 0 피드백) */
+    CharCursor cur;
+    load_cursor(ctx, &cur);
+    cur.feedback = 0;
+
+    size_t pos = PROBLEMA_CONTAINER_HEADER_SIZE;
+    size_t in_pos = 0;
+    uint64_t total_chars = 0;
+    uint64_t num_chunks = 0;
+
+    while (in_pos < input_len)
+    {
+        if (pos + PROBLEMA_CHUNK_HEADER_SIZE > output_size)
+        {
+            return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
+        }
+
+        /* 청크 진입 상태 기록 */
+        byte_t *chunk = output + pos;
+        memset(chunk, 0, PROBLEMA_CHUNK_HEADER_SIZE);
+        put_le64(chunk, total_chars);
+        for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+        {
+            put_le16(chunk + 8 + r * 2, (uint16_t)cur.positions[r]);
+        }
+        put_le32(chunk + 24, cur.feedback);
+
+        size_t payload_len = 0, consumed = 0;
+        uint64_t chars = 0;
+        size_t payload_pos = pos + PROBLEMA_CHUNK_HEADER_SIZE;
+        uint64_t span_start = TIMELINE_ON(ctx) ? problema_timeline_clock() : 0;
+        int result = cipher_utf8(ctx, &cur, true, input + in_pos, input_len - in_pos, chunk_chars,
+                                 output + payload_pos, output_size - payload_pos,
+                                 &payload_len, &consumed, &chars);
+        if (result != PROBLEMA_SUCCESS)
+        {
+            return result;
+        }
+        if (TIMELINE_ON(ctx))
+        {
+            problema_timeline_span(ctx->timeline, "container", "encrypt_chunk", span_start,
+                                   "chunk", num_chunks);
+        }
+
+        put_le32(chunk + 28, (uint32_t)chars);
+        put_le32(chunk + 32, (uint32_t)payload_len);
+        PROBE3(chunk_encrypt, num_chunks, total_chars, payload_len);
+
+        in_pos += consumed;
+        total_chars += chars;
+        num_chunks++;
+        pos = payload_pos + payload_len;
+    }
+
+    /* 청크 인덱스와 푸터 */
+    size_t index_offset = pos;
+    if (pos + num_chunks * sizeof(uint64_t) + PROBLEMA_CONTAINER_FOOTER_SIZE > output_size)
+    {
+        return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    size_t chunk_pos = PROBLEMA_CONTAINER_HEADER_SIZE;
+    for (uint64_t c = 0; c < num_chunks; c++)
+    {
+        put_le64(output + pos, chunk_pos);
+        pos += sizeof(uint64_t);
+        chunk_pos += PROBLEMA_CHUNK_HEADER_SIZE + get_le32(output + chunk_pos + 32);
+    }
+
+    put_le64(output + pos, index_offset);
+    memcpy(output + pos + 8, container_index_magic, 4);
+    memset(output + pos + 12, 0, 4);
+    pos += PROBLEMA_CONTAINER_FOOTER_SIZE;
+
+    /* 헤더 */
+    memcpy(output, container_magic, 4);
+    put_le16(output + 4, PROBLEMA_CONTAINER_VERSION);
+    put_le16(output + 6, PROBLEMA_PROFILE_CHAR);
+    put_le64(output + 8, problema_key_fingerprint(ctx));
+    put_le32(output + 16, chunk_chars);
+    put_le32(output + 20, 0);
+    put_le64(output + 24, total_chars);
+    put_le64(output + 32, num_chunks);
+
+    ctx->encrypt_mode = true;
+    memset(ctx->feedback, 0, PROBLEMA_BLOCK_SIZE);
+    memset(ctx->initial_feedback, 0, PROBLEMA_BLOCK_SIZE);
+    store_cursor(ctx, &cur);
+
+    *output_len = pos;
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 컨테이너 헤더와 인덱스 검증
+ */
+int problema_container_open(const ProblemaContext *ctx, const byte_t *data, size_t data_len,
+                            ProblemaContainerInfo *info)
+{
+    if (data == NULL || info == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (data_len < PROBLEMA_CONTAINER_HEADER_SIZE + PROBLEMA_CONTAINER_FOOTER_SIZE ||
+        memcmp(data, container_magic, 4) != 0 ||
+        memcmp(data + data_len - 8, container_index_magic, 4) != 0)
+    {
+        return PROBLEMA_ERROR_INVALID_FORMAT;
+    }
+
+    info->version = get_le16(data + 4);
+    info->profile = get_le16(data + 6);
+    info->key_fingerprint = get_le64(data + 8);
+    info->chunk_chars = get_le32(data + 16);
+    info->total_chars = get_le64(data + 24);
+    info->num_chunks = get_le64(data + 32);
+    info->index_offset = get_le64(data + data_len - PROBLEMA_CONTAINER_FOOTER_SIZE);
+
+    if (info->version != PROBLEMA_CONTAINER_VERSION || info->profile != PROBLEMA_PROFILE_CHAR ||
+        info->chunk_chars == 0 || info->chunk_chars > PROBLEMA_MAX_CHUNK_CHARS)
+    {
+        return PROBLEMA_ERROR_INVALID_FORMAT;
+    }
+
+    /* 인덱스가 헤더와 푸터 사이에 정확히 들어맞는지 확인 */
+    size_t index_area = data_len - PROBLEMA_CONTAINER_FOOTER_SIZE;
+    if (info->index_offset < PROBLEMA_CONTAINER_HEADER_SIZE || info->index_offset > index_area ||
+        (index_area - info->index_offset) / sizeof(uint64_t) != info->num_chunks ||
+        (index_area - info->index_offset) % sizeof(uint64_t) != 0)
+    {
+        return PROBLEMA_ERROR_INVALID_FORMAT;
+    }
+
+    if (ctx != NULL)
+    {
+        if (!ctx->initialized)
+        {
+            return PROBLEMA_ERROR_NOT_INITIALIZED;
+        }
+        if (problema_key_fingerprint(ctx) != info->key_fingerprint)
+        {
+            return PROBLEMA_ERROR_KEY_MISMATCH;
+        }
+    }
+
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 인덱스로 청크 정보 조회
+ */
+int problema_container_chunk(const byte_t *data, size_t data_len, const ProblemaContainerInfo *info,
+                             uint64_t chunk, ProblemaChunkInfo *chunk_info)
+{
+    if (data == NULL || info == NULL || chunk_info == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    /* 파일에서 읽은 값끼리 더하면 넘칠 수 있으므로 경계는 모두 뺄셈으로 비교한다 */
+    if (chunk >= info->num_chunks || info->index_offset > data_len ||
+        info->num_chunks > (data_len - info->index_offset) / sizeof(uint64_t))
+    {
+        return PROBLEMA_ERROR_INVALID_FORMAT;
+    }
+
+    uint64_t offset = get_le64(data + info->index_offset + chunk * sizeof(uint64_t));
+    if (offset < PROBLEMA_CONTAINER_HEADER_SIZE ||
+        info->index_offset < PROBLEMA_CHUNK_HEADER_SIZE ||
+        offset > info->index_offset - PROBLEMA_CHUNK_HEADER_SIZE)
+    {
+        return PROBLEMA_ERROR_INVALID_FORMAT;
+    }
+
+    const byte_t *p = data + offset;
+    chunk_info->start_char = get_le64(p);
+    for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+    {
+        chunk_info->rotor_positions[r] = get_le16(p + 8 + r * 2);
+    }
+    chunk_info->feedback = get_le32(p + 24);
+    chunk_info->num_chars = get_le32(p + 28);
+    chunk_info->byte_length = get_le32(p + 32);
+    chunk_info->payload_offset = offset + PROBLEMA_CHUNK_HEADER_SIZE;
+
+    if (chunk_info->byte_length > info->index_offset - chunk_info->payload_offset ||
+        chunk_info->start_char > info->total_chars ||
+        chunk_info->num_chars > info->total_chars - chunk_info->start_char)
+    {
+        return PROBLEMA_ERROR_INVALID_FORMAT;
+    }
+
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 단일 청크 복호화
+ */
+int problema_container_decrypt_chunk(const ProblemaContext *ctx, const byte_t *data, size_t data_len,
+                                     const ProblemaChunkInfo *chunk, byte_t *output,
+                                     size_t output_size, size_t *output_len)
+{
+    if (ctx == NULL || data == NULL || chunk == NULL || output == NULL || output_len == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    if (chunk->payload_offset > data_len || chunk->byte_length > data_len - chunk->payload_offset)
+    {
+        return PROBLEMA_ERROR_INVALID_FORMAT;
+    }
+
+    /* 청크에 기록된 진입 상태에서 바로 시작 */
+    CharCursor cur;
+    memcpy(cur.positions, chunk->rotor_positions, sizeof(cur.positions));
+    cur.feedback = chunk->feedback;
+
+    size_t consumed = 0;
+    uint64_t chars = 0;
+    PROBE3(chunk_decrypt, chunk->start_char, chunk->num_chars, chunk->byte_length);
+    uint64_t span_start = TIMELINE_ON(ctx) ? problema_timeline_clock() : 0;
+    int result = cipher_utf8(ctx, &cur, false, data + chunk->payload_offset, chunk->byte_length,
+                             chunk->num_chars, output, output_size, output_len, &consumed, &chars);
+    if (TIMELINE_ON(ctx))
+    {
+        problema_timeline_span(ctx->timeline, "container", "decrypt_chunk", span_start,
+                               "start_char", chunk->start_char);
+    }
+    if (result != PROBLEMA_SUCCESS)
+    {
+        return result;
+    }
+
+    if (consumed != chunk->byte_length || chars != chunk->num_chars)
+    {
+        return PROBLEMA_ERROR_INVALID_FORMAT;
+    }
+
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 컨테이너 전체 복호화
+ */
+int problema_container_decrypt(const ProblemaContext *ctx, const byte_t *data, size_t data_len,
+                               byte_t *output, size_t output_size, size_t *output_len)
+{
+    if (ctx == NULL || data == NULL || output == NULL || output_len == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    ProblemaContainerInfo info;
+    int result = problema_container_open(ctx, data, data_len, &info);
+    if (result != PROBLEMA_SUCCESS)
+    {
+        return result;
+    }
+
+    size_t pos = 0;
+    for (uint64_t c = 0; c < info.num_chunks; c++)
+    {
+        ProblemaChunkInfo chunk;
+        result = problema_container_chunk(data, data_len, &info, c, &chunk);
+        if (result != PROBLEMA_SUCCESS)
+        {
+            return result;
+        }
+
+        size_t chunk_len = 0;
+        result = problema_container_decrypt_chunk(ctx, data, data_len, &chunk,
+                                                  output + pos, output_size - pos, &chunk_len);
+        if (result != PROBLEMA_SUCCESS)
+        {
+            return result;
+        }
+        pos += chunk_len;
+    }
+
+    *output_len = pos;
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 컨테이너에서 문자 범위 복호화
+ */
+int problema_container_decrypt_range(const ProblemaContext *ctx, const byte_t *data, size_t data_len,
+                                     uint64_t start_char, uint64_t num_chars,
+                                     byte_t *output, size_t output_size, size_t *output_len)
+{
+    if (ctx == NULL || data == NULL || output == NULL || output_len == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    ProblemaContainerInfo info;
+    int result = problema_container_open(ctx, data, data_len, &info);
+    if (result != PROBLEMA_SUCCESS)
+    {
+        return result;
+    }
+
+    if (start_char > info.total_chars)
+    {
+        return PROBLEMA_ERROR_OUT_OF_RANGE;
+    }
+    if (num_chars > info.total_chars - start_char)
+    {
+        num_chars = info.total_chars - start_char;
+    }
+
+    /* 마지막 청크를 제외한 모든 청크는 chunk_chars 문자를 담는다 */
+    size_t pos = 0;
+    for (uint64_t c = start_char / info.chunk_chars; num_chars > 0 && c < info.num_chunks; c++)
+    {
+        ProblemaChunkInfo chunk;
+        result = problema_container_chunk(data, data_len, &info, c, &chunk);
+        if (result != PROBLEMA_SUCCESS)
+        {
+            return result;
+        }
+
+        const byte_t *payload = data + chunk.payload_offset;
+        uint64_t skip = start_char > chunk.start_char ? start_char - chunk.start_char : 0;
+        size_t offset = skip_utf8_chars(payload, chunk.byte_length, 0, skip);
+        if (offset > chunk.byte_length)
+        {
+            return PROBLEMA_ERROR_INVALID_FORMAT;
+        }
+
+        CharCursor cur;
+        memcpy(cur.positions, chunk.rotor_positions, sizeof(cur.positions));
+        seek_rotors(ctx, cur.positions, skip);
+        cur.feedback = offset > 0 ? previous_utf8_char(payload, offset) : chunk.feedback;
+
+        size_t chunk_len = 0, consumed = 0;
+        uint64_t chars = 0;
+        PROBE3(chunk_decrypt, chunk.start_char + skip, num_chars, chunk.byte_length - offset);
+        uint64_t span_start = TIMELINE_ON(ctx) ? problema_timeline_clock() : 0;
+        result = cipher_utf8(ctx, &cur, false, payload + offset, chunk.byte_length - offset,
+                             num_chars, output + pos, output_size - pos,
+                             &chunk_len, &consumed, &chars);
+        if (TIMELINE_ON(ctx))
+        {
+            problema_timeline_span(ctx->timeline, "container", "decrypt_chunk", span_start,
+                                   "start_char", chunk.start_char + skip);
+        }
+        if (result != PROBLEMA_SUCCESS)
+        {
+            return result;
+        }
+
+        pos += chunk_len;
+        num_chars -= chars;
+    }
+
+    *output_len = pos;
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 암호문 탐색 인덱스 생성
+ */
+int problema_index_build(const byte_t *data, size_t data_len, uint64_t interval,
+                         ProblemaSeekIndex *index)
+{
+    if (data == NULL || index == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (interval == 0)
+    {
+        interval = PROBLEMA_DEFAULT_INDEX_INTERVAL;
+    }
+
+    /* 문자 수는 바이트 수를 넘지 않으므로 체크포인트 개수의 상한을 미리 안다 */
+    size_t capacity = data_len / interval + 1;
+    index->entries = (ProblemaIndexEntry *)malloc(capacity * sizeof(ProblemaIndexEntry));
+    if (index->entries == NULL)
+    {
+        return PROBLEMA_ERROR_OUT_OF_MEMORY;
+    }
+
+    size_t i = 0, n = 0;
+    uint64_t chars = 0;
+    while (i < data_len)
+    {
+        if (chars % interval == 0)
+        {
+            index->entries[n].char_index = chars;
+            index->entries[n].byte_offset = i;
+            n++;
+        }
+
+        unicode_t code;
+        size_t len = decode_utf8_char(data + i, data_len - i, &code);
+        if (len == 0)
+        {
+            free(index->entries);
+            index->entries = NULL;
+            return PROBLEMA_ERROR_INVALID_UTF8;
+        }
+        i += len;
+        chars++;
+    }
+
+    if (n == 0)
+    {
+        index->entries[0].char_index = 0;
+        index->entries[0].byte_offset = 0;
+        n = 1;
+    }
+
+    index->num_entries = n;
+    index->interval = interval;
+    index->total_chars = chars;
+    index->total_bytes = data_len;
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 탐색 인덱스 해제
+ */
+void problema_index_free(ProblemaSeekIndex *index)
+{
+    if (index == NULL)
+    {
+        return;
+    }
+
+    free(index->entries);
+    index->entries = NULL;
+    index->num_entries = 0;
+}
+
+/**
+ * @brief 암호문의 문자 범위 복호화
+ */
+int problema_decrypt_range(const ProblemaContext *ctx, const byte_t *data, size_t data_len,
+                           const ProblemaSeekIndex *index, uint64_t start_char, uint64_t num_chars,
+                           byte_t *output, size_t output_size, size_t *output_len)
+{
+    if (ctx == NULL || data == NULL || output == NULL || output_len == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    size_t offset = 0;
+    int result = locate_char(data, data_len, index, start_char, &offset);
+    if (result != PROBLEMA_SUCCESS)
+    {
+        return result;
+    }
+
+    /* 로터는 키에서 유도한 시작 위치에서 start_char 만큼 바로 이동 */
+    CharCursor cur;
+    key_rotor_positions(ctx, cur.positions);
+    seek_rotors(ctx, cur.positions, start_char);
+    cur.feedback = offset > 0 ? previous_utf8_char(data, offset) : 0;
+
+    size_t consumed = 0;
+    uint64_t chars = 0;
+    uint64_t span_start = TIMELINE_ON(ctx) ? problema_timeline_clock() : 0;
+    result = cipher_utf8(ctx, &cur, false, data + offset, data_len - offset, num_chars,
+                         output, output_size, output_len, &consumed, &chars);
+    if (TIMELINE_ON(ctx))
+    {
+        problema_timeline_span(ctx->timeline, "range", "decrypt_range", span_start,
+                               "start_char", start_char);
+    }
+    return result;
+}
+
+/**
+ * @brief 암호문의 바이트 범위 복호화
+ */
+int problema_decrypt_byte_range(const ProblemaContext *ctx, const byte_t *data, size_t data_len,
+                                const ProblemaSeekIndex *index, uint64_t byte_start, uint64_t byte_len,
+                                byte_t *output, size_t output_size, size_t *output_len)
+{
+    if (ctx == NULL || data == NULL || output == NULL || output_len == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (byte_start > data_len)
+    {
+        return PROBLEMA_ERROR_OUT_OF_RANGE;
+    }
+
+    uint64_t byte_end = byte_len > data_len - byte_start ? data_len : byte_start + byte_len;
+
+    /* byte_start 직전 체크포인트를 이분 탐색으로 찾은 뒤 문자 경계까지 훑기 */
+    uint64_t char_index = 0;
+    size_t offset = 0;
+    if (index != NULL && index->num_entries > 0)
+    {
+        if (index->total_bytes != data_len)
+        {
+            return PROBLEMA_ERROR_INVALID_FORMAT;
+        }
+
+        size_t lo = 0, hi = index->num_entries;
+        while (hi - lo > 1)
+        {
+            size_t mid = lo + (hi - lo) / 2;
+            if (index->entries[mid].byte_offset <= byte_start)
+            {
+                lo = mid;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        char_index = index->entries[lo].char_index;
+        offset = index->entries[lo].byte_offset;
+        if (offset > byte_start)
+        {
+            return PROBLEMA_ERROR_INVALID_FORMAT;
+        }
+    }
+
+    while (offset < byte_start)
+    {
+        offset = skip_utf8_chars(data, data_len, offset, 1);
+        char_index++;
+    }
+
+    /* 범위 안에서 시작하는 문자 수 */
+    uint64_t num_chars = 0;
+    while (offset < byte_end)
+    {
+        offset = skip_utf8_chars(data, data_len, offset, 1);
+        num_chars++;
+    }
+
+    return problema_decrypt_range(ctx, data, data_len, index, char_index, num_chars,
+                                  output, output_size, output_len);
+}
+
+/**
+ * @brief 키 지문 계산 (FNV-1a 64비트)
+ */
+uint64_t problema_key_fingerprint(const ProblemaContext *ctx)
+{
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    if (ctx == NULL)
+    {
+        return 0;
+    }
+
+    for (int i = 0; i < PROBLEMA_KEY_SIZE; i++)
+    {
+        hash ^= ctx->key[i];
+        hash *= 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief 디버그 모드 설정
+ */
+void problema_set_debug(bool enable)
+{
+    debug_mode = enable;
+    DEBUG_LOG("[DEBUG] 디버그 모드 활성화\n");
+}
+
+/**
+ * @brief 컨텍스트의 단계별 추적 콜백 설정
+ */
+void problema_set_trace(ProblemaContext *ctx, ProblemaTraceCallback callback, void *user)
+{
+    if (ctx == NULL)
+    {
+        return;
+    }
+
+    ctx->trace = callback;
+    ctx->trace_user = user;
+}
+
+/**
+ * @brief 추적 이벤트를 기존 [DEBUG] 형식으로 출력하는 기본 콜백
+ */
+void problema_trace_print(const ProblemaTraceEvent *event, void *user)
+{
+    FILE *out = user != NULL ? (FILE *)user : stdout;
+
+    /* 여러 스레드가 같은 스트림으로 추적해도 이벤트 한 줄이 섞이지 않도록 잠근다 */
+    flockfile(out);
+    switch (event->stage)
+    {
+    case PROBLEMA_TRACE_MESSAGE:
+        fprintf(out, "[DEBUG] %s\n", event->label);
+        break;
+    case PROBLEMA_TRACE_ROTOR_STEP:
+        fprintf(out, "[DEBUG] %s: ", event->label);
+        for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+        {
+            fprintf(out, "%d ", event->positions[r]);
+        }
+        fprintf(out, "\n");
+        break;
+    case PROBLEMA_TRACE_BLOCK_IN:
+    case PROBLEMA_TRACE_BLOCK_STAGE:
+    case PROBLEMA_TRACE_BLOCK_OUT:
+        fprintf(out, "[DEBUG] %s: ", event->label);
+        for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+        {
+            fprintf(out, "%02x ", event->block[i]);
+        }
+        fprintf(out, "\n");
+        break;
+    case PROBLEMA_TRACE_UTF8_DECODED:
+        fprintf(out, "[DEBUG] %s: %" PRIu64 " 바이트 → %" PRIu64 " 문자\n",
+                event->label, event->bytes, event->chars);
+        break;
+    case PROBLEMA_TRACE_INVALID_UTF8:
+        fprintf(out, "[DEBUG] %s: %02X\n", event->label, event->code);
+        break;
+    default:
+        fprintf(out, "[DEBUG] %s: U+%04X\n", event->label, event->code);
+        break;
+    }
+    funlockfile(out);
+}
+
+/**
+ * @brief 비동기 추적 싱크 생성
+ */
+ProblemaLogSink *problema_log_sink_create(FILE *out, size_t capacity, unsigned sample_every,
+                                          unsigned flags)
+{
+    ProblemaLogSink *sink = (ProblemaLogSink *)calloc(1, sizeof(ProblemaLogSink));
+    if (sink == NULL)
+    {
+        return NULL;
+    }
+
+    /* 인덱스를 마스크로 감을 수 있도록 2의 거듭제곱으로 올림 */
+    size_t cap = 2;
+    capacity = capacity > 0 ? capacity : LOG_SINK_DEFAULT_CAPACITY;
+    while (cap < capacity)
+    {
+        cap <<= 1;
+    }
+
+    sink->out = out != NULL ? out : stdout;
+    sink->capacity = cap;
+    sink->sample_every = sample_every > 0 ? sample_every : 1;
+    sink->flags = flags;
+    for (int i = 0; i < PROBLEMA_LOG_SINK_MAX_THREADS; i++)
+    {
+        atomic_init(&sink->rings[i], NULL);
+    }
+    atomic_init(&sink->num_rings, 0);
+    atomic_init(&sink->overflow, 0);
+    atomic_init(&sink->written, 0);
+    atomic_init(&sink->stop, false);
+
+    if (pthread_key_create(&sink->ring_key, log_ring_release) != 0)
+    {
+        free(sink);
+        return NULL;
+    }
+    if (pthread_create(&sink->thread, NULL, log_sink_main, sink) != 0)
+    {
+        pthread_key_delete(sink->ring_key);
+        free(sink);
+        return NULL;
+    }
+
+    return sink;
+}
+
+/**
+ * @brief 비동기 추적 싱크 해제
+ */
+void problema_log_sink_destroy(ProblemaLogSink *sink)
+{
+    if (sink == NULL)
+    {
+        return;
+    }
+
+    atomic_store_explicit(&sink->stop, true, memory_order_release);
+    pthread_join(sink->thread, NULL);
+    pthread_key_delete(sink->ring_key);
+
+    size_t bytes = sizeof(LogRing) + sink->capacity * sizeof(LogRecord);
+    for (int i = 0; i < PROBLEMA_LOG_SINK_MAX_THREADS; i++)
+    {
+        LogRing *ring = atomic_load_explicit(&sink->rings[i], memory_order_acquire);
+        if (ring != NULL)
+        {
+            default_free(ring, bytes, NULL);
+        }
+    }
+    free(sink);
+}
+
+/**
+ * @brief 지금까지 기록된 레코드가 모두 출력될 때까지 대기
+ */
+void problema_log_sink_flush(ProblemaLogSink *sink)
+{
+    if (sink == NULL)
+    {
+        return;
+    }
+
+    for (int i = 0; i < PROBLEMA_LOG_SINK_MAX_THREADS; i++)
+    {
+        LogRing *ring = atomic_load_explicit(&sink->rings[i], memory_order_acquire);
+        if (ring == NULL)
+        {
+            continue;
+        }
+
+        /* 배경 스레드는 레코드를 출력한 뒤에 tail을 옮기므로 따라잡으면 출력도 끝난 것 */
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        while (atomic_load_explicit(&ring->tail, memory_order_acquire) < head)
+        {
+            sleep_ns(LOG_SINK_IDLE_NS / 10);
+        }
+    }
+    fflush(sink->out);
+}
+
+/**
+ * @brief 비동기 추적 싱크 통계 조회
+ */
+void problema_log_sink_stats(ProblemaLogSink *sink, ProblemaLogSinkStats *stats)
+{
+    if (sink == NULL || stats == NULL)
+    {
+        return;
+    }
+
+    memset(stats, 0, sizeof(ProblemaLogSinkStats));
+    stats->dropped = atomic_load_explicit(&sink->overflow, memory_order_relaxed);
+    stats->written = atomic_load_explicit(&sink->written, memory_order_relaxed);
+    for (int i = 0; i < PROBLEMA_LOG_SINK_MAX_THREADS; i++)
+    {
+        LogRing *ring = atomic_load_explicit(&sink->rings[i], memory_order_acquire);
+        if (ring == NULL)
+        {
+            continue;
+        }
+        stats->recorded += atomic_load_explicit(&ring->recorded, memory_order_relaxed);
+        stats->sampled_out += atomic_load_explicit(&ring->sampled_out, memory_order_relaxed);
+        stats->dropped += atomic_load_explicit(&ring->dropped, memory_order_relaxed);
+        stats->threads++;
+    }
+}
+
+/**
+ * @brief 추적 이벤트를 싱크의 링 버퍼에 기록하는 콜백
+ */
+void problema_log_sink_trace(const ProblemaTraceEvent *event, void *user)
+{
+    ProblemaLogSink *sink = (ProblemaLogSink *)user;
+    LogRing *ring = log_sink_ring(sink);
+    if (ring == NULL)
+    {
+        atomic_fetch_add_explicit(&sink->overflow, 1, memory_order_relaxed);
+        return;
+    }
+
+    /* 문자/블록 단위로 표본을 고르고, 고른 단위의 단계 이벤트는 모두 남긴다 */
+    if (event->stage == PROBLEMA_TRACE_CHAR_IN || event->stage == PROBLEMA_TRACE_BLOCK_IN)
+    {
+        ring->sampling = ring->units % sink->sample_every == 0;
+        ring->units++;
+    }
+    if (!ring->sampling && event->stage != PROBLEMA_TRACE_UTF8_DECODED &&
+        event->stage != PROBLEMA_TRACE_INVALID_UTF8)
+    {
+        counter_add(&ring->sampled_out, 1);
+        return;
+    }
+
+    uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    while (head - atomic_load_explicit(&ring->tail, memory_order_acquire) >= sink->capacity)
+    {
+        if (!(sink->flags & PROBLEMA_LOG_SINK_BLOCK))
+        {
+            counter_add(&ring->dropped, 1);
+            return;
+        }
+        sleep_ns(LOG_SINK_IDLE_NS / 10);
+    }
+
+    LogRecord *rec = &ring->records[head & (sink->capacity - 1)];
+    rec->label = event->label;
+    rec->bytes = event->bytes;
+    rec->chars = event->chars;
+    rec->code = event->code;
+    rec->stage = (uint8_t)event->stage;
+    rec->flags = 0;
+    if (event->positions != NULL)
+    {
+        for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+        {
+            rec->positions[r] = (uint16_t)event->positions[r];
+        }
+        rec->flags |= LOG_RECORD_POSITIONS;
+    }
+    if (event->block != NULL)
+    {
+        memcpy(rec->block, event->block, PROBLEMA_BLOCK_SIZE);
+        rec->flags |= LOG_RECORD_BLOCK;
+    }
+
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    counter_add(&ring->recorded, 1);
+}
+
+/**
+ * @brief 구간 타임라인 생성
+ */
+ProblemaTimeline *problema_timeline_create(size_t capacity)
+{
+    ProblemaTimeline *timeline = (ProblemaTimeline *)calloc(1, sizeof(ProblemaTimeline));
+    if (timeline == NULL)
+    {
+        return NULL;
+    }
+
+    timeline->capacity = capacity > 0 ? capacity : TIMELINE_DEFAULT_CAPACITY;
+    timeline->origin = problema_timeline_clock();
+    for (int i = 0; i < PROBLEMA_TIMELINE_MAX_THREADS; i++)
+    {
+        atomic_init(&timeline->buffers[i], NULL);
+    }
+    atomic_init(&timeline->num_buffers, 0);
+    atomic_init(&timeline->overflow, 0);
+
+    return timeline;
+}
+
+/**
+ * @brief 구간 타임라인 해제
+ */
+void problema_timeline_destroy(ProblemaTimeline *timeline)
+{
+    if (timeline == NULL)
+    {
+        return;
+    }
+
+    size_t bytes = sizeof(TimelineBuffer) + timeline->capacity * sizeof(TimelineSpan);
+    for (int i = 0; i < PROBLEMA_TIMELINE_MAX_THREADS; i++)
+    {
+        TimelineBuffer *buffer = atomic_load_explicit(&timeline->buffers[i], memory_order_acquire);
+        if (buffer != NULL)
+        {
+            default_free(buffer, bytes, NULL);
+        }
+    }
+    free(timeline);
+}
+
+/**
+ * @brief 컨텍스트에 구간 타임라인 연결
+ */
+void problema_set_timeline(ProblemaContext *ctx, ProblemaTimeline *timeline)
+{
+    if (ctx == NULL)
+    {
+        return;
+    }
+
+    ctx->timeline = timeline;
+}
+
+/**
+ * @brief 타임라인 시각 (단조 시계 나노초)
+ */
+uint64_t problema_timeline_clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief 호출 스레드에 start부터 지금까지의 구간 기록
+ */
+void problema_timeline_span(ProblemaTimeline *timeline, const char *category, const char *name,
+                            uint64_t start, const char *arg_name, uint64_t arg)
+{
+    if (timeline == NULL)
+    {
+        return;
+    }
+
+    uint64_t end = problema_timeline_clock();
+    TimelineBuffer *buffer = timeline_buffer(timeline);
+    if (buffer == NULL)
+    {
+        atomic_fetch_add_explicit(&timeline->overflow, 1, memory_order_relaxed);
+        return;
+    }
+
+    size_t count = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    if (count >= timeline->capacity)
+    {
+        counter_add(&buffer->dropped, 1);
+        return;
+    }
+
+    TimelineSpan *span = &buffer->spans[count];
+    span->start = start > timeline->origin ? start - timeline->origin : 0;
+    span->duration = end > start ? end - start : 0;
+    span->category = category;
+    span->name = name;
+    span->arg_name = arg_name;
+    span->arg = arg;
+    atomic_store_explicit(&buffer->count, count + 1, memory_order_release);
+}
+
+/**
+ * @brief 호출 스레드의 타임라인 표시 이름 설정
+ */
+void problema_timeline_thread_name(ProblemaTimeline *timeline, const char *name)
+{
+    if (timeline == NULL || name == NULL)
+    {
+        return;
+    }
+
+    TimelineBuffer *buffer = timeline_buffer(timeline);
+    if (buffer != NULL)
+    {
+        snprintf(buffer->name, sizeof(buffer->name), "%s", name);
+    }
+}
+
+/**
+ * @brief 기록한 구간을 Chrome/Perfetto 추적 이벤트 JSON으로 출력
+ *
+ * 스레드 번호는 버퍼 슬롯 순서(1부터)이며, 시각은 마이크로초 단위 소수로 쓴다.
+ */
+int problema_timeline_write(ProblemaTimeline *timeline, FILE *out)
+{
+    if (timeline == NULL || out == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    long pid = (long)getpid();
+    uint64_t dropped = atomic_load_explicit(&timeline->overflow, memory_order_relaxed);
+    for (int i = 0; i < PROBLEMA_TIMELINE_MAX_THREADS; i++)
+    {
+        TimelineBuffer *buffer = atomic_load_explicit(&timeline->buffers[i], memory_order_acquire);
+        if (buffer != NULL)
+        {
+            dropped += atomic_load_explicit(&buffer->dropped, memory_order_relaxed);
+        }
+    }
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":%" PRIu64 "},\n", dropped);
+    fprintf(out, "\"traceEvents\":[\n");
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":0,"
+                 "\"args\":{\"name\":\"problema\"}}", pid);
+
+    for (int i = 0; i < PROBLEMA_TIMELINE_MAX_THREADS; i++)
+    {
+        TimelineBuffer *buffer = atomic_load_explicit(&timeline->buffers[i], memory_order_acquire);
+        if (buffer == NULL)
+        {
+            continue;
+        }
+
+        int tid = i + 1;
+        fprintf(out, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%d,"
+                     "\"args\":{\"name\":", pid, tid);
+        if (buffer->name[0] != '\0')
+        {
+            timeline_json_string(out, buffer->name);
+        }
+        else
+        {
+            fprintf(out, "\"thread %d\"", tid);
+        }
+        fprintf(out, "}}");
+
+        size_t count = atomic_load_explicit(&buffer->count, memory_order_acquire);
+        for (size_t k = 0; k < count; k++)
+        {
+            const TimelineSpan *span = &buffer->spans[k];
+            fprintf(out, ",\n{\"name\":");
+            timeline_json_string(out, span->name);
+            fprintf(out, ",\"cat\":");
+            timeline_json_string(out, span->category);
+            fprintf(out, ",\"ph\":\"X\",\"ts\":%" PRIu64 ".%03u,\"dur\":%" PRIu64 ".%03u,"
+                         "\"pid\":%ld,\"tid\":%d",
+                    span->start / 1000, (unsigned)(span->start % 1000),
+                    span->duration / 1000, (unsigned)(span->duration % 1000), pid, tid);
+            if (span->arg_name != NULL)
+            {
+                fprintf(out, ",\"args\":{");
+                timeline_json_string(out, span->arg_name);
+                fprintf(out, ":%" PRIu64 "}", span->arg);
+            }
+            fprintf(out, "}");
+        }
+    }
+
+    fprintf(out, "\n]}\n");
+    return ferror(out) ? PROBLEMA_ERROR_IO : PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 컨텍스트의 성능 카운터 수집 켜기/끄기
+ */
+void problema_set_stats(ProblemaContext *ctx, bool enable)
+{
+    if (ctx == NULL)
+    {
+        return;
+    }
+
+    ctx->stats_enabled = enable;
+}
+
+/**
+ * @brief 호출 스레드의 성능 카운터 조회
+ */
+int problema_get_stats(ProblemaStats *stats)
+{
+    if (stats == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    *stats = thread_stats;
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 호출 스레드의 성능 카운터 초기화
+ */
+void problema_reset_stats(void)
+{
+    memset(&thread_stats, 0, sizeof(ProblemaStats));
+}
+
+/**
+ * @brief 오류 코드에 대한 설명 문자열 반환
+ */
+const char *problema_error_string(int error_code)
+{
+    error_code = -error_code;
+    if (error_code >= 0 && error_code < (int)(sizeof(error_messages) / sizeof(error_messages[0])))
+    {
+        return error_messages[error_code];
+    }
+    return "알 수 없는 오류";
+}
+
+/* UTF-8 관련 유틸리티 함수 구현 */
+
+/**
+ * @brief UTF-8 문자열을 유니코드 코드 포인트 배열로 변환
+ */
+int utf8_to_unicode(const byte_t *utf8, size_t utf8_len,
+                    unicode_t *unicode, size_t unicode_size, size_t *unicode_len)
+{
+    if (utf8 == NULL || unicode == NULL || unicode_len == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    size_t i = 0, j = 0;
+
+    while (i < utf8_len && j < unicode_size)
+    {
+        if ((utf8[i] & 0x80) == 0)
+        {
+            /* ASCII 문자 (1바이트) */
+            unicode[j++] = utf8[i++];
+        }
+        else if ((utf8[i] & 0xE0) == 0xC0)
+        {
+            /* 2바이트 UTF-8 시퀀스 */
+            if (i + 1 >= utf8_len || (utf8[i + 1] & 0xC0) != 0x80)
+            {
+                DEBUG_LOG("[DEBUG] 유효하지 않은 2바이트 UTF-8 시퀀스: %02X %02X\n",
+                          utf8[i], (i + 1 < utf8_len) ? utf8[i + 1] : 0);
+                return PROBLEMA_ERROR_INVALID_UTF8;
+            }
+            unicode[j++] = ((utf8[i] & 0x1F) << 6) | (utf8[i + 1] & 0x3F);
+            i += 2;
+        }
+        else if ((utf8[i] & 0xF0) == 0xE0)
+        {
+            /* 3바이트 UTF-8 시퀀스 (한글 포함) */
+            if (i + 2 >= utf8_len || (utf8[i + 1] & 0xC0) != 0x80 || (utf8[i + 2] & 0xC0) != 0x80)
+            {
+                DEBUG_LOG("[DEBUG] 유효하지 않은 3바이트 UTF-8 시퀀스: %02X %02X %02X\n",
+                          utf8[i],
+                          (i + 1 < utf8_len) ? utf8[i + 1] : 0,
+                          (i + 2 < utf8_len) ? utf8[i + 2] : 0);
+                return PROBLEMA_ERROR_INVALID_UTF8;
+            }
+            unicode[j++] = ((utf8[i] & 0x0F) << 12) |
+                           ((utf8[i + 1] & 0x3F) << 6) |
+                           (utf8[i + 2] & 0x3F);
+            i += 3;
+        }
+        else if ((utf8[i] & 0xF8) == 0xF0)
+        {
+            /* 4바이트 UTF-8 시퀀스 */
+            if (i + 3 >= utf8_len ||
+                (utf8[i + 1] & 0xC0) != 0x80 ||
+                (utf8[i + 2] & 0xC0) != 0x80 ||
+                (utf8[i + 3] & 0xC0) != 0x80)
+            {
+                DEBUG_LOG("[DEBUG] 유효하지 않은 4바이트 UTF-8 시퀀스: %02X %02X %02X %02X\n",
+                          utf8[i],
+                          (i + 1 < utf8_len) ? utf8[i + 1] : 0,
+                          (i + 2 < utf8_len) ? utf8[i + 2] : 0,
+                          (i + 3 < utf8_len) ? utf8[i + 3] : 0);
+                return PROBLEMA_ERROR_INVALID_UTF8;
+            }
+            unicode[j++] = ((utf8[i] & 0x07) << 18) |
+                           ((utf8[i + 1] & 0x3F) << 12) |
+                           ((utf8[i + 2] & 0x3F) << 6) |
+                           (utf8[i + 3] & 0x3F);
+            i += 4;
+        }
+        else
+        {
+            /* 유효하지 않은 UTF-8 시퀀스 */
+            DEBUG_LOG("[DEBUG] 유효하지 않은 UTF-8 시퀀스 시작 바이트: %02X\n", utf8[i]);
+            return PROBLEMA_ERROR_INVALID_UTF8;
+        }
+    }
+
+    *unicode_len = j;
+
+    if (i < utf8_len && j >= unicode_size)
+    {
+        return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
+    }
+
+    DEBUG_LOG("[DEBUG] UTF-8 → 유니코드 변환: %zu 바이트 → %zu 문자\n", utf8_len, j);
+
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 유니코드 코드 포인트 배열을 UTF-8 문자열로 변환
+ */
+int unicode_to_utf8(const unicode_t *unicode, size_t unicode_len,
+                    byte_t *utf8, size_t utf8_size, size_t *utf8_len)
+{
+    if (unicode == NULL || utf8 == NULL || utf8_len == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    size_t i = 0, j = 0;
+
+    for (i = 0; i < unicode_len; i++)
+    {
+        unicode_t code = unicode[i];
+
+        if (code <= 0x7F)
+        {
+            /* ASCII 문자 (1바이트) */
+            if (j + 1 > utf8_size)
+            {
+                DEBUG_LOG("[DEBUG] 버퍼 크기 부족: ASCII 문자 U+%04X 인코딩 실패\n", code);
+                return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
+            }
+            utf8[j++] = (byte_t)code;
+        }
+        else if (code <= 0x7FF)
+        {
+            /* 2바이트 UTF-8 시퀀스 */
+            if (j + 2 > utf8_size)
+            {
+                DEBUG_LOG("[DEBUG] 버퍼 크기 부족: 2바이트 문자 U+%04X 인코딩 실패\n", code);
+                return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
+            }
+            utf8[j++] = (byte_t)(0xC0 | (code >> 6));
+            utf8[j++] = (byte_t)(0x80 | (code & 0x3F));
+        }
+        else if (code <= 0xFFFF)
+        {
+            /* 3바이트 UTF-8 시퀀스 (한글 포함) */
+            if (j + 3 > utf8_size)
+            {
+                DEBUG_LOG("[DEBUG] 버퍼 크기 부족: 3바이트 문자 U+%04X 인코딩 실패\n", code);
+                return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
+            }
+            utf8[j++] = (byte_t)(0xE0 | (code >> 12));
+            utf8[j++] = (byte_t)(0x80 | ((code >> 6) & 0x3F));
+            utf8[j++] = (byte_t)(0x80 | (code & 0x3F));
+        }
+        else if (code <= 0x10FFFF)
+        {
+            /* 4바이트 UTF-8 시퀀스 (이모지 등) */
+            if (j + 4 > utf8_size)
+            {
+                DEBUG_LOG("[DEBUG] 버퍼 크기 부족: 4바이트 문자 U+%04X 인코딩 실패\n", code);
+                return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
+            }
+            utf8[j++] = (byte_t)(0xF0 | (code >> 18));
+            utf8[j++] = (byte_t)(0x80 | ((code >> 12) & 0x3F));
+            utf8[j++] = (byte_t)(0x80 | ((code >> 6) & 0x3F));
+            utf8[j++] = (byte_t)(0x80 | (code & 0x3F));
+        }
+        else
+        {
+            /* 유효하지 않은 유니코드 코드 포인트 */
+            return PROBLEMA_ERROR_INVALID_UTF8;
+        }
+    }
+
+    *utf8_len = j;
+    return PROBLEMA_SUCCESS;
+}
+
+/* 내부 함수 구현 */
+
+/**
+ * @brief 기본 할당자 (정렬된 malloc)
+ */
+static void *default_alloc(size_t size, size_t alignment, void *user)
+{
+    (void)user;
+
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, alignment, size) != 0)
+    {
+        return NULL;
+    }
+    return ptr;
+}
+
+/**
+ * @brief 기본 해제 함수
+ */
+static void default_free(void *ptr, size_t size, void *user)
+{
+    (void)size;
+    (void)user;
+    free(ptr);
+}
+
+/**
+ * @brief 로터 초기화
+ */
+static void init_rotors(ProblemaContext *ctx)
+{
+    /* 키를 기반으로 로터 매핑 생성 */
+    for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+    {
+        /* 로터 위치 초기화 */
+        ctx->rotors[r].position = ctx->key[r % PROBLEMA_KEY_SIZE] % PROBLEMA_ROTOR_SIZE;
+
+        /* 노치 위치 초기화 */
+        ctx->rotors[r].num_notches = (ctx->key[(r + 1) % PROBLEMA_KEY_SIZE] % 7) + 1;
+        for (int n = 0; n < ctx->rotors[r].num_notches; n++)
+        {
+            ctx->rotors[r].notch_positions[n] =
+                (ctx->key[(r + n + 2) % PROBLEMA_KEY_SIZE] * 251) % PROBLEMA_ROTOR_SIZE;
+        }
+
+        /* 로터 매핑 초기화 (치환 테이블) */
+        for (int i = 0; i < PROBLEMA_ROTOR_SIZE; i++)
+        {
+            ctx->rotors[r].mapping[i] = i;
+        }
+
+        /* Fisher-Yates 셔플 알고리즘으로 매핑 섞기 */
+        for (int i = PROBLEMA_ROTOR_SIZE - 1; i > 0; i--)
+        {
+            int j = (ctx->key[(r + i) % PROBLEMA_KEY_SIZE] * i) % (i + 1);
+            unicode_t temp = ctx->rotors[r].mapping[i];
+            ctx->rotors[r].mapping[i] = ctx->rotors[r].mapping[j];
+            ctx->rotors[r].mapping[j] = temp;
+        }
+
+        /* 역방향 로터 초기화 */
+        for (int i = 0; i < PROBLEMA_ROTOR_SIZE; i++)
+        {
+            ctx->inverse_rotors[r].mapping[ctx->rotors[r].mapping[i]] = i;
+        }
+        ctx->inverse_rotors[r].position = ctx->rotors[r].position;
+        ctx->inverse_rotors[r].num_notches = ctx->rotors[r].num_notches;
+        for (int n = 0; n < ctx->rotors[r].num_notches; n++)
+        {
+            ctx->inverse_rotors[r].notch_positions[n] = ctx->rotors[r].notch_positions[n];
+        }
+    }
+
+    DEBUG_LOG("[DEBUG] 로터 초기화 완료\n");
+}
+
+/**
+ * @brief 플러그보드 초기화
+ */
+static void init_plugboard(ProblemaContext *ctx)
+{
+    /* 초기 매핑은 항등 매핑 */
+    for (int i = 0; i < PROBLEMA_ROTOR_SIZE; i++)
+    {
+        ctx->plugboard.mapping[i] = i;
+    }
+
+    /* 키를 기반으로 일부 문자 쌍 교환 */
+    int num_swaps = (ctx->key[0] % 100) + 50;
+    for (int i = 0; i < num_swaps; i++)
+    {
+        int a = (ctx->key[i % PROBLEMA_KEY_SIZE] * 251 + ctx->key[(i + 1) % PROBLEMA_KEY_SIZE]) % PROBLEMA_ROTOR_SIZE;
+        int b = (ctx->key[(i + 2) % PROBLEMA_KEY_SIZE] * 251 + ctx->key[(i + 3) % PROBLEMA_KEY_SIZE]) % PROBLEMA_ROTOR_SIZE;
+
+        unicode_t temp = ctx->plugboard.mapping[a];
+        ctx->plugboard.mapping[a] = ctx->plugboard.mapping[b];
+        ctx->plugboard.mapping[b] = temp;
+    }
+
+    DEBUG_LOG("[DEBUG] 플러그보드 초기화 완료\n");
+}
+
+/**
+ * @brief AES 컴포넌트 초기화
+ */
+static void init_aes_components(ProblemaContext *ctx)
+{
+    /* 간소화된 S-Box 초기화 (실제 AES S-Box 대신 키 기반 생성) */
+    for (int i = 0; i < PROBLEMA_SBOX_SIZE; i++)
+    {
+        ctx->aes.sbox[i] = i;
+    }
+
+    /* 키를 기반으로 S-Box 섞기 */
+    for (int i = PROBLEMA_SBOX_SIZE - 1; i > 0; i--)
+    {
+        int j = (ctx->key[i % PROBLEMA_KEY_SIZE] * i) % (i + 1);
+        byte_t temp = ctx->aes.sbox[i];
+        ctx->aes.sbox[i] = ctx->aes.sbox[j];
+        ctx->aes.sbox[j] = temp;
+    }
+
+    /* 역 S-Box 생성 */
+    for (int i = 0; i < PROBLEMA_SBOX_SIZE; i++)
+    {
+        ctx->aes.inv_sbox[ctx->aes.sbox[i]] = i;
+    }
+
+    /* 라운드 키 생성 (간소화된 키 스케줄링) */
+    for (int round = 0; round <= PROBLEMA_NUM_ROUNDS; round++)
+    {
+        for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+        {
+            ctx->aes.round_keys[round][i] = ctx->key[(i + round * 4) % PROBLEMA_KEY_SIZE];
+        }
+    }
+
+    /* 전체 라운드 변환용 결합 테이블 */
+    init_block_tables(&ctx->aes);
+
+    /* 표준 AES-256 프로필 (AES-NI 또는 같은 결과의 T-테이블) */
+    init_standard_aes(ctx);
+
+    DEBUG_LOG("[DEBUG] AES 컴포넌트 초기화 완료\n");
+}
+
+/**
+ * @brief 컨텍스트 옵션(블록 프로필, 추적, 타임라인, 통계)을 기본값으로 설정
+ */
+static void init_options(ProblemaContext *ctx)
+{
+    ctx->block_profile = PROBLEMA_BLOCK_PROFILE_COMPAT;
+
+    /* 디버그 모드에서 만든 컨텍스트는 기본 출력 콜백으로 추적 */
+    ctx->trace = debug_mode ? problema_trace_print : NULL;
+    ctx->trace_user = NULL;
+    ctx->timeline = NULL;
+    ctx->stats_enabled = false;
+}
+
+/**
+ * @brief 로터 회전
+ */
+static void rotate_rotors(const ProblemaContext *ctx, int *positions)
+{
+    /* 첫 번째 로터는 항상 회전 */
+    positions[0] = (positions[0] + 1) % PROBLEMA_ROTOR_SIZE;
+
+    /* 나머지 로터는 이전 로터가 노치 위치에 있을 때 회전 */
+    for (int r = 0; r < PROBLEMA_NUM_ROTORS - 1; r++)
+    {
+        bool at_notch = false;
+        for (int n = 0; n < ctx->rotors[r].num_notches; n++)
+        {
+            if (positions[r] == ctx->rotors[r].notch_positions[n])
+            {
+                at_notch = true;
+                break;
+            }
+        }
+
+        if (at_notch)
+        {
+            positions[r + 1] = (positions[r + 1] + 1) % PROBLEMA_ROTOR_SIZE;
+            PROBE2(notch_cascade, r + 1, positions[r + 1]);
+            if (STATS_ON(ctx))
+            {
+                thread_stats.rotor_steps[r + 1]++;
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (STATS_ON(ctx))
+    {
+        thread_stats.rotor_steps[0]++;
+    }
+
+    if (TRACE_ON(ctx))
+    {
+        trace_char(ctx, PROBLEMA_TRACE_ROTOR_STEP, "로터 회전 상태", 0, positions);
+    }
+}
+
+/**
+ * @brief 플러그보드 적용
+ */
+static unicode_t apply_plugboard(const ProblemaContext *ctx, unicode_t input)
+{
+    if (input < PROBLEMA_ROTOR_SIZE)
+    {
+        return ctx->plugboard.mapping[input];
+    }
+    return input;
+}
+
+/**
+ * @brief 순방향 로터 적용
+ */
+static unicode_t apply_rotors_forward(const ProblemaContext *ctx, const int *positions, unicode_t input)
+{
+    if (input >= PROBLEMA_ROTOR_SIZE)
+    {
+        return input;
+    }
+
+    unicode_t output = input;
+
+    for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+    {
+        int pos = positions[r];
+        output = ctx->rotors[r].mapping[(output + pos) % PROBLEMA_ROTOR_SIZE];
+        output = (output + PROBLEMA_ROTOR_SIZE - pos) % PROBLEMA_ROTOR_SIZE;
+    }
+
+    return output;
+}
+
+/**
+ * @brief 역방향 로터 적용
+ */
+static unicode_t apply_rotors_backward(const ProblemaContext *ctx, const int *positions, unicode_t input)
+{
+    if (input >= PROBLEMA_ROTOR_SIZE)
+    {
+        return input;
+    }
+
+    unicode_t output = input;
+
+    for (int r = PROBLEMA_NUM_ROTORS - 1; r >= 0; r--)
+    {
+        int pos = positions[r];
+        output = (output + pos) % PROBLEMA_ROTOR_SIZE;
+        output = ctx->inverse_rotors[r].mapping[output];
+        output = (output + PROBLEMA_ROTOR_SIZE - pos) % PROBLEMA_ROTOR_SIZE;
+    }
+
+    return output;
+}
+
+/**
+ * @brief 컨텍스트의 로터 위치와 피드백을 커서로 읽기
+ */
+static void load_cursor(const ProblemaContext *ctx, CharCursor *cur)
+{
+    for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+    {
+        cur->positions[r] = ctx->rotors[r].position;
+    }
+
+    cur->feedback = ((unicode_t)ctx->feedback[0] << 24) |
+                    ((unicode_t)ctx->feedback[1] << 16) |
+                    ((unicode_t)ctx->feedback[2] << 8) |
+                    ctx->feedback[3];
+}
+
+/**
+ * @brief 키에서 유도한 로터 시작 위치 (init_rotors와 동일)
+ */
+static void key_rotor_positions(const ProblemaContext *ctx, int *positions)
+{
+    for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+    {
+        positions[r] = ctx->key[r % PROBLEMA_KEY_SIZE] % PROBLEMA_ROTOR_SIZE;
+    }
+}
+
+/**
+ * @brief 로터를 steps 번 회전시킨 위치로 바로 이동
+ *
+ * rotate_rotors에서 로터 r+1은 로터 r이 회전한 직후 노치에 놓일 때만 회전한다.
+ * 따라서 로터 r+1의 회전 수는 로터 r이 steps 번 회전하는 동안 노치에 도달한 횟수이며,
+ * 노치마다 나눗셈 한 번으로 셀 수 있다. 비용은 O(로터 수 x 노치 수)이다.
+ */
+static void seek_rotors(const ProblemaContext *ctx, int *positions, uint64_t steps)
+{
+    for (int r = 0; r < PROBLEMA_NUM_ROTORS && steps > 0; r++)
+    {
+        uint64_t next_steps = 0;
+
+        if (r < PROBLEMA_NUM_ROTORS - 1)
+        {
+            const ProblemaRotor *rotor = &ctx->rotors[r];
+            for (int n = 0; n < rotor->num_notches; n++)
+            {
+                /* 같은 노치가 중복으로 들어 있으면 한 번만 센다 */
+                bool duplicate = false;
+                for (int m = 0; m < n; m++)
+                {
+                    if (rotor->notch_positions[m] == rotor->notch_positions[n])
+                    {
+                        duplicate = true;
+                        break;
+                    }
+                }
+                if (duplicate)
+                {
+                    continue;
+                }
+
+                /* 처음 노치에 도달하는 회전 수 (1 ~ PROBLEMA_ROTOR_SIZE) */
+                uint64_t first = (uint64_t)((rotor->notch_positions[n] - positions[r] - 1 +
+                                             2 * PROBLEMA_ROTOR_SIZE) %
+                                            PROBLEMA_ROTOR_SIZE) + 1;
+                if (steps >= first)
+                {
+                    next_steps += (steps - first) / PROBLEMA_ROTOR_SIZE + 1;
+                }
+            }
+        }
+
+        positions[r] = (int)((positions[r] + steps % PROBLEMA_ROTOR_SIZE) % PROBLEMA_ROTOR_SIZE);
+        steps = next_steps;
+    }
+}
+
+/**
+ * @brief 컨텍스트 커서로 메시지 처리 (힙 할당 없음)
+ *
+ * 입력이 유효하지 않은 UTF-8이면 로터 위치를 바꾸지 않는다. 출력 쪽 오류는
+ * 모든 문자를 처리한 뒤 보고하므로 로터 위치는 성공했을 때와 같아진다.
+ */
+static int cipher_context(ProblemaContext *ctx, bool encrypt, const byte_t *input, size_t input_len,
+                          byte_t *output, size_t output_size, size_t *output_len)
+{
+    PROBE_CIPHER_ENTRY(encrypt, ctx, input_len);
+    uint64_t span_start = TIMELINE_ON(ctx) ? problema_timeline_clock() : 0;
+
+    if (TRACE_ON(ctx))
+    {
+        /* 추적 순서를 유지하기 위해 문자 수를 먼저 센다 */
+        size_t i = 0, chars = 0;
+        unicode_t code;
+        while (i < input_len)
+        {
+            size_t len = decode_utf8_char(input + i, input_len - i, &code);
+            if (len == 0)
+            {
+                trace_char(ctx, PROBLEMA_TRACE_INVALID_UTF8, "유효하지 않은 UTF-8 시퀀스 시작 바이트",
+                           input[i], NULL);
+                PROBE2(invalid_utf8, i, input[i]);
+                PROBE_CIPHER_RETURN(encrypt, ctx, 0, output_size, PROBLEMA_ERROR_INVALID_UTF8);
+                return PROBLEMA_ERROR_INVALID_UTF8;
+            }
+            i += len;
+            chars++;
+        }
+
+        ProblemaTraceEvent event = {PROBLEMA_TRACE_UTF8_DECODED, "UTF-8 → 유니코드 변환", 0, NULL, NULL,
+                                    input_len, chars};
+        ctx->trace(&event, ctx->trace_user);
+    }
+
+    CharCursor cur;
+    load_cursor(ctx, &cur);
+
+    size_t consumed = 0;
+    uint64_t chars = 0;
+    int result = cipher_utf8(ctx, &cur, encrypt, input, input_len, UINT64_MAX,
+                             output, output_size, output_len, &consumed, &chars);
+    if (result != PROBLEMA_ERROR_INVALID_UTF8 || consumed == input_len)
+    {
+        store_cursor(ctx, &cur);
+    }
+
+    if (TIMELINE_ON(ctx))
+    {
+        problema_timeline_span(ctx->timeline, "cipher", encrypt ? "encrypt" : "decrypt", span_start,
+                               "bytes", input_len);
+    }
+    PROBE_CIPHER_RETURN(encrypt, ctx, *output_len, output_size, result);
+    return result;
+}
+
+/**
+ * @brief 공개 커서로 문자열 처리 (cipher_context와 같은 규칙, 상태는 cursor->state)
+ */
+static int cipher_cursor(ProblemaCursor *cursor, bool encrypt, const byte_t *input, size_t input_len,
+                         byte_t *output, size_t output_size, size_t *output_len)
+{
+    if (cursor == NULL || cursor->schedule == NULL || input == NULL || output == NULL ||
+        output_len == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!cursor->schedule->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    /* problema_encrypt / problema_decrypt와 같이 0 피드백에서 시작 */
+    ProblemaState *state = &cursor->state;
+    state->encrypt_mode = encrypt;
+    memset(state->feedback, 0, PROBLEMA_BLOCK_SIZE);
+    memset(state->initial_feedback, 0, PROBLEMA_BLOCK_SIZE);
+
+    CharCursor cur;
+    memcpy(cur.positions, state->positions, sizeof(cur.positions));
+    cur.feedback = 0;
+    PROBE_CIPHER_ENTRY(encrypt, cursor->schedule, input_len);
+    uint64_t span_start = TIMELINE_ON(cursor->schedule) ? problema_timeline_clock() : 0;
+
+    size_t consumed = 0;
+    uint64_t chars = 0;
+    int result = cipher_utf8(cursor->schedule, &cur, encrypt, input, input_len, UINT64_MAX,
+                             output, output_size, output_len, &consumed, &chars);
+    if (result != PROBLEMA_ERROR_INVALID_UTF8 || consumed == input_len)
+    {
+        memcpy(state->positions, cur.positions, sizeof(cur.positions));
+        state->feedback[0] = (cur.feedback >> 24) & 0xFF;
+        state->feedback[1] = (cur.feedback >> 16) & 0xFF;
+        state->feedback[2] = (cur.feedback >> 8) & 0xFF;
+        state->feedback[3] = cur.feedback & 0xFF;
+    }
+
+    if (TIMELINE_ON(cursor->schedule))
+    {
+        problema_timeline_span(cursor->schedule->timeline, "cursor", encrypt ? "encrypt" : "decrypt",
+                               span_start, "bytes", input_len);
+    }
+    PROBE_CIPHER_RETURN(encrypt, cursor->schedule, *output_len, output_size, result);
+    return result;
+}
+
+/**
+ * @brief 컨텍스트 커서 사본으로 출력 길이만 세기
+ */
+static int measure_context(const ProblemaContext *ctx, bool encrypt, const byte_t *input,
+                           size_t input_len, size_t *required)
+{
+    if (ctx == NULL || input == NULL || required == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    /* problema_encrypt / problema_decrypt와 같이 0 피드백에서 시작 */
+    CharCursor cur;
+    load_cursor(ctx, &cur);
+    cur.feedback = 0;
+
+    /* 출력 버퍼가 없으면 cipher_utf8은 쓰지 않고 길이만 센다 */
+    size_t consumed = 0;
+    uint64_t chars = 0;
+    int result = cipher_utf8(ctx, &cur, encrypt, input, input_len, UINT64_MAX,
+                             NULL, 0, required, &consumed, &chars);
+    return result == PROBLEMA_ERROR_BUFFER_TOO_SMALL ? PROBLEMA_SUCCESS : result;
+}
+
+/**
+ * @brief 키와 논스에서 메시지 시작 커서 유도
+ *
+ * 키 지문에 논스를 섞은 64비트 값을 splitmix64로 펼쳐 로터마다 오프셋을 더하고,
+ * 초기 피드백 워드를 만든다. 피드백 워드를 BMP 범위로 제한해야 BMP 문자의
+ * 암호문이 유효한 코드 포인트로 남는다.
+ */
+static void nonce_cursor(const ProblemaContext *ctx, const byte_t *nonce, CharCursor *cur)
+{
+    uint64_t h = problema_key_fingerprint(ctx);
+    for (int i = 0; i < PROBLEMA_NONCE_SIZE; i++)
+    {
+        h ^= nonce[i];
+        h *= 0x100000001B3ULL;
+    }
+
+    key_rotor_positions(ctx, cur->positions);
+    for (int r = 0; r <= PROBLEMA_NUM_ROTORS; r++)
+    {
+        h += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = h;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        z ^= z >> 31;
+
+        if (r < PROBLEMA_NUM_ROTORS)
+        {
+            cur->positions[r] = (int)((cur->positions[r] + (z >> 32)) % PROBLEMA_ROTOR_SIZE);
+        }
+        else
+        {
+            cur->feedback = (unicode_t)(z & 0xFFFF);
+        }
+    }
+}
+
+/**
+ * @brief 논스 기반 메시지 처리 (컨텍스트 상태는 건드리지 않음)
+ */
+static int cipher_nonce(const ProblemaContext *ctx, const byte_t *nonce, bool encrypt,
+                        const byte_t *input, size_t input_len,
+                        byte_t *output, size_t output_size, size_t *output_len)
+{
+    if (ctx == NULL || nonce == NULL || input == NULL || output == NULL || output_len == NULL)
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    CharCursor cur;
+    nonce_cursor(ctx, nonce, &cur);
+    PROBE_CIPHER_ENTRY(encrypt, ctx, input_len);
+    uint64_t span_start = TIMELINE_ON(ctx) ? problema_timeline_clock() : 0;
+
+    size_t consumed = 0;
+    uint64_t chars = 0;
+    int result = cipher_utf8(ctx, &cur, encrypt, input, input_len, UINT64_MAX,
+                             output, output_size, output_len, &consumed, &chars);
+    if (TIMELINE_ON(ctx))
+    {
+        problema_timeline_span(ctx->timeline, "nonce", encrypt ? "encrypt" : "decrypt", span_start,
+                               "bytes", input_len);
+    }
+    PROBE_CIPHER_RETURN(encrypt, ctx, *output_len, output_size, result);
+    return result;
+}
+
+/**
+ * @brief 배치 실행 (구간 분배 후 호출 스레드도 작업에 참여)
+ */
+static int run_batch(const ProblemaContext *ctx, ProblemaThreadPool *pool, bool encrypt,
+                     ProblemaBatchItem *items, size_t count)
+{
+    if (ctx == NULL || (items == NULL && count > 0))
+    {
+        return PROBLEMA_ERROR_NULL_POINTER;
+    }
+
+    if (!ctx->initialized)
+    {
+        return PROBLEMA_ERROR_NOT_INITIALIZED;
+    }
+
+    uint64_t batch_start = TIMELINE_ON(ctx) ? problema_timeline_clock() : 0;
+    int num_workers = pool != NULL ? pool->num_threads : 1;
+    WorkerRange *ranges = (WorkerRange *)aligned_alloc(64, num_workers * sizeof(WorkerRange));
+    if (ranges == NULL)
+    {
+        return PROBLEMA_ERROR_OUT_OF_MEMORY;
+    }
+
+    /* 다른 스레드가 같은 풀에 제출한 배치는 앞 배치가 끝날 때까지 기다린다 */
+    if (num_workers > 1)
+    {
+        pthread_mutex_lock(&pool->submit);
+    }
+
+    /* 구간은 32비트 인덱스로 표현하므로 아주 큰 배치는 나누어 실행한다 */
+    for (size_t base = 0; base < count; base += UINT32_MAX)
+    {
+        uint32_t slice = (uint32_t)(count - base < UINT32_MAX ? count - base : UINT32_MAX);
+        BatchJob job = {ctx, items + base, encrypt, num_workers, ranges, {0}};
+
+        for (int w = 0; w < num_workers; w++)
+        {
+            uint64_t lo = (uint64_t)slice * w / num_workers;
+            uint64_t hi = (uint64_t)slice * (w + 1) / num_workers;
+            atomic_init(&ranges[w].range, lo | (hi << 32));
+        }
+
+        if (num_workers > 1)
+        {
+            pthread_mutex_lock(&pool->lock);
+            pool->job = &job;
+            pool->pending = num_workers - 1;
+            pool->generation++;
+            pthread_cond_broadcast(&pool->wake);
+            pthread_mutex_unlock(&pool->lock);
+        }
+
+        run_batch_worker(&job, 0);
+
+        if (num_workers > 1)
+        {
+            /* 호출 스레드가 먼저 끝나 기다리는 시간이 곧 작업자 간 불균형 */
+            uint64_t wait_start = TIMELINE_ON(ctx) ? problema_timeline_clock() : 0;
+            pthread_mutex_lock(&pool->lock);
+            while (pool->pending > 0)
+            {
+                pthread_cond_wait(&pool->done, &pool->lock);
+            }
+            pool->job = NULL;
+            pthread_mutex_unlock(&pool->lock);
+            if (STATS_ON(ctx))
+            {
+                stats_merge(&thread_stats, &job.stats);
+            }
+            if (TIMELINE_ON(ctx))
+            {
+                problema_timeline_span(ctx->timeline, "batch", "wait_workers", wait_start, NULL, 0);
+            }
+        }
+    }
+
+    if (num_workers > 1)
+    {
+        pthread_mutex_unlock(&pool->submit);
+    }
+
+    free(ranges);
+    if (TIMELINE_ON(ctx))
+    {
+        problema_timeline_span(ctx->timeline, "batch", encrypt ? "encrypt_batch" : "decrypt_batch",
+                               batch_start, "items", count);
+    }
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 작업자 루프: 자기 구간을 앞에서부터 처리하고, 비면 다른 구간의 뒤쪽 절반을 훔친다
+ */
+static void run_batch_worker(BatchJob *job, int id)
+{
+    WorkerRange *own = &job->ranges[id];
+    ProblemaTimeline *timeline = TIMELINE_ON(job->ctx) ? job->ctx->timeline : NULL;
+    uint64_t worker_start = 0;
+    if (timeline != NULL)
+    {
+        worker_start = problema_timeline_clock();
+        if (id > 0)
+        {
+            char name[TIMELINE_NAME_SIZE];
+            snprintf(name, sizeof(name), "batch worker %d", id);
+            problema_timeline_thread_name(timeline, name);
+        }
+    }
+
+    for (;;)
+    {
+        uint32_t item;
+        if (!take_batch_item(own, &item))
+        {
+            /* 훔치기: 남은 항목이 가장 많은 구간을 고른다 */
+            int victim = -1;
+            uint64_t victim_left = 0;
+            for (int w = 0; w < job->num_workers; w++)
+            {
+                uint64_t range = atomic_load(&job->ranges[w].range);
+                uint64_t left = (range >> 32) - (range & 0xFFFFFFFFULL);
+                if (w != id && (range >> 32) > (range & 0xFFFFFFFFULL) && left > victim_left)
+                {
+                    victim = w;
+                    victim_left = left;
+                }
+            }
+            if (victim < 0)
+            {
+                problema_timeline_span(timeline, "batch", "worker", worker_start, "id", (uint64_t)id);
+                return;
+            }
+
+            uint64_t range = atomic_load(&job->ranges[victim].range);
+            uint64_t lo = range & 0xFFFFFFFFULL, hi = range >> 32;
+            if (hi <= lo)
+            {
+                continue;
+            }
+            uint64_t mid = hi - (hi - lo + 1) / 2;
+            if (!atomic_compare_exchange_weak(&job->ranges[victim].range, &range, lo | (mid << 32)))
+            {
+                continue;
+            }
+
+            /* 자기 구간은 비어 있으므로 다른 작업자가 건드리지 않는다 */
+            atomic_store(&own->range, mid | (hi << 32));
+            if (timeline != NULL)
+            {
+                problema_timeline_span(timeline, "batch", "steal", problema_timeline_clock(),
+                                       "items", hi - mid);
+            }
+            continue;
+        }
+
+        ProblemaBatchItem *it = &job->items[item];
+        if (it->input == NULL || it->output == NULL)
+        {
+            it->status = PROBLEMA_ERROR_NULL_POINTER;
+            continue;
+        }
+
+        CharCursor cur;
+        if (it->nonce != NULL)
+        {
+            nonce_cursor(job->ctx, it->nonce, &cur);
+        }
+        else
+        {
+            key_rotor_positions(job->ctx, cur.positions);
+            cur.feedback = 0;
+        }
+
+        size_t consumed = 0;
+        uint64_t chars = 0;
+        it->output_len = 0;
+        PROBE3(batch_item, id, item, it->input_len);
+        uint64_t span_start = timeline != NULL ? problema_timeline_clock() : 0;
+        it->status = cipher_utf8(job->ctx, &cur, job->encrypt, it->input, it->input_len, UINT64_MAX,
+                                 it->output, it->output_size, &it->output_len, &consumed, &chars);
+        if (timeline != NULL)
+        {
+            problema_timeline_span(timeline, "batch", job->encrypt ? "encrypt_item" : "decrypt_item",
+                                   span_start, "item", item);
+        }
+    }
+}
+
+/**
+ * @brief 구간 앞쪽에서 항목 하나 가져오기
+ */
+static bool take_batch_item(WorkerRange *range, uint32_t *item)
+{
+    uint64_t cur = atomic_load(&range->range);
+    for (;;)
+    {
+        uint64_t lo = cur & 0xFFFFFFFFULL, hi = cur >> 32;
+        if (lo >= hi)
+        {
+            return false;
+        }
+        if (atomic_compare_exchange_weak(&range->range, &cur, (lo + 1) | (hi << 32)))
+        {
+            *item = (uint32_t)lo;
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief 보조 스레드 본체: 새 작업 세대를 기다렸다가 작업자로 참여
+ */
+static void *thread_pool_main(void *arg)
+{
+    ProblemaThreadPool *pool = (ProblemaThreadPool *)arg;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    int id = ++pool->next_id;
+    pthread_mutex_unlock(&pool->lock);
+
+    for (;;)
+    {
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->shutdown && pool->generation == seen)
+        {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->shutdown)
+        {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        seen = pool->generation;
+        BatchJob *job = pool->job;
+        pthread_mutex_unlock(&pool->lock);
+
+        /* 보조 스레드의 카운터는 아무도 조회할 수 없으므로 배치마다 비우고 작업에 넘긴다 */
+        if (STATS_ON(job->ctx))
+        {
+            memset(&thread_stats, 0, sizeof(ProblemaStats));
+        }
+        run_batch_worker(job, id);
+
+        pthread_mutex_lock(&pool->lock);
+        if (STATS_ON(job->ctx))
+        {
+            stats_merge(&job->stats, &thread_stats);
+        }
+        if (--pool->pending == 0)
+        {
+            pthread_cond_signal(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+/**
+ * @brief offset에서 count 개 UTF-8 문자를 건너뛴 위치 (리드 바이트만 확인)
+ */
+static size_t skip_utf8_chars(const byte_t *data, size_t data_len, size_t offset, uint64_t count)
+{
+    while (count > 0 && offset < data_len)
+    {
+        byte_t lead = data[offset];
+        if ((lead & 0x80) == 0)
+        {
+            offset += 1;
+        }
+        else if ((lead & 0xE0) == 0xC0)
+        {
+            offset += 2;
+        }
+        else if ((lead & 0xF0) == 0xE0)
+        {
+            offset += 3;
+        }
+        else
+        {
+            offset += 4;
+        }
+        count--;
+    }
+
+    return count > 0 ? data_len + 1 : offset;
+}
+
+/**
+ * @brief offset 바로 앞에서 끝나는 UTF-8 문자 (복호화 피드백 워드)
+ */
+static unicode_t previous_utf8_char(const byte_t *data, size_t offset)
+{
+    size_t start = offset - 1;
+    while (start > 0 && offset - start < 4 && (data[start] & 0xC0) == 0x80)
+    {
+        start--;
+    }
+
+    unicode_t code = 0;
+    if (decode_utf8_char(data + start, offset - start, &code) == 0)
+    {
+        return 0;
+    }
+    return code;
+}
+
+/**
+ * @brief 문자 인덱스의 바이트 위치 찾기 (가장 가까운 체크포인트부터 훑기)
+ */
+static int locate_char(const byte_t *data, size_t data_len, const ProblemaSeekIndex *index,
+                       uint64_t char_index, size_t *byte_offset)
+{
+    uint64_t base_char = 0;
+    size_t base_offset = 0;
+
+    if (index != NULL && index->num_entries > 0 && index->interval > 0)
+    {
+        if (index->total_bytes != data_len)
+        {
+            return PROBLEMA_ERROR_INVALID_FORMAT;
+        }
+        if (char_index > index->total_chars)
+        {
+            return PROBLEMA_ERROR_OUT_OF_RANGE;
+        }
+
+        size_t k = (size_t)(char_index / index->interval);
+        if (k >= index->num_entries)
+        {
+            k = index->num_entries - 1;
+        }
+        base_char = index->entries[k].char_index;
+        base_offset = index->entries[k].byte_offset;
+        if (base_char > char_index || base_offset > data_len)
+        {
+            return PROBLEMA_ERROR_INVALID_FORMAT;
+        }
+    }
+
+    size_t offset = skip_utf8_chars(data, data_len, base_offset, char_index - base_char);
+    if (offset > data_len)
+    {
+        return PROBLEMA_ERROR_OUT_OF_RANGE;
+    }
+
+    *byte_offset = offset;
+    return PROBLEMA_SUCCESS;
+}
+
+/**
+ * @brief 커서 상태를 컨텍스트에 반영
+ */
+static void store_cursor(ProblemaContext *ctx, const CharCursor *cur)
+{
+    for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+    {
+        ctx->rotors[r].position = cur->positions[r];
+        ctx->inverse_rotors[r].position = cur->positions[r];
+    }
+
+    ctx->feedback[0] = (cur->feedback >> 24) & 0xFF;
+    ctx->feedback[1] = (cur->feedback >> 16) & 0xFF;
+    ctx->feedback[2] = (cur->feedback >> 8) & 0xFF;
+    ctx->feedback[3] = cur->feedback & 0xFF;
+}
+
+/**
+ * @brief 커서 기준 문자 암호화
+ *
+ * 피드백 적용은 문자의 빅엔디언 4바이트를 피드백 앞 4바이트와 XOR하는 것과 같으므로
+ * 32비트 워드 하나로 처리한다.
+ */
+static unicode_t encrypt_char_core(const ProblemaContext *ctx, CharCursor *cur, unicode_t input)
+{
+    if (TRACE_ON(ctx))
+    {
+        trace_char(ctx, PROBLEMA_TRACE_CHAR_IN, "암호화 전 문자", input, cur->positions);
+    }
+
+    /* 1. 플러그보드 적용 */
+    unicode_t output = apply_plugboard(ctx, input);
+    if (STATS_ON(ctx))
+    {
+        thread_stats.plugboard_hits += output != input;
+        thread_stats.rotor_bypass += output >= PROBLEMA_ROTOR_SIZE;
+        stats_lap(PROBLEMA_STAT_PLUGBOARD);
+    }
+    if (TRACE_ON(ctx))
+    {
+        trace_char(ctx, PROBLEMA_TRACE_PLUGBOARD, "플러그보드 적용 후", output, cur->positions);
+    }
+
+    /* 2. 순방향 로터 적용 */
+    output = apply_rotors_forward(ctx, cur->positions, output);
+    if (TRACE_ON(ctx))
+    {
+        trace_char(ctx, PROBLEMA_TRACE_ROTORS_FORWARD, "순방향 로터 적용 후", output, cur->positions);
+    }
+
+    /* 3. 로터 회전 */
+    rotate_rotors(ctx, cur->positions);
+
+    /* 4. 역방향 로터 적용 */
+    output = apply_rotors_backward(ctx, cur->positions, output);
+    if (STATS_ON(ctx))
+    {
+        stats_lap(PROBLEMA_STAT_ROTORS);
+    }
+    if (TRACE_ON(ctx))
+    {
+        trace_char(ctx, PROBLEMA_TRACE_ROTORS_BACKWARD, "역방향 로터 적용 후", output, cur->positions);
+    }
+
+    /* 5. 피드백 적용 및 갱신 */
+    output ^= cur->feedback;
+    cur->feedback = output;
+    if (STATS_ON(ctx))
+    {
+        stats_lap(PROBLEMA_STAT_FEEDBACK);
+    }
+
+    if (TRACE_ON(ctx))
+    {
+        trace_char(ctx, PROBLEMA_TRACE_CHAR_OUT, "암호화 후 문자", output, cur->positions);
+    }
+
+    return output;
+}
+
+/**
+ * @brief 커서 기준 문자 복호화
+ */
+static unicode_t decrypt_char_core(const ProblemaContext *ctx, CharCursor *cur, unicode_t input)
+{
+    if (TRACE_ON(ctx))
+    {
+        trace_char(ctx, PROBLEMA_TRACE_CHAR_IN, "복호화 전 문자", input, cur->positions);
+    }
+
+    /* 1. 피드백 적용 후 현재 입력으로 피드백 갱신 */
+    unicode_t output = input ^ cur->feedback;
+    cur->feedback = input;
+    if (STATS_ON(ctx))
+    {
+        thread_stats.rotor_bypass += output >= PROBLEMA_ROTOR_SIZE;
+        stats_lap(PROBLEMA_STAT_FEEDBACK);
+    }
+
+    /* 2. 역방향 로터 적용 (암호화의 순방향 로터에 해당) */
+    output = apply_rotors_backward(ctx, cur->positions, output);
+    if (TRACE_ON(ctx))
+    {
+        trace_char(ctx, PROBLEMA_TRACE_ROTORS_BACKWARD, "역방향 로터 적용 후", output, cur->positions);
+    }
+
+    /* 3. 로터 회전 */
+    rotate_rotors(ctx, cur->positions);
+
+    /* 4. 순방향 로터 적용 (암호화의 역방향 로터에 해당) */
+    output = apply_rotors_forward(ctx, cur->positions, output);
+    if (STATS_ON(ctx))
+    {
+        stats_lap(PROBLEMA_STAT_ROTORS);
+    }
+    if (TRACE_ON(ctx))
+    {
+        trace_char(ctx, PROBLEMA_TRACE_ROTORS_FORWARD, "순방향 로터 적용 후", output, cur->positions);
+    }
+
+    /* 5. 플러그보드 적용 */
+    unicode_t mapped = output;
+    output = apply_plugboard(ctx, output);
+    if (STATS_ON(ctx))
+    {
+        thread_stats.plugboard_hits += output != mapped;
+        stats_lap(PROBLEMA_STAT_PLUGBOARD);
+    }
+    if (TRACE_ON(ctx))
+    {
+        trace_char(ctx, PROBLEMA_TRACE_PLUGBOARD, "플러그보드 적용 후", output, cur->positions);
+        trace_char(ctx, PROBLEMA_TRACE_CHAR_OUT, "복호화 후 문자", output, cur->positions);
+    }
+
+    return output;
+}
+
+/**
+ * @brief UTF-8 문자 하나 디코딩
+ *
+ * @return size_t 소비한 바이트 수, 유효하지 않은 시퀀스면 0
+ */
+static size_t decode_utf8_char(const byte_t *utf8, size_t avail, unicode_t *code)
+{
+    byte_t lead = utf8[0];
+
+    if ((lead & 0x80) == 0)
+    {
+        *code = lead;
+        return 1;
+    }
+    else if ((lead & 0xE0) == 0xC0)
+    {
+        if (avail < 2 || (utf8[1] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+        *code = ((lead & 0x1F) << 6) | (utf8[1] & 0x3F);
+        return 2;
+    }
+    else if ((lead & 0xF0) == 0xE0)
+    {
+        if (avail < 3 || (utf8[1] & 0xC0) != 0x80 || (utf8[2] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+        *code = ((lead & 0x0F) << 12) | ((utf8[1] & 0x3F) << 6) | (utf8[2] & 0x3F);
+        return 3;
+    }
+    else if ((lead & 0xF8) == 0xF0)
+    {
+        if (avail < 4 || (utf8[1] & 0xC0) != 0x80 ||
+            (utf8[2] & 0xC0) != 0x80 || (utf8[3] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+        *code = ((lead & 0x07) << 18) | ((utf8[1] & 0x3F) << 12) |
+                ((utf8[2] & 0x3F) << 6) | (utf8[3] & 0x3F);
+        return 4;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief 입력 끝에서 잘린 UTF-8 문자인지 확인
+ *
+ * 시작 바이트가 요구하는 길이보다 남은 바이트가 적고, 남은 바이트가 모두
+ * 연속 바이트이면 뒤에 이어질 입력으로 완성될 수 있는 문자이다.
+ */
+static bool utf8_truncated(const byte_t *utf8, size_t avail)
+{
+    if (avail == 0)
+    {
+        return false;
+    }
+
+    size_t need;
+    if ((utf8[0] & 0xE0) == 0xC0)
+    {
+        need = 2;
+    }
+    else if ((utf8[0] & 0xF0) == 0xE0)
+    {
+        need = 3;
+    }
+    else if ((utf8[0] & 0xF8) == 0xF0)
+    {
+        need = 4;
+    }
+    else
+    {
+        return false;
+    }
+
+    if (avail >= need)
+    {
+        return false;
+    }
+
+    for (size_t i = 1; i < avail; i++)
+    {
+        if ((utf8[i] & 0xC0) != 0x80)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief 코드 포인트의 UTF-8 인코딩 길이
+ *
+ * @return size_t 바이트 수, 유효하지 않은 코드 포인트면 0
+ */
+static size_t utf8_char_length(unicode_t code)
+{
+    if (code <= 0x7F)
+    {
+        return 1;
+    }
+    else if (code <= 0x7FF)
+    {
+        return 2;
+    }
+    else if (code <= 0xFFFF)
+    {
+        return 3;
+    }
+    else if (code <= 0x10FFFF)
+    {
+        return 4;
+    }
+    return 0;
+}
+
+/**
+ * @brief 코드 포인트 하나를 UTF-8로 인코딩 (길이는 utf8_char_length 결과)
+ */
+static void encode_utf8_char(unicode_t code, size_t len, byte_t *utf8)
+{
+    switch (len)
+    {
+    case 1:
+        utf8[0] = (byte_t)code;
+        break;
+    case 2:
+        utf8[0] = (byte_t)(0xC0 | (code >> 6));
+        utf8[1] = (byte_t)(0x80 | (code & 0x3F));
+        break;
+    case 3:
+        utf8[0] = (byte_t)(0xE0 | (code >> 12));
+        utf8[1] = (byte_t)(0x80 | ((code >> 6) & 0x3F));
+        utf8[2] = (byte_t)(0x80 | (code & 0x3F));
+        break;
+    default:
+        utf8[0] = (byte_t)(0xF0 | (code >> 18));
+        utf8[1] = (byte_t)(0x80 | ((code >> 12) & 0x3F));
+        utf8[2] = (byte_t)(0x80 | ((code >> 6) & 0x3F));
+        utf8[3] = (byte_t)(0x80 | (code & 0x3F));
+        break;
+    }
+}
+
+/**
+ * @brief UTF-8 입력을 커서 기준으로 문자 단위 암호화/복호화
+ *
+ * 디코딩, 암호화, 인코딩을 문자마다 한 번에 처리하므로 중간 버퍼가 필요 없다.
+ * max_chars 개 문자까지 처리한다. 유효하지 않은 입력을 만나면 즉시 실패하고,
+ * 출력 쪽 오류(버퍼 부족, 범위를 벗어난 코드 포인트)는 첫 오류를 기억한 채
+ * 나머지 문자를 끝까지 처리하여 커서 상태와 필요한 출력 길이를 맞춘다.
+ */
+static int cipher_utf8(const ProblemaContext *ctx, CharCursor *cur, bool encrypt,
+                       const byte_t *input, size_t input_len, uint64_t max_chars,
+                       byte_t *output, size_t output_size, size_t *output_len,
+                       size_t *consumed, uint64_t *num_chars)
+{
+    int result = PROBLEMA_SUCCESS;
     size_t i = 0, j = 0;
+    uint64_t n = 0;
 
-    while (i < utf8_len && j < unicode_size)
+    while (i < input_len && n < max_chars)
     {
-        if ((utf8[i] & 0x80) == 0)
+        /* 시각 읽기는 문자 처리보다 비쌀 수 있으므로 일부 문자만 재서 구간 시간을 추정 */
+        if (STATS_ON(ctx))
         {
-            /* ASCII 문자 (1바이트) */
-            unicode[j++] = utf8[i++];
+            thread_stats_weight = (thread_stats.chars + n) % STATS_TIMING_INTERVAL == 0
+                                      ? STATS_TIMING_INTERVAL
+                                      : 0;
+            if (thread_stats_weight != 0)
+            {
+                thread_stats_mark = stats_clock();
+            }
         }
-        else if ((utf8[i] & 0xE0) == 0xC0)
+
+        unicode_t code;
+        size_t in_len = decode_utf8_char(input + i, input_len - i, &code);
+        if (STATS_ON(ctx) && in_len > 0)
         {
-            /* 2바이트 UTF-8 시퀀스 */
-            if (i + 1 >= utf8_len || (utf8[i + 1] & 0xC0) != 0x80)
+            thread_stats.utf8_decoded[in_len - 1]++;
+            stats_lap(PROBLEMA_STAT_DECODE);
+        }
+        if (in_len == 0)
+        {
+            if (TRACE_ON(ctx))
             {
-                if (debug_mode)
-                {
-                    printf("[DEBUG] 유효하지 않은 2바이트 UTF-8 시퀀스: %02X %02X\n",
-                           utf8[i], (i + 1 < utf8_len) ? utf8[i + 1] : 0);
-                }
-                return PROBLEMA_ERROR_INVALID_UTF8;
+                trace_char(ctx, PROBLEMA_TRACE_INVALID_UTF8, "유효하지 않은 UTF-8 시퀀스 시작 바이트",
+                           input[i], NULL);
             }
-            unicode[j++] = ((utf8[i] & 0x1F) << 6) | (utf8[i + 1] & 0x3F);
-            i += 2;
+            PROBE2(invalid_utf8, i, input[i]);
+            if (STATS_ON(ctx))
+            {
+                thread_stats.chars += n;
+            }
+            *output_len = j;
+            *consumed = i;
+            *num_chars = n;
+            return PROBLEMA_ERROR_INVALID_UTF8;
+        }
+        i += in_len;
+        n++;
+
+        code = encrypt ? encrypt_char_core(ctx, cur, code) : decrypt_char_core(ctx, cur, code);
+
+        size_t out_len = utf8_char_length(code);
+        if (out_len == 0)
+        {
+            PROBE2(invalid_utf8, i - in_len, code);
+            if (result == PROBLEMA_SUCCESS)
+            {
+                result = PROBLEMA_ERROR_INVALID_UTF8;
+            }
+            continue;
+        }
+        if (result == PROBLEMA_SUCCESS && j + out_len > output_size)
+        {
+            result = PROBLEMA_ERROR_BUFFER_TOO_SMALL;
+        }
+        if (result == PROBLEMA_SUCCESS)
+        {
+            encode_utf8_char(code, out_len, output + j);
+            if (STATS_ON(ctx))
+            {
+                thread_stats.utf8_encoded[out_len - 1]++;
+            }
+        }
+        j += out_len;
+        if (STATS_ON(ctx))
+        {
+            stats_lap(PROBLEMA_STAT_ENCODE);
+        }
+    }
+
+    if (STATS_ON(ctx))
+    {
+        thread_stats.chars += n;
+    }
+    *output_len = j;
+    *consumed = i;
+    *num_chars = n;
+    return result;
+}
+
+/**
+ * @brief AES 변환 적용 (간소화된 버전)
+ */
+static void apply_aes_transformation(const ProblemaContext *ctx, byte_t *block)
+{
+    byte_t temp[PROBLEMA_BLOCK_SIZE];
+
+    if (TRACE_ON(ctx))
+    {
+        trace_message(ctx, "AES 변환 적용 시작 (암호화 모드)");
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_STAGE, "변환 전 블록", block);
+    }
+
+    /* SubBytes */
+    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+    {
+        temp[i] = ctx->aes.sbox[block[i]];
+    }
+
+    if (TRACE_ON(ctx))
+    {
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_STAGE, "SubBytes 후", temp);
+    }
+
+    /* ShiftRows (간소화된 버전) */
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            block[i * 4 + j] = temp[i * 4 + (j + i) % 4];
+        }
+    }
+
+    if (TRACE_ON(ctx))
+    {
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_STAGE, "ShiftRows 후", block);
+    }
+
+    /* MixColumns (간소화된 버전) */
+    memcpy(temp, block, PROBLEMA_BLOCK_SIZE);
+    for (int i = 0; i < 4; i++)
+    {
+        byte_t a = temp[i * 4 + 0];
+        byte_t b = temp[i * 4 + 1];
+        byte_t c = temp[i * 4 + 2];
+        byte_t d = temp[i * 4 + 3];
+
+        block[i * 4 + 0] = (a ^ b) ^ 0;
+        block[i * 4 + 1] = (b ^ c) ^ 0;
+        block[i * 4 + 2] = (c ^ d) ^ 0;
+        block[i * 4 + 3] = (d ^ a) ^ 0;
+    }
+
+    if (TRACE_ON(ctx))
+    {
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_STAGE, "MixColumns 후", block);
+    }
+
+    /* AddRoundKey */
+    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+    {
+        block[i] ^= ctx->aes.round_keys[0][i];
+    }
+
+    if (TRACE_ON(ctx))
+    {
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_STAGE, "AddRoundKey 후", block);
+        trace_message(ctx, "AES 변환 적용 완료");
+    }
+}
+
+/**
+ * @brief 역 AES 변환 적용 (간소화된 버전)
+ */
+static void apply_inverse_aes_transformation(const ProblemaContext *ctx, byte_t *block)
+{
+    byte_t temp[PROBLEMA_BLOCK_SIZE];
+
+    if (TRACE_ON(ctx))
+    {
+        trace_message(ctx, "역 AES 변환 적용 시작 (복호화 모드)");
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_STAGE, "변환 전 블록", block);
+    }
+
+    /* AddRoundKey (역순) */
+    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+    {
+        block[i] ^= ctx->aes.round_keys[0][i];
+    }
+
+    if (TRACE_ON(ctx))
+    {
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_STAGE, "AddRoundKey 후", block);
+    }
+
+    /* InvMixColumns (간소화된 버전) */
+    memcpy(temp, block, PROBLEMA_BLOCK_SIZE);
+
+    for (int i = 0; i < 4; i++)
+    {
+        byte_t a = temp[i * 4 + 0];
+        byte_t b = temp[i * 4 + 1];
+        byte_t c = temp[i * 4 + 2];
+        byte_t d = temp[i * 4 + 3];
+
+        block[i * 4 + 0] = (d ^ a) ^ 0;
+        block[i * 4 + 1] = (a ^ b) ^ 0;
+        block[i * 4 + 2] = (b ^ c) ^ 0;
+        block[i * 4 + 3] = (c ^ d) ^ 0;
+    }
+
+    if (TRACE_ON(ctx))
+    {
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_STAGE, "InvMixColumns 후", block);
+    }
+
+    /* InvShiftRows (간소화된 버전) */
+    memcpy(temp, block, PROBLEMA_BLOCK_SIZE);
+
+    for (int i = 0; i < 4; i++)
+    {
+        for (int j = 0; j < 4; j++)
+        {
+            block[i * 4 + (j + i) % 4] = temp[i * 4 + j];
+        }
+    }
+
+    if (TRACE_ON(ctx))
+    {
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_STAGE, "InvShiftRows 후", block);
+    }
+
+    /* InvSubBytes */
+    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+    {
+        block[i] = ctx->aes.inv_sbox[block[i]];
+    }
+
+    if (TRACE_ON(ctx))
+    {
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_STAGE, "InvSubBytes 후", block);
+        trace_message(ctx, "역 AES 변환 적용 완료");
+    }
+}
+
+/**
+ * @brief GF(2^8) 곱셈 (AES 기약 다항식 x^8 + x^4 + x^3 + x + 1)
+ */
+static byte_t gf_mul(byte_t a, byte_t b)
+{
+    byte_t result = 0;
+    while (b != 0)
+    {
+        if (b & 1)
+        {
+            result ^= a;
         }
-        else if ((utf8[i] & 0xF0) == 0xE0)
+        a = (byte_t)((a << 1) ^ ((a & 0x80) ? 0x1B : 0));
+        b >>= 1;
+    }
+    return result;
+}
+
+/**
+ * @brief 전체 라운드 변환용 결합 테이블과 라운드 키 워드 생성
+ *
+ * 표준 AES 상태 배치(열 우선)에서 SubBytes, ShiftRows, MixColumns를 합친
+ * 32비트 테이블을 만든다. 복호화는 등가 역암호 구조를 쓰므로 중간 라운드 키에
+ * InvMixColumns를 미리 적용해 둔다.
+ */
+static void init_block_tables(ProblemaAES *aes)
+{
+    for (int x = 0; x < PROBLEMA_SBOX_SIZE; x++)
+    {
+        byte_t s = aes->sbox[x];
+        uint32_t e = ((uint32_t)gf_mul(s, 2) << 24) | ((uint32_t)s << 16) |
+                     ((uint32_t)s << 8) | gf_mul(s, 3);
+
+        byte_t si = aes->inv_sbox[x];
+        uint32_t d = ((uint32_t)gf_mul(si, 14) << 24) | ((uint32_t)gf_mul(si, 9) << 16) |
+                     ((uint32_t)gf_mul(si, 13) << 8) | gf_mul(si, 11);
+
+        for (int t = 0; t < 4; t++)
         {
-            /* 3바이트 UTF-8 시퀀스 (한글 포함) */
-            if (i + 2 >= utf8_len || (utf8[i + 1] & 0xC0) != 0x80 || (utf8[i + 2] & 0xC0) != 0x80)
-            {
-                if (debug_mode)
-                {
-                    printf("[DEBUG] 유효하지 않은 3바이트 UTF-8 시퀀스: %02X %02X %02X\n",
-                           utf8[i],
-                           (i + 1 < utf8_len) ? utf8[i + 1] : 0,
-                           (i + 2 < utf8_len) ? utf8[i + 2] : 0);
-                }
-                return PROBLEMA_ERROR_INVALID_UTF8;
-            }
-            unicode[j++] = ((utf8[i] & 0x0F) << 12) |
-                           ((utf8[i + 1] & 0x3F) << 6) |
-                           (utf8[i + 2] & 0x3F);
-            i += 3;
+            aes->enc_tables[t][x] = t == 0 ? e : (e >> (8 * t)) | (e << (32 - 8 * t));
+            aes->dec_tables[t][x] = t == 0 ? d : (d >> (8 * t)) | (d << (32 - 8 * t));
         }
-        else if ((utf8[i] & 0xF8) == 0xF0)
+    }
+
+    for (int round = 0; round <= PROBLEMA_NUM_ROUNDS; round++)
+    {
+        for (int c = 0; c < 4; c++)
         {
-            /* 4바이트 UTF-8 시퀀스 */
-            if (i + 3 >= utf8_len ||
-                (utf8[i + 1] & 0xC0) != 0x80 ||
-                (utf8[i + 2] & 0xC0) != 0x80 ||
-                (utf8[i + 3] & 0xC0) != 0x80)
-            {
-                if (debug_mode)
-                {
-                    printf("[DEBUG] 유효하지 않은 4바이트 UTF-8 시퀀스: %02X %02X %02X %02X\n",
-                           utf8[i],
-                           (i + 1 < utf8_len) ? utf8[i + 1] : 0,
-                           (i + 2 < utf8_len) ? utf8[i + 2] : 0,
-                           (i + 3 < utf8_len) ? utf8[i + 3] : 0);
-                }
-                return PROBLEMA_ERROR_INVALID_UTF8;
-            }
-            unicode[j++] = ((utf8[i] & 0x07) << 18) |
-                           ((utf8[i + 1] & 0x3F) << 12) |
-                           ((utf8[i + 2] & 0x3F) << 6) |
-                           (utf8[i + 3] & 0x3F);
-            i += 4;
+            aes->enc_keys[round][c] = LOAD_WORD(aes->round_keys[round] + 4 * c);
         }
-        else
+    }
+
+    /* dec_tables[t][sbox[b]]는 InvMixColumns 계수와 b의 곱이므로 키 변환에 그대로 쓸 수 있다 */
+    for (int round = 0; round <= PROBLEMA_NUM_ROUNDS; round++)
+    {
+        for (int c = 0; c < 4; c++)
         {
-            /* 유효하지 않은 UTF-8 시퀀스 */
-            if (debug_mode)
+            uint32_t w = aes->enc_keys[PROBLEMA_NUM_ROUNDS - round][c];
+            if (round > 0 && round < PROBLEMA_NUM_ROUNDS)
             {
-                printf("[DEBUG] 유효하지 않은 UTF-8 시퀀스 시작 바이트: %02X\n", utf8[i]);
+                w = aes->dec_tables[0][aes->sbox[w >> 24]] ^
+                    aes->dec_tables[1][aes->sbox[(w >> 16) & 0xFF]] ^
+                    aes->dec_tables[2][aes->sbox[(w >> 8) & 0xFF]] ^
+                    aes->dec_tables[3][aes->sbox[w & 0xFF]];
             }
-            return PROBLEMA_ERROR_INVALID_UTF8;
+            aes->dec_keys[round][c] = w;
+            STORE_WORD(aes->inv_round_keys[round] + 4 * c, w);
         }
     }
+}
 
-    *unicode_len = j;
+/**
+ * @brief 전체 라운드 블록 암호화 (T-테이블)
+ */
+static void encrypt_block_full(const ProblemaAES *aes, byte_t *block)
+{
+    const uint32_t(*te)[PROBLEMA_SBOX_SIZE] = aes->enc_tables;
+    uint32_t s0 = LOAD_WORD(block) ^ aes->enc_keys[0][0];
+    uint32_t s1 = LOAD_WORD(block + 4) ^ aes->enc_keys[0][1];
+    uint32_t s2 = LOAD_WORD(block + 8) ^ aes->enc_keys[0][2];
+    uint32_t s3 = LOAD_WORD(block + 12) ^ aes->enc_keys[0][3];
 
-    if (i < utf8_len && j >= unicode_size)
+    for (int round = 1; round < PROBLEMA_NUM_ROUNDS; round++)
     {
-        return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
+        const uint32_t *rk = aes->enc_keys[round];
+        uint32_t t0 = te[0][s0 >> 24] ^ te[1][(s1 >> 16) & 0xFF] ^ te[2][(s2 >> 8) & 0xFF] ^ te[3][s3 & 0xFF] ^ rk[0];
+        uint32_t t1 = te[0][s1 >> 24] ^ te[1][(s2 >> 16) & 0xFF] ^ te[2][(s3 >> 8) & 0xFF] ^ te[3][s0 & 0xFF] ^ rk[1];
+        uint32_t t2 = te[0][s2 >> 24] ^ te[1][(s3 >> 16) & 0xFF] ^ te[2][(s0 >> 8) & 0xFF] ^ te[3][s1 & 0xFF] ^ rk[2];
+        uint32_t t3 = te[0][s3 >> 24] ^ te[1][(s0 >> 16) & 0xFF] ^ te[2][(s1 >> 8) & 0xFF] ^ te[3][s2 & 0xFF] ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
     }
 
-    if (debug_mode)
+    /* 마지막 라운드는 MixColumns 없음 */
+    const byte_t *sbox = aes->sbox;
+    const uint32_t *rk = aes->enc_keys[PROBLEMA_NUM_ROUNDS];
+    uint32_t t0 = ((uint32_t)sbox[s0 >> 24] << 24) | ((uint32_t)sbox[(s1 >> 16) & 0xFF] << 16) |
+                  ((uint32_t)sbox[(s2 >> 8) & 0xFF] << 8) | sbox[s3 & 0xFF];
+    uint32_t t1 = ((uint32_t)sbox[s1 >> 24] << 24) | ((uint32_t)sbox[(s2 >> 16) & 0xFF] << 16) |
+                  ((uint32_t)sbox[(s3 >> 8) & 0xFF] << 8) | sbox[s0 & 0xFF];
+    uint32_t t2 = ((uint32_t)sbox[s2 >> 24] << 24) | ((uint32_t)sbox[(s3 >> 16) & 0xFF] << 16) |
+                  ((uint32_t)sbox[(s0 >> 8) & 0xFF] << 8) | sbox[s1 & 0xFF];
+    uint32_t t3 = ((uint32_t)sbox[s3 >> 24] << 24) | ((uint32_t)sbox[(s0 >> 16) & 0xFF] << 16) |
+                  ((uint32_t)sbox[(s1 >> 8) & 0xFF] << 8) | sbox[s2 & 0xFF];
+    t0 ^= rk[0];
+    t1 ^= rk[1];
+    t2 ^= rk[2];
+    t3 ^= rk[3];
+    STORE_WORD(block, t0);
+    STORE_WORD(block + 4, t1);
+    STORE_WORD(block + 8, t2);
+    STORE_WORD(block + 12, t3);
+}
+
+/**
+ * @brief 전체 라운드 블록 복호화 (등가 역암호 T-테이블)
+ */
+static void decrypt_block_full(const ProblemaAES *aes, byte_t *block)
+{
+    const uint32_t(*td)[PROBLEMA_SBOX_SIZE] = aes->dec_tables;
+    uint32_t s0 = LOAD_WORD(block) ^ aes->dec_keys[0][0];
+    uint32_t s1 = LOAD_WORD(block + 4) ^ aes->dec_keys[0][1];
+    uint32_t s2 = LOAD_WORD(block + 8) ^ aes->dec_keys[0][2];
+    uint32_t s3 = LOAD_WORD(block + 12) ^ aes->dec_keys[0][3];
+
+    for (int round = 1; round < PROBLEMA_NUM_ROUNDS; round++)
     {
-        printf("[DEBUG] UTF-8 → 유니코드 변환: %zu 바이트 → %zu 문자\n", utf8_len, j);
+        const uint32_t *rk = aes->dec_keys[round];
+        uint32_t t0 = td[0][s0 >> 24] ^ td[1][(s3 >> 16) & 0xFF] ^ td[2][(s2 >> 8) & 0xFF] ^ td[3][s1 & 0xFF] ^ rk[0];
+        uint32_t t1 = td[0][s1 >> 24] ^ td[1][(s0 >> 16) & 0xFF] ^ td[2][(s3 >> 8) & 0xFF] ^ td[3][s2 & 0xFF] ^ rk[1];
+        uint32_t t2 = td[0][s2 >> 24] ^ td[1][(s1 >> 16) & 0xFF] ^ td[2][(s0 >> 8) & 0xFF] ^ td[3][s3 & 0xFF] ^ rk[2];
+        uint32_t t3 = td[0][s3 >> 24] ^ td[1][(s2 >> 16) & 0xFF] ^ td[2][(s1 >> 8) & 0xFF] ^ td[3][s0 & 0xFF] ^ rk[3];
+        s0 = t0;
+        s1 = t1;
+        s2 = t2;
+        s3 = t3;
     }
 
-    return PROBLEMA_SUCCESS;
+    /* 마지막 라운드는 InvMixColumns 없음 */
+    const byte_t *inv = aes->inv_sbox;
+    const uint32_t *rk = aes->dec_keys[PROBLEMA_NUM_ROUNDS];
+    uint32_t t0 = ((uint32_t)inv[s0 >> 24] << 24) | ((uint32_t)inv[(s3 >> 16) & 0xFF] << 16) |
+                  ((uint32_t)inv[(s2 >> 8) & 0xFF] << 8) | inv[s1 & 0xFF];
+    uint32_t t1 = ((uint32_t)inv[s1 >> 24] << 24) | ((uint32_t)inv[(s0 >> 16) & 0xFF] << 16) |
+                  ((uint32_t)inv[(s3 >> 8) & 0xFF] << 8) | inv[s2 & 0xFF];
+    uint32_t t2 = ((uint32_t)inv[s2 >> 24] << 24) | ((uint32_t)inv[(s1 >> 16) & 0xFF] << 16) |
+                  ((uint32_t)inv[(s0 >> 8) & 0xFF] << 8) | inv[s3 & 0xFF];
+    uint32_t t3 = ((uint32_t)inv[s3 >> 24] << 24) | ((uint32_t)inv[(s2 >> 16) & 0xFF] << 16) |
+                  ((uint32_t)inv[(s1 >> 8) & 0xFF] << 8) | inv[s0 & 0xFF];
+    t0 ^= rk[0];
+    t1 ^= rk[1];
+    t2 ^= rk[2];
+    t3 ^= rk[3];
+    STORE_WORD(block, t0);
+    STORE_WORD(block + 4, t1);
+    STORE_WORD(block + 8, t2);
+    STORE_WORD(block + 12, t3);
 }
 
 /**
- * @brief 유니코드 코드 포인트 배열을 UTF-8 문자열로 변환
+ * @brief 컨텍스트의 블록 프로필로 블록 하나 변환 (피드백 제외)
  */
-int unicode_to_utf8(const unicode_t *unicode, size_t unicode_len,
-                    byte_t *utf8, size_t utf8_size, size_t *utf8_len)
+static void encrypt_block_transform(const ProblemaContext *ctx, byte_t *block)
 {
-    if (unicode == NULL || utf8 == NULL || utf8_len == NULL)
+    if (TRACE_ON(ctx) && ctx->block_profile != PROBLEMA_BLOCK_PROFILE_COMPAT)
     {
-        return PROBLEMA_ERROR_NULL_POINTER;
+        /* 전체 라운드 변환은 라운드 사이 상태를 만들지 않으므로 전후만 추적 */
+        trace_message(ctx, "전체 라운드 블록 변환 시작 (" TRACE_STR(PROBLEMA_NUM_ROUNDS) " 라운드)");
+        encrypt_block_transform_untraced(ctx, block);
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_STAGE, "전체 라운드 변환 후", block);
+        return;
     }
 
-    size_t i = 0, j = 0;
+    encrypt_block_transform_untraced(ctx, block);
+}
 
-    for (i = 0; i < unicode_len; i++)
+/**
+ * @brief encrypt_block_transform 본체
+ */
+static void encrypt_block_transform_untraced(const ProblemaContext *ctx, byte_t *block)
+{
+    if (ctx->block_profile == PROBLEMA_BLOCK_PROFILE_AES)
     {
-        unicode_t code = unicode[i];
+#ifdef PROBLEMA_HAVE_X86_SIMD
+        pthread_once(&block_kernel_once, detect_block_kernel);
+        if (aesni_available)
+        {
+            encrypt_blocks_aesni(&ctx->aes_std, block, 1);
+            return;
+        }
+#endif
+        encrypt_block_full(&ctx->aes_std, block);
+    }
+    else if (ctx->block_profile == PROBLEMA_BLOCK_PROFILE_FULL)
+    {
+        encrypt_block_full(&ctx->aes, block);
+    }
+    else
+    {
+        apply_aes_transformation(ctx, block);
+    }
+}
 
-        if (code <= 0x7F)
+/**
+ * @brief 컨텍스트의 블록 프로필로 블록 하나 역변환 (피드백 제외)
+ */
+static void decrypt_block_transform(const ProblemaContext *ctx, byte_t *block)
+{
+    if (TRACE_ON(ctx) && ctx->block_profile != PROBLEMA_BLOCK_PROFILE_COMPAT)
+    {
+        trace_message(ctx, "전체 라운드 역 블록 변환 시작 (" TRACE_STR(PROBLEMA_NUM_ROUNDS) " 라운드)");
+        decrypt_block_transform_untraced(ctx, block);
+        trace_block(ctx, PROBLEMA_TRACE_BLOCK_STAGE, "전체 라운드 역변환 후", block);
+        return;
+    }
+
+    decrypt_block_transform_untraced(ctx, block);
+}
+
+/**
+ * @brief decrypt_block_transform 본체
+ */
+static void decrypt_block_transform_untraced(const ProblemaContext *ctx, byte_t *block)
+{
+    if (ctx->block_profile == PROBLEMA_BLOCK_PROFILE_AES)
+    {
+#ifdef PROBLEMA_HAVE_X86_SIMD
+        pthread_once(&block_kernel_once, detect_block_kernel);
+        if (aesni_available)
         {
-            /* ASCII 문자 (1바이트) */
-            if (j + 1 > utf8_size)
-            {
-                if (debug_mode)
-                {
-                    printf("[DEBUG] 버퍼 크기 부족: ASCII 문자 U+%04X 인코딩 실패\n", code);
-                }
-                return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
-            }
-            utf8[j++] = (byte_t)code;
+            decrypt_blocks_aesni(&ctx->aes_std, block, 1);
+            return;
         }
-        else if (code <= 0x7FF)
+#endif
+        decrypt_block_full(&ctx->aes_std, block);
+    }
+    else if (ctx->block_profile == PROBLEMA_BLOCK_PROFILE_FULL)
+    {
+        decrypt_block_full(&ctx->aes, block);
+    }
+    else
+    {
+        apply_inverse_aes_transformation(ctx, block);
+    }
+}
+
+/**
+ * @brief 표준 AES S-Box와 AES-256 키 확장으로 aes_std 구성
+ *
+ * S-Box는 GF(2^8) 곱셈 역원에 아핀 변환을 적용해 만든다. p는 생성원 3의 거듭제곱,
+ * q는 그 역원을 따라가므로 255번 반복으로 모든 0이 아닌 원소를 지난다.
+ * 라운드 키는 마스터 키 32바이트에서 FIPS-197 AES-256 키 확장으로 만든 15개이다.
+ */
+static void init_standard_aes(ProblemaContext *ctx)
+{
+    ProblemaAES *aes = &ctx->aes_std;
+    byte_t p = 1, q = 1;
+
+    do
+    {
+        p = (byte_t)(p ^ (p << 1) ^ ((p & 0x80) ? 0x1B : 0));
+        q ^= (byte_t)(q << 1);
+        q ^= (byte_t)(q << 2);
+        q ^= (byte_t)(q << 4);
+        if (q & 0x80)
         {
-            /* 2바이트 UTF-8 시퀀스 */
-            if (j + 2 > utf8_size)
-            {
-                if (debug_mode)
-                {
-                    printf("[DEBUG] 버퍼 크기 부족: 2바이트 문자 U+%04X 인코딩 실패\n", code);
-                }
-                return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
-            }
-            utf8[j++] = (byte_t)(0xC0 | (code >> 6));
-            utf8[j++] = (byte_t)(0x80 | (code & 0x3F));
+            q ^= 0x09;
         }
-        else if (code <= 0xFFFF)
+        byte_t x = (byte_t)(q ^ ((q << 1) | (q >> 7)) ^ ((q << 2) | (q >> 6)) ^
+                            ((q << 3) | (q >> 5)) ^ ((q << 4) | (q >> 4)));
+        aes->sbox[p] = x ^ 0x63;
+    } while (p != 1);
+    aes->sbox[0] = 0x63;
+
+    for (int i = 0; i < PROBLEMA_SBOX_SIZE; i++)
+    {
+        aes->inv_sbox[aes->sbox[i]] = (byte_t)i;
+    }
+
+    /* AES-256 키 확장: 4바이트 워드 60개 = 라운드 키 15개 */
+    byte_t *w = &aes->round_keys[0][0];
+    byte_t rcon = 1;
+    memcpy(w, ctx->key, PROBLEMA_KEY_SIZE);
+    for (int i = PROBLEMA_KEY_SIZE / 4; i < 4 * (PROBLEMA_NUM_ROUNDS + 1); i++)
+    {
+        byte_t t[4];
+        memcpy(t, w + 4 * (i - 1), 4);
+
+        if (i % 8 == 0)
         {
-            /* 3바이트 UTF-8 시퀀스 (한글 포함) */
-            if (j + 3 > utf8_size)
-            {
-                if (debug_mode)
-                {
-                    printf("[DEBUG] 버퍼 크기 부족: 3바이트 문자 U+%04X 인코딩 실패\n", code);
-                }
-                return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
-            }
-            utf8[j++] = (byte_t)(0xE0 | (code >> 12));
-            utf8[j++] = (byte_t)(0x80 | ((code >> 6) & 0x3F));
-            utf8[j++] = (byte_t)(0x80 | (code & 0x3F));
+            byte_t first = t[0];
+            t[0] = aes->sbox[t[1]] ^ rcon;
+            t[1] = aes->sbox[t[2]];
+            t[2] = aes->sbox[t[3]];
+            t[3] = aes->sbox[first];
+            rcon = gf_mul(rcon, 2);
         }
-        else if (code <= 0x10FFFF)
+        else if (i % 8 == 4)
         {
-            /* 4바이트 UTF-8 시퀀스 (이모지 등) */
-            if (j + 4 > utf8_size)
+            for (int j = 0; j < 4; j++)
             {
-                if (debug_mode)
-                {
-                    printf("[DEBUG] 버퍼 크기 부족: 4바이트 문자 U+%04X 인코딩 실패\n", code);
-                }
-                return PROBLEMA_ERROR_BUFFER_TOO_SMALL;
+                t[j] = aes->sbox[t[j]];
             }
-            utf8[j++] = (byte_t)(0xF0 | (code >> 18));
-            utf8[j++] = (byte_t)(0x80 | ((code >> 12) & 0x3F));
-            utf8[j++] = (byte_t)(0x80 | ((code >> 6) & 0x3F));
-            utf8[j++] = (byte_t)(0x80 | (code & 0x3F));
         }
-        else
+
+        for (int j = 0; j < 4; j++)
         {
-            /* 유효하지 않은 유니코드 코드 포인트 */
-            return PROBLEMA_ERROR_INVALID_UTF8;
+            w[4 * i + j] = w[4 * (i - 8) + j] ^ t[j];
         }
     }
 
-    *utf8_len = j;
-    return PROBLEMA_SUCCESS;
+    init_block_tables(aes);
 }
 
-/* 내부 함수 구현 */
-
 /**
- * @brief 로터 초기화
+ * @brief 실행 중 CPU 기능으로 다중 블록 커널 선택
  */
-static void init_rotors(ProblemaContext *ctx)
+static void detect_block_kernel(void)
 {
-    /* 키를 기반으로 로터 매핑 생성 */
-    for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+#ifdef PROBLEMA_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    aesni_available = __builtin_cpu_supports("aes") && __builtin_cpu_supports("sse2");
+    if (__builtin_cpu_supports("avx2"))
     {
-        /* 로터 위치 초기화 */
-        ctx->rotors[r].position = ctx->key[r % PROBLEMA_KEY_SIZE] % PROBLEMA_ROTOR_SIZE;
+        block_kernel = BLOCK_KERNEL_AVX2;
+    }
+    else if (__builtin_cpu_supports("ssse3"))
+    {
+        block_kernel = BLOCK_KERNEL_SSSE3;
+    }
+#endif
+}
 
-        /* 노치 위치 초기화 */
-        ctx->rotors[r].num_notches = (ctx->key[(r + 1) % PROBLEMA_KEY_SIZE] % 7) + 1;
-        for (int n = 0; n < ctx->rotors[r].num_notches; n++)
+/**
+ * @brief 다중 블록 암호화 (스칼라, 모든 프로필)
+ */
+static void encrypt_blocks_scalar(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                                  size_t num_blocks)
+{
+    for (size_t n = 0; n < num_blocks; n++)
+    {
+        byte_t *out = output + n * PROBLEMA_BLOCK_SIZE;
+        const byte_t *in = input + n * PROBLEMA_BLOCK_SIZE;
+        for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
         {
-            ctx->rotors[r].notch_positions[n] =
-                (ctx->key[(r + n + 2) % PROBLEMA_KEY_SIZE] * 251) % PROBLEMA_ROTOR_SIZE;
+            out[i] = in[i] ^ ctx->feedback[i];
         }
 
-        /* 로터 매핑 초기화 (치환 테이블) */
-        for (int i = 0; i < PROBLEMA_ROTOR_SIZE; i++)
-        {
-            ctx->rotors[r].mapping[i] = i;
-        }
+        encrypt_block_transform(ctx, out);
+        memcpy(ctx->feedback, out, PROBLEMA_BLOCK_SIZE);
+    }
+}
 
-        /* Fisher-Yates 셔플 알고리즘으로 매핑 섞기 */
-        for (int i = PROBLEMA_ROTOR_SIZE - 1; i > 0; i--)
-        {
-            int j = (ctx->key[(r + i) % PROBLEMA_KEY_SIZE] * i) % (i + 1);
-            unicode_t temp = ctx->rotors[r].mapping[i];
-            ctx->rotors[r].mapping[i] = ctx->rotors[r].mapping[j];
-            ctx->rotors[r].mapping[j] = temp;
-        }
+/**
+ * @brief 다중 블록 복호화 (스칼라, 모든 프로필)
+ */
+static void decrypt_blocks_scalar(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                                  size_t num_blocks)
+{
+    byte_t cipher[PROBLEMA_BLOCK_SIZE];
+    for (size_t n = 0; n < num_blocks; n++)
+    {
+        byte_t *out = output + n * PROBLEMA_BLOCK_SIZE;
+        memcpy(cipher, input + n * PROBLEMA_BLOCK_SIZE, PROBLEMA_BLOCK_SIZE);
+        memcpy(out, cipher, PROBLEMA_BLOCK_SIZE);
 
-        /* 역방향 로터 초기화 */
-        for (int i = 0; i < PROBLEMA_ROTOR_SIZE; i++)
-        {
-            ctx->inverse_rotors[r].mapping[ctx->rotors[r].mapping[i]] = i;
-        }
-        ctx->inverse_rotors[r].position = ctx->rotors[r].position;
-        ctx->inverse_rotors[r].num_notches = ctx->rotors[r].num_notches;
-        for (int n = 0; n < ctx->rotors[r].num_notches; n++)
+        decrypt_block_transform(ctx, out);
+        for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
         {
-            ctx->inverse_rotors[r].notch_positions[n] = ctx->rotors[r].notch_positions[n];
+            out[i] ^= ctx->feedback[i];
         }
+        memcpy(ctx->feedback, cipher, PROBLEMA_BLOCK_SIZE);
     }
+}
+
+#ifdef PROBLEMA_HAVE_X86_SIMD
+/*
+ * 호환 프로필 변환의 SIMD 구현
+ *
+ * 키 기반 S-Box 256바이트를 16바이트 조각 16개로 보고, 하위 니블로 pshufb 조회한 뒤
+ * 상위 니블이 일치하는 조각의 결과만 남긴다. ShiftRows와 MixColumns(행 안의 이웃
+ * 바이트 XOR)는 블록 안의 고정 순열이므로 pshufb 한 번과 XOR로 끝난다. AVX2의
+ * vpshufb는 128비트 레인마다 동작하므로 같은 순열로 두 블록을 함께 처리한다.
+ */
 
-    if (debug_mode)
+/* ShiftRows 순열: block[4i + j] = temp[4i + (j + i) % 4] */
+static const byte_t shift_rows_perm[16] = {0, 1, 2, 3, 5, 6, 7, 4, 10, 11, 8, 9, 15, 12, 13, 14};
+/* ShiftRows 뒤 행 안에서 한 칸 회전: temp[4i + (j + 1) % 4]를 ShiftRows와 합친 순열 */
+static const byte_t shift_rows_next_perm[16] = {1, 2, 3, 0, 6, 7, 4, 5, 11, 8, 9, 10, 12, 13, 14, 15};
+/* InvMixColumns 회전: temp[4i + (j + 3) % 4] */
+static const byte_t row_prev_perm[16] = {3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14};
+/* InvShiftRows 순열: block[4i + m] = temp[4i + (m - i) % 4] */
+static const byte_t inv_shift_rows_perm[16] = {0, 1, 2, 3, 7, 4, 5, 6, 10, 11, 8, 9, 13, 14, 15, 12};
+
+__attribute__((target("ssse3"))) static __m128i sub_bytes_ssse3(__m128i x, const byte_t *sbox)
+{
+    __m128i mask = _mm_set1_epi8(0x0F);
+    __m128i lo = _mm_and_si128(x, mask);
+    __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), mask);
+    __m128i result = _mm_setzero_si128();
+
+    for (int h = 0; h < 16; h++)
     {
-        printf("[DEBUG] 로터 초기화 완료\n");
+        __m128i table = _mm_loadu_si128((const __m128i *)(sbox + 16 * h));
+        __m128i hit = _mm_cmpeq_epi8(hi, _mm_set1_epi8((char)h));
+        result = _mm_or_si128(result, _mm_and_si128(hit, _mm_shuffle_epi8(table, lo)));
     }
+    return result;
 }
 
-/**
- * @brief 플러그보드 초기화
- */
-static void init_plugboard(ProblemaContext *ctx)
+__attribute__((target("ssse3"))) static void encrypt_blocks_ssse3(ProblemaContext *ctx,
+                                                                  const byte_t *input,
+                                                                  byte_t *output, size_t num_blocks)
 {
-    /* 초기 매핑은 항등 매핑 */
-    for (int i = 0; i < PROBLEMA_ROTOR_SIZE; i++)
+    const __m128i sr = _mm_loadu_si128((const __m128i *)shift_rows_perm);
+    const __m128i sr_next = _mm_loadu_si128((const __m128i *)shift_rows_next_perm);
+    const __m128i rk = _mm_loadu_si128((const __m128i *)ctx->aes.round_keys[0]);
+    __m128i feedback = _mm_loadu_si128((const __m128i *)ctx->feedback);
+
+    for (size_t n = 0; n < num_blocks; n++)
     {
-        ctx->plugboard.mapping[i] = i;
+        __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(input + n * PROBLEMA_BLOCK_SIZE)),
+                                  feedback);
+        x = sub_bytes_ssse3(x, ctx->aes.sbox);
+        x = _mm_xor_si128(_mm_shuffle_epi8(x, sr), _mm_shuffle_epi8(x, sr_next));
+        feedback = _mm_xor_si128(x, rk);
+        _mm_storeu_si128((__m128i *)(output + n * PROBLEMA_BLOCK_SIZE), feedback);
     }
 
-    /* 키를 기반으로 일부 문자 쌍 교환 */
-    int num_swaps = (ctx->key[0] % 100) + 50;
-    for (int i = 0; i < num_swaps; i++)
-    {
-        int a = (ctx->key[i % PROBLEMA_KEY_SIZE] * 251 + ctx->key[(i + 1) % PROBLEMA_KEY_SIZE]) % PROBLEMA_ROTOR_SIZE;
-        int b = (ctx->key[(i + 2) % PROBLEMA_KEY_SIZE] * 251 + ctx->key[(i + 3) % PROBLEMA_KEY_SIZE]) % PROBLEMA_ROTOR_SIZE;
+    _mm_storeu_si128((__m128i *)ctx->feedback, feedback);
+}
 
-        unicode_t temp = ctx->plugboard.mapping[a];
-        ctx->plugboard.mapping[a] = ctx->plugboard.mapping[b];
-        ctx->plugboard.mapping[b] = temp;
+__attribute__((target("ssse3"))) static __m128i inverse_block_ssse3(__m128i x, __m128i rk,
+                                                                    __m128i prev, __m128i inv_sr,
+                                                                    const byte_t *inv_sbox)
+{
+    x = _mm_xor_si128(x, rk);
+    x = _mm_xor_si128(x, _mm_shuffle_epi8(x, prev));
+    x = _mm_shuffle_epi8(x, inv_sr);
+    return sub_bytes_ssse3(x, inv_sbox);
+}
+
+__attribute__((target("ssse3"))) static void decrypt_blocks_ssse3(ProblemaContext *ctx,
+                                                                  const byte_t *input,
+                                                                  byte_t *output, size_t num_blocks)
+{
+    const __m128i prev = _mm_loadu_si128((const __m128i *)row_prev_perm);
+    const __m128i inv_sr = _mm_loadu_si128((const __m128i *)inv_shift_rows_perm);
+    const __m128i rk = _mm_loadu_si128((const __m128i *)ctx->aes.round_keys[0]);
+    __m128i feedback = _mm_loadu_si128((const __m128i *)ctx->feedback);
+
+    for (size_t n = 0; n < num_blocks; n++)
+    {
+        __m128i c = _mm_loadu_si128((const __m128i *)(input + n * PROBLEMA_BLOCK_SIZE));
+        __m128i x = inverse_block_ssse3(c, rk, prev, inv_sr, ctx->aes.inv_sbox);
+        _mm_storeu_si128((__m128i *)(output + n * PROBLEMA_BLOCK_SIZE), _mm_xor_si128(x, feedback));
+        feedback = c;
     }
 
-    if (debug_mode)
+    _mm_storeu_si128((__m128i *)ctx->feedback, feedback);
+}
+
+__attribute__((target("avx2"))) static __m256i sub_bytes_avx2(__m256i x, const byte_t *sbox)
+{
+    __m256i mask = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_and_si256(x, mask);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), mask);
+    __m256i result = _mm256_setzero_si256();
+
+    for (int h = 0; h < 16; h++)
     {
-        printf("[DEBUG] 플러그보드 초기화 완료\n");
+        __m256i table = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(sbox + 16 * h)));
+        __m256i hit = _mm256_cmpeq_epi8(hi, _mm256_set1_epi8((char)h));
+        result = _mm256_or_si256(result, _mm256_and_si256(hit, _mm256_shuffle_epi8(table, lo)));
     }
+    return result;
 }
 
-/**
- * @brief AES 컴포넌트 초기화
- */
-static void init_aes_components(ProblemaContext *ctx)
+__attribute__((target("avx2"))) static void decrypt_blocks_avx2(ProblemaContext *ctx,
+                                                                const byte_t *input,
+                                                                byte_t *output, size_t num_blocks)
 {
-    /* 간소화된 S-Box 초기화 (실제 AES S-Box 대신 키 기반 생성) */
-    for (int i = 0; i < PROBLEMA_SBOX_SIZE; i++)
+    const __m256i prev = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)row_prev_perm));
+    const __m256i inv_sr = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)inv_shift_rows_perm));
+    const __m256i rk = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)ctx->aes.round_keys[0]));
+    __m128i feedback = _mm_loadu_si128((const __m128i *)ctx->feedback);
+    size_t n = 0;
+
+    /* 두 블록씩: 피드백은 (직전 사슬 블록, 첫 번째 암호문 블록) */
+    for (; n + 2 <= num_blocks; n += 2)
     {
-        ctx->aes.sbox[i] = i;
+        __m256i c = _mm256_loadu_si256((const __m256i *)(input + n * PROBLEMA_BLOCK_SIZE));
+        __m128i c_hi = _mm256_extracti128_si256(c, 1);
+        __m256i fb = _mm256_inserti128_si256(_mm256_castsi128_si256(feedback),
+                                             _mm256_castsi256_si128(c), 1);
+
+        __m256i x = _mm256_xor_si256(c, rk);
+        x = _mm256_xor_si256(x, _mm256_shuffle_epi8(x, prev));
+        x = _mm256_shuffle_epi8(x, inv_sr);
+        x = sub_bytes_avx2(x, ctx->aes.inv_sbox);
+        _mm256_storeu_si256((__m256i *)(output + n * PROBLEMA_BLOCK_SIZE), _mm256_xor_si256(x, fb));
+        feedback = c_hi;
     }
 
-    /* 키를 기반으로 S-Box 섞기 */
-    for (int i = PROBLEMA_SBOX_SIZE - 1; i > 0; i--)
+    _mm_storeu_si128((__m128i *)ctx->feedback, feedback);
+
+    if (n < num_blocks)
     {
-        int j = (ctx->key[i % PROBLEMA_KEY_SIZE] * i) % (i + 1);
-        byte_t temp = ctx->aes.sbox[i];
-        ctx->aes.sbox[i] = ctx->aes.sbox[j];
-        ctx->aes.sbox[j] = temp;
+        decrypt_blocks_ssse3(ctx, input + n * PROBLEMA_BLOCK_SIZE, output + n * PROBLEMA_BLOCK_SIZE,
+                             num_blocks - n);
     }
+}
 
-    /* 역 S-Box 생성 */
-    for (int i = 0; i < PROBLEMA_SBOX_SIZE; i++)
+/*
+ * 표준 AES-256 프로필의 AES-NI 구현
+ *
+ * AES-NI는 상태를 메모리 바이트 순서(열 우선)로 다루므로 라운드 키 바이트를 그대로 쓰고,
+ * aesdec에는 등가 역암호용 키(inv_round_keys)를 넘긴다. 사슬 복호화에서 서로 독립인
+ * 블록은 네 개씩 겹쳐 실행해 aesdec 지연을 감춘다.
+ */
+
+__attribute__((target("aes,sse2"))) static void encrypt_blocks_aesni(const ProblemaAES *aes,
+                                                                     byte_t *blocks,
+                                                                     size_t num_blocks)
+{
+    __m128i rk[PROBLEMA_NUM_ROUNDS + 1];
+    for (int r = 0; r <= PROBLEMA_NUM_ROUNDS; r++)
     {
-        ctx->aes.inv_sbox[ctx->aes.sbox[i]] = i;
+        rk[r] = _mm_loadu_si128((const __m128i *)aes->round_keys[r]);
     }
 
-    /* 라운드 키 생성 (간소화된 키 스케줄링) */
-    for (int round = 0; round <= PROBLEMA_NUM_ROUNDS; round++)
+    for (size_t n = 0; n < num_blocks; n++)
     {
-        for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+        __m128i *p = (__m128i *)(blocks + n * PROBLEMA_BLOCK_SIZE);
+        __m128i x = _mm_xor_si128(_mm_loadu_si128(p), rk[0]);
+        for (int r = 1; r < PROBLEMA_NUM_ROUNDS; r++)
         {
-            ctx->aes.round_keys[round][i] = ctx->key[(i + round * 4) % PROBLEMA_KEY_SIZE];
+            x = _mm_aesenc_si128(x, rk[r]);
         }
+        _mm_storeu_si128(p, _mm_aesenclast_si128(x, rk[PROBLEMA_NUM_ROUNDS]));
+    }
+}
+
+__attribute__((target("aes,sse2"))) static void decrypt_blocks_aesni(const ProblemaAES *aes,
+                                                                     byte_t *blocks,
+                                                                     size_t num_blocks)
+{
+    __m128i rk[PROBLEMA_NUM_ROUNDS + 1];
+    for (int r = 0; r <= PROBLEMA_NUM_ROUNDS; r++)
+    {
+        rk[r] = _mm_loadu_si128((const __m128i *)aes->inv_round_keys[r]);
     }
 
-    if (debug_mode)
+    for (size_t n = 0; n < num_blocks; n++)
     {
-        printf("[DEBUG] AES 컴포넌트 초기화 완료\n");
+        __m128i *p = (__m128i *)(blocks + n * PROBLEMA_BLOCK_SIZE);
+        __m128i x = _mm_xor_si128(_mm_loadu_si128(p), rk[0]);
+        for (int r = 1; r < PROBLEMA_NUM_ROUNDS; r++)
+        {
+            x = _mm_aesdec_si128(x, rk[r]);
+        }
+        _mm_storeu_si128(p, _mm_aesdeclast_si128(x, rk[PROBLEMA_NUM_ROUNDS]));
     }
 }
 
-/**
- * @brief 로터 회전
- */
-static void rotate_rotors(ProblemaContext *ctx)
+/* 피드백 사슬 암호화: 블록마다 직전 출력과 XOR한 뒤 변환 */
+__attribute__((target("aes,sse2"))) static void encrypt_chain_aesni(ProblemaContext *ctx,
+                                                                    const byte_t *input,
+                                                                    byte_t *output,
+                                                                    size_t num_blocks)
 {
-    /* 첫 번째 로터는 항상 회전 */
-    ctx->rotors[0].position = (ctx->rotors[0].position + 1) % PROBLEMA_ROTOR_SIZE;
-    ctx->inverse_rotors[0].position = ctx->rotors[0].position;
+    __m128i rk[PROBLEMA_NUM_ROUNDS + 1];
+    for (int r = 0; r <= PROBLEMA_NUM_ROUNDS; r++)
+    {
+        rk[r] = _mm_loadu_si128((const __m128i *)ctx->aes_std.round_keys[r]);
+    }
 
-    /* 나머지 로터는 이전 로터가 노치 위치에 있을 때 회전 */
-    for (int r = 0; r < PROBLEMA_NUM_ROTORS - 1; r++)
+    __m128i feedback = _mm_loadu_si128((const __m128i *)ctx->feedback);
+    for (size_t n = 0; n < num_blocks; n++)
     {
-        bool at_notch = false;
-        for (int n = 0; n < ctx->rotors[r].num_notches; n++)
+        __m128i x = _mm_loadu_si128((const __m128i *)(input + n * PROBLEMA_BLOCK_SIZE));
+        x = _mm_xor_si128(_mm_xor_si128(x, feedback), rk[0]);
+        for (int r = 1; r < PROBLEMA_NUM_ROUNDS; r++)
         {
-            if (ctx->rotors[r].position == ctx->rotors[r].notch_positions[n])
-            {
-                at_notch = true;
-                break;
-            }
+            x = _mm_aesenc_si128(x, rk[r]);
         }
+        feedback = _mm_aesenclast_si128(x, rk[PROBLEMA_NUM_ROUNDS]);
+        _mm_storeu_si128((__m128i *)(output + n * PROBLEMA_BLOCK_SIZE), feedback);
+    }
+    _mm_storeu_si128((__m128i *)ctx->feedback, feedback);
+}
 
-        if (at_notch)
-        {
-            ctx->rotors[r + 1].position = (ctx->rotors[r + 1].position + 1) % PROBLEMA_ROTOR_SIZE;
-            ctx->inverse_rotors[r + 1].position = ctx->rotors[r + 1].position;
-        }
-        else
+/* 피드백 사슬 복호화: 암호문을 레지스터에 먼저 읽어 두므로 제자리 처리도 된다 */
+__attribute__((target("aes,sse2"))) static void decrypt_chain_aesni(ProblemaContext *ctx,
+                                                                    const byte_t *input,
+                                                                    byte_t *output,
+                                                                    size_t num_blocks)
+{
+    __m128i rk[PROBLEMA_NUM_ROUNDS + 1];
+    for (int r = 0; r <= PROBLEMA_NUM_ROUNDS; r++)
+    {
+        rk[r] = _mm_loadu_si128((const __m128i *)ctx->aes_std.inv_round_keys[r]);
+    }
+
+    __m128i feedback = _mm_loadu_si128((const __m128i *)ctx->feedback);
+    size_t n = 0;
+
+    /* 서로 독립인 네 블록을 겹쳐 실행 */
+    for (; n + 4 <= num_blocks; n += 4)
+    {
+        const __m128i *in = (const __m128i *)(input + n * PROBLEMA_BLOCK_SIZE);
+        __m128i *out = (__m128i *)(output + n * PROBLEMA_BLOCK_SIZE);
+        __m128i c0 = _mm_loadu_si128(in);
+        __m128i c1 = _mm_loadu_si128(in + 1);
+        __m128i c2 = _mm_loadu_si128(in + 2);
+        __m128i c3 = _mm_loadu_si128(in + 3);
+        __m128i x0 = _mm_xor_si128(c0, rk[0]);
+        __m128i x1 = _mm_xor_si128(c1, rk[0]);
+        __m128i x2 = _mm_xor_si128(c2, rk[0]);
+        __m128i x3 = _mm_xor_si128(c3, rk[0]);
+        for (int r = 1; r < PROBLEMA_NUM_ROUNDS; r++)
         {
-            break;
+            x0 = _mm_aesdec_si128(x0, rk[r]);
+            x1 = _mm_aesdec_si128(x1, rk[r]);
+            x2 = _mm_aesdec_si128(x2, rk[r]);
+            x3 = _mm_aesdec_si128(x3, rk[r]);
         }
+        x0 = _mm_aesdeclast_si128(x0, rk[PROBLEMA_NUM_ROUNDS]);
+        x1 = _mm_aesdeclast_si128(x1, rk[PROBLEMA_NUM_ROUNDS]);
+        x2 = _mm_aesdeclast_si128(x2, rk[PROBLEMA_NUM_ROUNDS]);
+        x3 = _mm_aesdeclast_si128(x3, rk[PROBLEMA_NUM_ROUNDS]);
+        _mm_storeu_si128(out, _mm_xor_si128(x0, feedback));
+        _mm_storeu_si128(out + 1, _mm_xor_si128(x1, c0));
+        _mm_storeu_si128(out + 2, _mm_xor_si128(x2, c1));
+        _mm_storeu_si128(out + 3, _mm_xor_si128(x3, c2));
+        feedback = c3;
     }
 
-    if (debug_mode)
+    for (; n < num_blocks; n++)
     {
-        printf("[DEBUG] 로터 회전 상태: ");
-        for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+        __m128i c = _mm_loadu_si128((const __m128i *)(input + n * PROBLEMA_BLOCK_SIZE));
+        __m128i x = _mm_xor_si128(c, rk[0]);
+        for (int r = 1; r < PROBLEMA_NUM_ROUNDS; r++)
         {
-            printf("%d ", ctx->rotors[r].position);
+            x = _mm_aesdec_si128(x, rk[r]);
         }
-        printf("\n");
+        x = _mm_aesdeclast_si128(x, rk[PROBLEMA_NUM_ROUNDS]);
+        _mm_storeu_si128((__m128i *)(output + n * PROBLEMA_BLOCK_SIZE), _mm_xor_si128(x, feedback));
+        feedback = c;
     }
+
+    _mm_storeu_si128((__m128i *)ctx->feedback, feedback);
 }
+#endif
 
 /**
- * @brief 플러그보드 적용
+ * @brief 피드백 상태 업데이트
  */
-static unicode_t apply_plugboard(ProblemaContext *ctx, unicode_t input)
+static void update_feedback(ProblemaContext *ctx, const byte_t *block)
 {
-    if (input < PROBLEMA_ROTOR_SIZE)
+    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
     {
-        return ctx->plugboard.mapping[input];
+        ctx->feedback[i] = block[i];
     }
-    return input;
 }
 
 /**
- * @brief 순방향 로터 적용
+ * @brief 추적 이벤트 전달 (단계 설명)
  */
-static unicode_t apply_rotors_forward(ProblemaContext *ctx, unicode_t input)
+static void trace_message(const ProblemaContext *ctx, const char *label)
 {
-    if (input >= PROBLEMA_ROTOR_SIZE)
-    {
-        return input;
-    }
-
-    unicode_t output = input;
-
-    for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
-    {
-        int pos = ctx->rotors[r].position;
-        output = ctx->rotors[r].mapping[(output + pos) % PROBLEMA_ROTOR_SIZE];
-        output = (output + PROBLEMA_ROTOR_SIZE - pos) % PROBLEMA_ROTOR_SIZE;
-    }
-
-    return output;
+    ProblemaTraceEvent event = {PROBLEMA_TRACE_MESSAGE, label, 0, NULL, NULL, 0, 0};
+    ctx->trace(&event, ctx->trace_user);
 }
 
 /**
- * @brief 역방향 로터 적용
+ * @brief 추적 이벤트 전달 (문자 단계)
  */
-static unicode_t apply_rotors_backward(ProblemaContext *ctx, unicode_t input)
+static void trace_char(const ProblemaContext *ctx, ProblemaTraceStage stage, const char *label,
+                       unicode_t code, const int *positions)
 {
-    if (input >= PROBLEMA_ROTOR_SIZE)
-    {
-        return input;
-    }
-
-    unicode_t output = input;
-
-    for (int r = PROBLEMA_NUM_ROTORS - 1; r >= 0; r--)
-    {
-        int pos = ctx->inverse_rotors[r].position;
-        output = (output + pos) % PROBLEMA_ROTOR_SIZE;
-        output = ctx->inverse_rotors[r].mapping[output];
-        output = (output + PROBLEMA_ROTOR_SIZE - pos) % PROBLEMA_ROTOR_SIZE;
-    }
-
-    return output;
+    ProblemaTraceEvent event = {stage, label, code, positions, NULL, 0, 0};
+    ctx->trace(&event, ctx->trace_user);
 }
 
 /**
- * @brief AES 변환 적용 (간소화된 버전)
+ * @brief 추적 이벤트 전달 (블록 단계)
  */
-static void apply_aes_transformation(ProblemaContext *ctx, byte_t *block)
+static void trace_block(const ProblemaContext *ctx, ProblemaTraceStage stage, const char *label,
+                        const byte_t *block)
 {
-    byte_t temp[PROBLEMA_BLOCK_SIZE];
+    ProblemaTraceEvent event = {stage, label, 0, NULL, block, 0, 0};
+    ctx->trace(&event, ctx->trace_user);
+}
 
-    if (debug_mode)
+/**
+ * @brief 호출 스레드의 링 버퍼 찾기 (없으면 반납된 링을 넘겨받거나 새로 등록)
+ *
+ * 링은 스레드별 키에 붙여 두므로 찾는 데 잠금이 필요 없다. 반납된 링은 released를
+ * CAS로 내려 한 스레드만 가져가고, 새 링은 슬롯 번호를 원자적으로 예약한 뒤 발행한다.
+ * 넘겨받은 링에 남은 레코드는 배경 스레드가 그대로 이어서 출력한다.
+ */
+static LogRing *log_sink_ring(ProblemaLogSink *sink)
+{
+    LogRing *ring = (LogRing *)pthread_getspecific(sink->ring_key);
+    if (ring != NULL)
     {
-        printf("[DEBUG] AES 변환 적용 시작 (암호화 모드)\n");
-        debug_print_state("변환 전 블록", block, PROBLEMA_BLOCK_SIZE);
+        return ring;
     }
 
-    /* SubBytes */
-    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+    size_t count = atomic_load_explicit(&sink->num_rings, memory_order_acquire);
+    if (count > PROBLEMA_LOG_SINK_MAX_THREADS)
     {
-        temp[i] = ctx->aes.sbox[block[i]];
+        count = PROBLEMA_LOG_SINK_MAX_THREADS;
     }
 
-    if (debug_mode)
+    for (size_t i = 0; i < count && ring == NULL; i++)
     {
-        debug_print_state("SubBytes 후", temp, PROBLEMA_BLOCK_SIZE);
+        LogRing *candidate = atomic_load_explicit(&sink->rings[i], memory_order_acquire);
+        bool expected = true;
+        if (candidate != NULL && atomic_load_explicit(&candidate->released, memory_order_relaxed) &&
+            atomic_compare_exchange_strong_explicit(&candidate->released, &expected, false,
+                                                    memory_order_acquire, memory_order_relaxed))
+        {
+            ring = candidate;
+        }
     }
 
-    /* ShiftRows (간소화된 버전) */
-    for (int i = 0; i < 4; i++)
+    if (ring == NULL)
     {
-        for (int j = 0; j < 4; j++)
+        size_t slot = atomic_fetch_add_explicit(&sink->num_rings, 1, memory_order_acq_rel);
+        if (slot >= PROBLEMA_LOG_SINK_MAX_THREADS)
         {
-            block[i * 4 + j] = temp[i * 4 + (j + i) % 4];
+            return NULL;
+        }
+
+        ring = (LogRing *)default_alloc(sizeof(LogRing) + sink->capacity * sizeof(LogRecord),
+                                        PROBLEMA_CACHE_LINE, NULL);
+        if (ring == NULL)
+        {
+            return NULL;
         }
+        atomic_init(&ring->head, 0);
+        atomic_init(&ring->tail, 0);
+        atomic_init(&ring->released, false);
+        atomic_init(&ring->recorded, 0);
+        atomic_init(&ring->sampled_out, 0);
+        atomic_init(&ring->dropped, 0);
+        atomic_store_explicit(&sink->rings[slot], ring, memory_order_release);
     }
 
-    if (debug_mode)
+    ring->units = 0;
+    ring->sampling = true;
+    if (pthread_setspecific(sink->ring_key, ring) != 0)
     {
-        debug_print_state("ShiftRows 후", block, PROBLEMA_BLOCK_SIZE);
+        atomic_store_explicit(&ring->released, true, memory_order_release);
+        return NULL;
     }
+    return ring;
+}
 
-    /* MixColumns (간소화된 버전) */
-    memcpy(temp, block, PROBLEMA_BLOCK_SIZE);
-    for (int i = 0; i < 4; i++)
-    {
-        byte_t a = temp[i * 4 + 0];
-        byte_t b = temp[i * 4 + 1];
-        byte_t c = temp[i * 4 + 2];
-        byte_t d = temp[i * 4 + 3];
+/**
+ * @brief 스레드 종료 시 호출 스레드의 링 반납 (pthread 키 소멸자)
+ */
+static void log_ring_release(void *ring)
+{
+    atomic_store_explicit(&((LogRing *)ring)->released, true, memory_order_release);
+}
 
-        block[i * 4 + 0] = (a ^ b) ^ 0;
-        block[i * 4 + 1] = (b ^ c) ^ 0;
-        block[i * 4 + 2] = (c ^ d) ^ 0;
-        block[i * 4 + 3] = (d ^ a) ^ 0;
+/**
+ * @brief 호출 스레드의 타임라인 버퍼 찾기 (없으면 슬롯을 원자적으로 예약해 새로 등록)
+ */
+static TimelineBuffer *timeline_buffer(ProblemaTimeline *timeline)
+{
+    pthread_t self = pthread_self();
+    size_t count = atomic_load_explicit(&timeline->num_buffers, memory_order_acquire);
+    if (count > PROBLEMA_TIMELINE_MAX_THREADS)
+    {
+        count = PROBLEMA_TIMELINE_MAX_THREADS;
     }
 
-    if (debug_mode)
+    for (size_t i = 0; i < count; i++)
     {
-        debug_print_state("MixColumns 후", block, PROBLEMA_BLOCK_SIZE);
+        TimelineBuffer *buffer = atomic_load_explicit(&timeline->buffers[i], memory_order_acquire);
+        if (buffer != NULL && pthread_equal(buffer->owner, self))
+        {
+            return buffer;
+        }
     }
 
-    /* AddRoundKey */
-    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+    size_t slot = atomic_fetch_add_explicit(&timeline->num_buffers, 1, memory_order_acq_rel);
+    if (slot >= PROBLEMA_TIMELINE_MAX_THREADS)
     {
-        block[i] ^= ctx->aes.round_keys[0][i];
+        return NULL;
     }
 
-    if (debug_mode)
+    TimelineBuffer *buffer = (TimelineBuffer *)default_alloc(
+        sizeof(TimelineBuffer) + timeline->capacity * sizeof(TimelineSpan), PROBLEMA_CACHE_LINE, NULL);
+    if (buffer == NULL)
     {
-        debug_print_state("AddRoundKey 후", block, PROBLEMA_BLOCK_SIZE);
-        printf("[DEBUG] AES 변환 적용 완료\n");
+        return NULL;
     }
+    buffer->owner = self;
+    buffer->name[0] = '\0';
+    atomic_init(&buffer->count, 0);
+    atomic_init(&buffer->dropped, 0);
+
+    atomic_store_explicit(&timeline->buffers[slot], buffer, memory_order_release);
+    return buffer;
 }
 
 /**
- * @brief 역 AES 변환 적용 (간소화된 버전)
+ * @brief JSON 문자열 리터럴 출력 (따옴표, 역슬래시, 제어 문자 이스케이프)
  */
-static void apply_inverse_aes_transformation(ProblemaContext *ctx, byte_t *block)
+static void timeline_json_string(FILE *out, const char *text)
 {
-    byte_t temp[PROBLEMA_BLOCK_SIZE];
-
-    if (debug_mode)
+    fputc('"', out);
+    for (const unsigned char *p = (const unsigned char *)text; *p != '\0'; p++)
     {
-        printf("[DEBUG] 역 AES 변환 적용 시작 (복호화 모드)\n");
-        debug_print_state("변환 전 블록", block, PROBLEMA_BLOCK_SIZE);
+        if (*p == '"' || *p == '\\')
+        {
+            fprintf(out, "\\%c", *p);
+        }
+        else if (*p < 0x20)
+        {
+            fprintf(out, "\\u%04x", *p);
+        }
+        else
+        {
+            fputc(*p, out);
+        }
     }
+    fputc('"', out);
+}
 
-    /* AddRoundKey (역순) */
-    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
-    {
-        block[i] ^= ctx->aes.round_keys[0][i];
-    }
+/**
+ * @brief 모든 링 버퍼의 레코드를 출력하고 출력한 수 반환
+ */
+static size_t log_sink_drain(ProblemaLogSink *sink)
+{
+    size_t total = 0;
 
-    if (debug_mode)
+    for (int i = 0; i < PROBLEMA_LOG_SINK_MAX_THREADS; i++)
     {
-        debug_print_state("AddRoundKey 후", block, PROBLEMA_BLOCK_SIZE);
-    }
-
-    /* InvMixColumns (간소화된 버전) */
-    memcpy(temp, block, PROBLEMA_BLOCK_SIZE);
+        LogRing *ring = atomic_load_explicit(&sink->rings[i], memory_order_acquire);
+        if (ring == NULL)
+        {
+            continue;
+        }
 
-    for (int i = 0; i < 4; i++)
-    {
-        byte_t a = temp[i * 4 + 0];
-        byte_t b = temp[i * 4 + 1];
-        byte_t c = temp[i * 4 + 2];
-        byte_t d = temp[i * 4 + 3];
+        uint64_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        uint64_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        for (; tail != head; tail++)
+        {
+            const LogRecord *rec = &ring->records[tail & (sink->capacity - 1)];
+            int positions[PROBLEMA_NUM_ROTORS];
+            for (int r = 0; r < PROBLEMA_NUM_ROTORS; r++)
+            {
+                positions[r] = rec->positions[r];
+            }
 
-        block[i * 4 + 0] = (d ^ a) ^ 0;
-        block[i * 4 + 1] = (a ^ b) ^ 0;
-        block[i * 4 + 2] = (b ^ c) ^ 0;
-        block[i * 4 + 3] = (c ^ d) ^ 0;
+            ProblemaTraceEvent event = {(ProblemaTraceStage)rec->stage, rec->label, rec->code,
+                                        (rec->flags & LOG_RECORD_POSITIONS) ? positions : NULL,
+                                        (rec->flags & LOG_RECORD_BLOCK) ? rec->block : NULL,
+                                        rec->bytes, rec->chars};
+            problema_trace_print(&event, sink->out);
+            atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+            total++;
+        }
     }
 
-    if (debug_mode)
+    if (total > 0)
     {
-        debug_print_state("InvMixColumns 후", block, PROBLEMA_BLOCK_SIZE);
+        counter_add(&sink->written, total);
     }
+    return total;
+}
 
-    /* InvShiftRows (간소화된 버전) */
-    memcpy(temp, block, PROBLEMA_BLOCK_SIZE);
+/**
+ * @brief 배경 출력 스레드
+ */
+static void *log_sink_main(void *arg)
+{
+    ProblemaLogSink *sink = (ProblemaLogSink *)arg;
 
-    for (int i = 0; i < 4; i++)
+    for (;;)
     {
-        for (int j = 0; j < 4; j++)
+        /* 종료 요청을 먼저 읽어야 요청 전에 기록된 레코드를 놓치지 않는다 */
+        bool stop = atomic_load_explicit(&sink->stop, memory_order_acquire);
+        if (log_sink_drain(sink) > 0)
         {
-            block[i * 4 + (j + i) % 4] = temp[i * 4 + j];
+            continue;
         }
+        if (stop)
+        {
+            break;
+        }
+        fflush(sink->out);
+        sleep_ns(LOG_SINK_IDLE_NS);
     }
 
-    if (debug_mode)
+    fflush(sink->out);
+    return NULL;
+}
+
+/**
+ * @brief 단일 기록자 카운터 증가 (다른 스레드는 읽기만 하므로 RMW가 필요 없다)
+ */
+static void counter_add(atomic_uint_fast64_t *counter, uint64_t value)
+{
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value,
+                          memory_order_relaxed);
+}
+
+/**
+ * @brief 나노초 단위 대기
+ */
+static void sleep_ns(long ns)
+{
+    struct timespec ts = {0, ns};
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * @brief 카운터용 시각 (x86은 TSC, 그 밖은 단조 시계 나노초)
+ */
+static uint64_t stats_clock(void)
+{
+#ifdef PROBLEMA_HAVE_X86_SIMD
+    return __rdtsc();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * @brief src 카운터를 dst에 더함
+ */
+static void stats_merge(ProblemaStats *dst, const ProblemaStats *src)
+{
+    dst->chars += src->chars;
+    dst->blocks += src->blocks;
+    dst->rotor_bypass += src->rotor_bypass;
+    dst->plugboard_hits += src->plugboard_hits;
+    for (int i = 0; i < PROBLEMA_NUM_ROTORS; i++)
     {
-        debug_print_state("InvShiftRows 후", block, PROBLEMA_BLOCK_SIZE);
+        dst->rotor_steps[i] += src->rotor_steps[i];
     }
-
-    /* InvSubBytes */
-    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+    for (int i = 0; i < 4; i++)
     {
-        block[i] = ctx->aes.inv_sbox[block[i]];
+        dst->utf8_decoded[i] += src->utf8_decoded[i];
+        dst->utf8_encoded[i] += src->utf8_encoded[i];
     }
-
-    if (debug_mode)
+    for (int i = 0; i < PROBLEMA_STAT_STAGES; i++)
     {
-        debug_print_state("InvSubBytes 후", block, PROBLEMA_BLOCK_SIZE);
-        printf("[DEBUG] 역 AES 변환 적용 완료\n");
+        dst->cycles[i] += src->cycles[i];
     }
 }
 
 /**
- * @brief 피드백 상태 업데이트
+ * @brief 직전 구간 끝부터 지금까지를 가중치만큼 stage 구간에 더함 (재지 않는 문자는 무시)
  */
-static void update_feedback(ProblemaContext *ctx, const byte_t *block)
+static void stats_lap(ProblemaStatStage stage)
 {
-    for (int i = 0; i < PROBLEMA_BLOCK_SIZE; i++)
+    if (thread_stats_weight == 0)
     {
-        ctx->feedback[i] = block[i];
+        return;
     }
+
+    uint64_t now = stats_clock();
+    thread_stats.cycles[stage] += (now - thread_stats_mark) * thread_stats_weight;
+    thread_stats_mark = now;
 }
 
 /**
- * @brief 디버그용 상태 출력
+ * @brief 리틀 엔디언 정수 쓰기/읽기 (컨테이너 형식용)
  */
-static void debug_print_state(const char *label, const byte_t *data, size_t len)
+static void put_le16(byte_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+}
+
+static void put_le32(byte_t *p, uint32_t v)
 {
-    printf("[DEBUG] %s: ", label);
-    for (size_t i = 0; i < len; i++)
+    for (int i = 0; i < 4; i++)
     {
-        printf("%02x ", data[i]);
+        p[i] = (v >> (i * 8)) & 0xFF;
     }
-    printf("\n");
 }
 
-/**
- * @brief 디버그용 유니코드 출력
- */
-static void debug_print_unicode(const char *label, unicode_t code)
+static void put_le64(byte_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        p[i] = (v >> (i * 8)) & 0xFF;
+    }
+}
+
+static uint16_t get_le16(const byte_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const byte_t *p)
+{
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--)
+    {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static uint64_t get_le64(const byte_t *p)
 {
-    printf("[DEBUG] %s: U+%04X\n", label, code);
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--)
+    {
+        v = (v << 8) | p[i];
+    }
+    return v;
 }
\ No newline at end of file
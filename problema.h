@@ -6,6 +6,13 @@
  * 프로블레마는 애니그마 알고리즘을 개선하고 AES 암호화 알고리즘과 결합한
  * 한글/영어 교차지원이 가능한 새로운 암호화 알고리즘입니다.
  * 해당 알고리즘은 보안전공 학부생의 실습 목적으로 제작되었으며, 실사용을 권장하지 않습니다.
+ *
+ * 스레드 안전성: 라이브러리에는 스레드 사이에 공유되는 변경 가능한 전역 상태가 없습니다.
+ * 디버그 출력 설정은 스레드마다 따로 두고, 추적 콜백은 컨텍스트마다 둡니다.
+ * 초기화가 끝난 컨텍스트는 읽기 전용 키 스케줄로 여러 스레드가 동시에 쓸 수 있으며,
+ * 이때 각 스레드는 자기 ProblemaCursor/ProblemaStream으로 암호화합니다. 컨텍스트 자체의
+ * 위치를 바꾸는 함수(problema_encrypt, problema_reset, problema_restore 등)는
+ * 한 컨텍스트를 한 스레드만 호출해야 합니다.
  */
 
 #ifndef PROBLEMA_H
@@ -14,6 +21,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdio.h>
 
 /* 상수 정의 */
 #define PROBLEMA_KEY_SIZE 32      // 256비트 키
@@ -22,6 +30,61 @@
 #define PROBLEMA_ROTOR_SIZE 65536 // 유니코드 기본 다국어 평면 크기
 #define PROBLEMA_NUM_ROUNDS 14    // 암호화 라운드 수
 #define PROBLEMA_SBOX_SIZE 256    // S-Box 크기
+#define PROBLEMA_NONCE_SIZE 16    // 메시지 논스 크기
+#define PROBLEMA_CACHE_LINE 64    // 테이블 정렬 단위 (바이트)
+#define PROBLEMA_HUGE_PAGE_SIZE (2 * 1024 * 1024) // 대용량(huge) 페이지 크기 (바이트)
+
+/* 컨텍스트 할당 플래그 */
+#define PROBLEMA_CONTEXT_HUGE_PAGES 0x1 // 테이블을 대용량(huge) 페이지로 할당 (madvise(MADV_HUGEPAGE))
+
+/* 메모리 영역 속성 (ProblemaMemoryRegionUsage.flags) */
+#define PROBLEMA_MEMORY_SHARED 0x1     // 초기화 후 읽기 전용이라 커서/스트림/배치 스레드가 함께 읽음
+#define PROBLEMA_MEMORY_LAZY 0x2       // 처음 사용할 때 채워짐 (초기화 때는 자리만 차지)
+#define PROBLEMA_MEMORY_HUGE_PAGES 0x4 // 대용량(huge) 페이지를 요청한 할당 안에 있음
+
+/* 추적 훅과 [DEBUG] 출력 컴파일 여부 (기본: NDEBUG를 정의한 릴리스 빌드에서는 완전히 제거,
+   -DPROBLEMA_TRACE=1 또는 0으로 직접 정할 수 있음. 라이브러리와 응용 프로그램을 같은 값으로 빌드) */
+#ifndef PROBLEMA_TRACE
+#ifdef NDEBUG
+#define PROBLEMA_TRACE 0
+#else
+#define PROBLEMA_TRACE 1
+#endif
+#endif
+
+/* 성능 카운터 컴파일 여부 (기본은 제거, -DPROBLEMA_STATS=1로 빌드해야 problema_set_stats가 동작) */
+#ifndef PROBLEMA_STATS
+#define PROBLEMA_STATS 0
+#endif
+
+/* 비동기 추적 싱크 */
+#define PROBLEMA_LOG_SINK_BLOCK 0x1        // 링 버퍼가 가득 차면 버리지 않고 빌 때까지 대기
+#define PROBLEMA_LOG_SINK_MAX_THREADS 64   // 싱크 하나에 동시에 기록할 수 있는 스레드 수
+
+/* 타임라인 (Chrome/Perfetto 추적 이벤트 JSON) */
+#define PROBLEMA_TIMELINE_MAX_THREADS 256  // 타임라인 하나에 기록할 수 있는 스레드 수
+
+/* 블록 변환 프로필 */
+#define PROBLEMA_BLOCK_PROFILE_COMPAT 0 // 1라운드 간소화 변환 (기존 problema_encrypt_block 동작)
+#define PROBLEMA_BLOCK_PROFILE_FULL 1   // 키 기반 S-Box로 전체 라운드를 도는 T-테이블 변환
+#define PROBLEMA_BLOCK_PROFILE_AES 2    // 마스터 키로 확장한 표준 AES-256 (AES-NI 또는 같은 결과의 T-테이블)
+
+/* 카운터 모드 */
+#define PROBLEMA_CTR_NONCE_SIZE 8 // 카운터 블록 앞 8바이트 (뒤 8바이트는 빅엔디언 블록 번호)
+
+/* 컨테이너 형식 상수 */
+#define PROBLEMA_CONTAINER_VERSION 1          // 컨테이너 형식 버전
+#define PROBLEMA_CONTAINER_HEADER_SIZE 40     // 파일 헤더 크기 (바이트)
+#define PROBLEMA_CHUNK_HEADER_SIZE 40         // 청크 헤더 크기 (바이트)
+#define PROBLEMA_CONTAINER_FOOTER_SIZE 16     // 푸터 크기 (바이트)
+#define PROBLEMA_DEFAULT_CHUNK_CHARS 65536    // 기본 청크 크기 (문자)
+#define PROBLEMA_MAX_CHUNK_CHARS (UINT32_MAX / 4) // 최대 청크 크기 (문자, 페이로드 길이가 32비트에 들어가는 한도)
+#define PROBLEMA_PROFILE_CHAR 1               // 문자 단위 로터 암호 (problema_encrypt 호환)
+#define PROBLEMA_DEFAULT_INDEX_INTERVAL 65536 // 탐색 인덱스 체크포인트 간격 (문자)
+
+/* 스트림 체크포인트 형식 상수 */
+#define PROBLEMA_CHECKPOINT_VERSION 1 // 체크포인트 형식 버전
+#define PROBLEMA_CHECKPOINT_SIZE 64   // 직렬화된 체크포인트 크기 (바이트)
 
 /* 오류 코드 */
 #define PROBLEMA_SUCCESS 0
@@ -30,6 +93,12 @@
 #define PROBLEMA_ERROR_NOT_INITIALIZED -3
 #define PROBLEMA_ERROR_BUFFER_TOO_SMALL -4
 #define PROBLEMA_ERROR_INVALID_UTF8 -5
+#define PROBLEMA_ERROR_INVALID_FORMAT -6
+#define PROBLEMA_ERROR_KEY_MISMATCH -7
+#define PROBLEMA_ERROR_OUT_OF_MEMORY -8
+#define PROBLEMA_ERROR_OUT_OF_RANGE -9
+#define PROBLEMA_ERROR_INVALID_PROFILE -10
+#define PROBLEMA_ERROR_IO -11
 
 /* 타입 정의 */
 typedef uint8_t byte_t;
@@ -40,7 +109,7 @@ typedef uint32_t unicode_t;
  */
 typedef struct
 {
-    unicode_t mapping[PROBLEMA_ROTOR_SIZE]; // 로터 매핑 테이블
+    _Alignas(PROBLEMA_CACHE_LINE) unicode_t mapping[PROBLEMA_ROTOR_SIZE]; // 로터 매핑 테이블
     int position;                           // 현재 로터 위치
     int notch_positions[8];                 // 노치 위치 (다음 로터 회전 트리거)
     int num_notches;                        // 노치 개수
@@ -51,7 +120,7 @@ typedef struct
  */
 typedef struct
 {
-    unicode_t mapping[PROBLEMA_ROTOR_SIZE]; // 플러그보드 매핑 테이블
+    _Alignas(PROBLEMA_CACHE_LINE) unicode_t mapping[PROBLEMA_ROTOR_SIZE]; // 플러그보드 매핑 테이블
 } ProblemaPlugboard;
 
 /**
@@ -62,8 +131,119 @@ typedef struct
     byte_t sbox[PROBLEMA_SBOX_SIZE];                                 // S-Box
     byte_t inv_sbox[PROBLEMA_SBOX_SIZE];                             // 역 S-Box
     byte_t round_keys[PROBLEMA_NUM_ROUNDS + 1][PROBLEMA_BLOCK_SIZE]; // 라운드 키
+    uint32_t enc_tables[4][PROBLEMA_SBOX_SIZE];                      // SubBytes + ShiftRows + MixColumns 결합 테이블
+    uint32_t dec_tables[4][PROBLEMA_SBOX_SIZE];                      // 역변환 결합 테이블
+    uint32_t enc_keys[PROBLEMA_NUM_ROUNDS + 1][4];                   // 암호화 라운드 키 (열 단위 워드)
+    uint32_t dec_keys[PROBLEMA_NUM_ROUNDS + 1][4];                   // 복호화 라운드 키 (InvMixColumns 적용)
+    byte_t inv_round_keys[PROBLEMA_NUM_ROUNDS + 1][PROBLEMA_BLOCK_SIZE]; // dec_keys의 바이트 배열 (AES-NI aesdec용)
 } ProblemaAES;
 
+/**
+ * @brief 추적 단계
+ */
+typedef enum
+{
+    PROBLEMA_TRACE_MESSAGE,         // 단계 설명 (label)
+    PROBLEMA_TRACE_CHAR_IN,         // 문자 처리 전 (code)
+    PROBLEMA_TRACE_PLUGBOARD,       // 플러그보드 적용 후 (code)
+    PROBLEMA_TRACE_ROTORS_FORWARD,  // 순방향 로터 적용 후 (code, positions)
+    PROBLEMA_TRACE_ROTORS_BACKWARD, // 역방향 로터 적용 후 (code, positions)
+    PROBLEMA_TRACE_CHAR_OUT,        // 문자 처리 후 (code, positions)
+    PROBLEMA_TRACE_ROTOR_STEP,      // 로터 회전 후 (positions)
+    PROBLEMA_TRACE_BLOCK_IN,        // 블록 처리 전 (block)
+    PROBLEMA_TRACE_BLOCK_STAGE,     // 블록 변환 중간 단계 (block)
+    PROBLEMA_TRACE_BLOCK_OUT,       // 블록 처리 후 (block)
+    PROBLEMA_TRACE_UTF8_DECODED,    // 입력 디코딩 완료 (bytes, chars)
+    PROBLEMA_TRACE_INVALID_UTF8     // 유효하지 않은 UTF-8 (code = 시작 바이트)
+} ProblemaTraceStage;
+
+/**
+ * @brief 추적 이벤트
+ *
+ * 포인터 필드는 콜백이 반환할 때까지만 유효합니다.
+ */
+typedef struct
+{
+    ProblemaTraceStage stage; // 단계
+    const char *label;        // 단계 이름 (기존 디버그 출력 문구)
+    unicode_t code;           // 코드 포인트 (문자 단계)
+    const int *positions;     // 로터 위치 PROBLEMA_NUM_ROTORS개 (없으면 NULL)
+    const byte_t *block;      // 블록 상태 PROBLEMA_BLOCK_SIZE 바이트 (없으면 NULL)
+    uint64_t bytes;           // 바이트 수 (PROBLEMA_TRACE_UTF8_DECODED)
+    uint64_t chars;           // 문자 수 (PROBLEMA_TRACE_UTF8_DECODED)
+} ProblemaTraceEvent;
+
+/**
+ * @brief 추적 콜백
+ */
+typedef void (*ProblemaTraceCallback)(const ProblemaTraceEvent *event, void *user);
+
+/**
+ * @brief 단계별 시간 측정 구간
+ */
+typedef enum
+{
+    PROBLEMA_STAT_DECODE,    // UTF-8 디코딩
+    PROBLEMA_STAT_PLUGBOARD, // 플러그보드
+    PROBLEMA_STAT_ROTORS,    // 순방향/역방향 로터와 로터 회전
+    PROBLEMA_STAT_FEEDBACK,  // 피드백 적용
+    PROBLEMA_STAT_ENCODE,    // UTF-8 인코딩
+    PROBLEMA_STAT_BLOCK,     // 블록 API 전체
+    PROBLEMA_STAT_STAGES     // 구간 수
+} ProblemaStatStage;
+
+/**
+ * @brief 핫 패스 성능 카운터
+ *
+ * cycles는 x86에서는 TSC 틱, 그 밖의 플랫폼에서는 나노초입니다. 문자 단계 구간은
+ * 시각 읽기 비용을 줄이려고 64문자마다 한 문자만 재서 64배한 추정값입니다.
+ */
+typedef struct
+{
+    uint64_t chars;                                // 처리한 문자 수
+    uint64_t blocks;                               // 블록 API로 처리한 블록 수
+    uint64_t rotor_bypass;                         // PROBLEMA_ROTOR_SIZE 이상이라 로터를 건너뛴 문자 수
+    uint64_t rotor_steps[PROBLEMA_NUM_ROTORS];     // 로터별 회전 수 ([0]은 문자마다, 나머지는 노치 연쇄)
+    uint64_t plugboard_hits;                       // 플러그보드가 다른 문자로 바꾼 횟수
+    uint64_t utf8_decoded[4];                      // 디코딩한 문자 수 (인덱스 = 바이트 길이 - 1)
+    uint64_t utf8_encoded[4];                      // 인코딩한 문자 수 (인덱스 = 바이트 길이 - 1)
+    uint64_t cycles[PROBLEMA_STAT_STAGES];         // 구간별 누적 시간
+} ProblemaStats;
+
+/**
+ * @brief 비동기 추적 싱크 (불투명 타입)
+ */
+typedef struct ProblemaLogSink ProblemaLogSink;
+
+/**
+ * @brief 비동기 추적 싱크 통계
+ */
+typedef struct
+{
+    uint64_t recorded;    // 링 버퍼에 기록한 이벤트 수
+    uint64_t sampled_out; // 표본 추출로 건너뛴 이벤트 수
+    uint64_t dropped;     // 링 버퍼가 가득 차거나 스레드 수를 넘어 버린 이벤트 수
+    uint64_t written;     // 배경 스레드가 출력한 이벤트 수
+    size_t threads;       // 링 버퍼 수 (끝난 스레드의 링은 다음 스레드가 이어 쓴다)
+} ProblemaLogSinkStats;
+
+/**
+ * @brief 스레드별 구간 타임라인 (불투명 타입)
+ */
+typedef struct ProblemaTimeline ProblemaTimeline;
+
+/**
+ * @brief 사용자 정의 메모리 할당자
+ *
+ * alloc은 alignment 바이트 경계에 정렬된 메모리를 돌려주어야 합니다.
+ */
+typedef struct
+{
+    void *(*alloc)(size_t size, size_t alignment, void *user); // 할당 함수
+    void (*free)(void *ptr, size_t size, void *user);          // 해제 함수
+    void *user;                                                // 사용자 데이터
+} ProblemaAllocator;
+
 /**
  * @brief 프로블레마 컨텍스트 구조체
  */
@@ -73,18 +253,201 @@ typedef struct
     ProblemaRotor inverse_rotors[PROBLEMA_NUM_ROTORS]; // 역방향 로터 배열
     ProblemaPlugboard plugboard;                       // 플러그보드
     ProblemaAES aes;                                   // AES 컴포넌트
+    ProblemaAES aes_std;                               // 표준 AES-256 컴포넌트 (PROBLEMA_BLOCK_PROFILE_AES)
     byte_t key[PROBLEMA_KEY_SIZE];                     // 마스터 키
     byte_t feedback[PROBLEMA_BLOCK_SIZE];              // 피드백 상태
     byte_t initial_feedback[PROBLEMA_BLOCK_SIZE];      // 초기 피드백 상태 (복호화용)
     bool encrypt_mode;                                 // 암호화 모드 플래그
     bool initialized;                                  // 초기화 상태
+    int block_profile;                                 // 블록 변환 프로필 (PROBLEMA_BLOCK_PROFILE_*)
+    ProblemaTraceCallback trace;                       // 추적 콜백 (NULL이면 추적 안 함)
+    bool stats_enabled;                                // 성능 카운터 수집 여부
+    void *trace_user;                                  // 추적 콜백 사용자 데이터
+    ProblemaTimeline *timeline;                        // 구간 타임라인 (NULL이면 기록 안 함)
+    ProblemaAllocator allocator;                       // 힙 컨텍스트 할당자 (problema_context_new)
+    size_t alloc_size;                                 // 힙 컨텍스트 할당 크기 (스택 컨텍스트는 0)
+    bool huge_pages;                                   // 대용량(huge) 페이지 요청 성공 여부
 } ProblemaContext;
 
+/**
+ * @brief 컨테이너 헤더 정보
+ */
+typedef struct
+{
+    uint16_t version;         // 형식 버전
+    uint16_t profile;         // 암호 프로파일
+    uint64_t key_fingerprint; // 키 지문
+    uint32_t chunk_chars;     // 청크당 문자 수
+    uint64_t total_chars;     // 전체 문자 수
+    uint64_t num_chunks;      // 청크 개수
+    uint64_t index_offset;    // 청크 인덱스 위치 (바이트)
+} ProblemaContainerInfo;
+
+/**
+ * @brief 컨테이너 청크 정보
+ *
+ * 청크 시작 시점의 로터 위치와 피드백 워드를 담고 있으므로
+ * 각 청크는 앞선 청크와 무관하게 복호화할 수 있습니다.
+ */
+typedef struct
+{
+    uint64_t start_char;                      // 시작 문자 인덱스
+    int rotor_positions[PROBLEMA_NUM_ROTORS]; // 시작 로터 위치
+    unicode_t feedback;                       // 진입 피드백 워드 (직전 암호문 문자)
+    uint32_t num_chars;                       // 청크 문자 수
+    uint32_t byte_length;                     // 페이로드 길이 (바이트)
+    uint64_t payload_offset;                  // 페이로드 위치 (바이트)
+} ProblemaChunkInfo;
+
+/**
+ * @brief 탐색 인덱스 체크포인트 (문자 인덱스, 바이트 위치)
+ */
+typedef struct
+{
+    uint64_t char_index;  // 문자 인덱스
+    uint64_t byte_offset; // 해당 문자의 시작 바이트 위치
+} ProblemaIndexEntry;
+
+/**
+ * @brief 암호문 탐색 인덱스
+ *
+ * interval 문자마다 체크포인트를 하나씩 둡니다 (entries[k].char_index == k * interval).
+ */
+typedef struct
+{
+    ProblemaIndexEntry *entries; // 체크포인트 배열
+    size_t num_entries;          // 체크포인트 개수
+    uint64_t interval;           // 체크포인트 간격 (문자)
+    uint64_t total_chars;        // 전체 문자 수
+    uint64_t total_bytes;        // 전체 길이 (바이트)
+} ProblemaSeekIndex;
+
+/**
+ * @brief 배치 메시지 서술자
+ *
+ * nonce가 NULL이면 키에서 유도한 시작 상태를 사용하므로, 새로 초기화한 컨텍스트로
+ * problema_encrypt / problema_decrypt 한 결과와 같습니다.
+ */
+typedef struct
+{
+    const byte_t *input; // 입력 데이터
+    size_t input_len;    // 입력 길이 (바이트)
+    byte_t *output;      // 출력 버퍼
+    size_t output_size;  // 출력 버퍼 크기
+    const byte_t *nonce; // 논스 (PROBLEMA_NONCE_SIZE 바이트, NULL 가능)
+    size_t output_len;   // [출력] 실제 출력 길이 (바이트)
+    int status;          // [출력] 메시지별 결과 코드 (PROBLEMA_SUCCESS 또는 PROBLEMA_ERROR_*)
+} ProblemaBatchItem;
+
+/**
+ * @brief 배치 처리용 스레드 풀 (불투명 타입)
+ */
+typedef struct ProblemaThreadPool ProblemaThreadPool;
+
+/**
+ * @brief 초기화된 컨텍스트를 재사용하는 컨텍스트 풀 (불투명 타입)
+ */
+typedef struct ProblemaContextPool ProblemaContextPool;
+
+/**
+ * @brief 컨텍스트 풀 통계
+ */
+typedef struct
+{
+    uint64_t acquires; // 대여 횟수
+    uint64_t hits;     // 풀에 있던 컨텍스트로 처리한 대여 횟수
+    uint64_t misses;   // 새로 초기화한 대여 횟수
+    uint64_t releases; // 반납 횟수
+    uint64_t discards; // 풀이 가득 차 해제한 반납 횟수
+    size_t capacity;   // 풀 용량
+    size_t idle;       // 현재 풀에 있는 컨텍스트 수
+} ProblemaPoolStats;
+
+/**
+ * @brief 메모리 영역
+ */
+typedef enum
+{
+    PROBLEMA_MEMORY_ROTORS,         // 순방향 로터 매핑과 노치
+    PROBLEMA_MEMORY_INVERSE_ROTORS, // 역방향 로터 매핑
+    PROBLEMA_MEMORY_PLUGBOARD,      // 플러그보드 매핑
+    PROBLEMA_MEMORY_SBOXES,         // S-Box와 역 S-Box (블록 변환, 표준 AES)
+    PROBLEMA_MEMORY_ROUND_KEYS,     // 라운드 키 (바이트 배열과 열 단위 워드)
+    PROBLEMA_MEMORY_CACHES,         // 블록 변환 결합 테이블 (T-테이블)
+    PROBLEMA_MEMORY_STATE,          // 키, 피드백, 설정 등 가변 상태와 정렬 여백
+    PROBLEMA_MEMORY_SCRATCH,        // 호출 스레드의 라이브러리 작업 공간 (성능 카운터 등)
+    PROBLEMA_MEMORY_REGIONS         // 영역 수
+} ProblemaMemoryRegion;
+
+/**
+ * @brief 메모리 영역 하나의 사용량
+ */
+typedef struct
+{
+    size_t bytes;   // 바이트 수
+    unsigned flags; // PROBLEMA_MEMORY_* 속성
+} ProblemaMemoryRegionUsage;
+
+/**
+ * @brief 컨텍스트 메모리 사용량
+ */
+typedef struct
+{
+    ProblemaMemoryRegionUsage regions[PROBLEMA_MEMORY_REGIONS]; // 영역별 사용량
+    size_t context_bytes;   // 컨텍스트 크기 (SCRATCH를 뺀 영역의 합)
+    size_t allocated_bytes; // 실제 할당 크기 (대용량(huge) 페이지 단위 올림 포함, 스택 컨텍스트는 context_bytes)
+    size_t shared_bytes;    // PROBLEMA_MEMORY_SHARED 영역의 합 (키 하나당 한 번만 드는 양)
+} ProblemaMemoryUsage;
+
+/**
+ * @brief 컨텍스트의 가변 상태 (고정 크기 POD)
+ *
+ * 테이블을 제외한 로터 위치, 피드백, 모드만 담으므로 값으로 복사해 저장하거나
+ * 되돌릴 수 있습니다.
+ */
+typedef struct
+{
+    int positions[PROBLEMA_NUM_ROTORS];             // 로터 위치
+    byte_t feedback[PROBLEMA_BLOCK_SIZE];           // 피드백 블록
+    byte_t initial_feedback[PROBLEMA_BLOCK_SIZE];   // 초기 피드백 블록
+    bool encrypt_mode;                              // 암호화 모드 여부
+} ProblemaState;
+
+/**
+ * @brief 컨텍스트 테이블을 공유하는 가벼운 복제본
+ *
+ * schedule의 테이블은 읽기만 하고 가변 상태는 state에 둡니다. 같은 스케줄 위의
+ * 커서는 스레드마다 따로 사용할 수 있으며, state를 복사하면 되돌릴 지점이 됩니다.
+ */
+typedef struct
+{
+    const ProblemaContext *schedule; // 공유 스케줄 (읽기 전용)
+    ProblemaState state;             // 커서 상태
+} ProblemaCursor;
+
+/**
+ * @brief 여러 조각으로 나누어 처리하는 스트림
+ *
+ * problema_encrypt / problema_decrypt 한 번과 같은 결과를 조각 단위로 만들며,
+ * 조각 경계에서 피드백을 이어 갑니다. 진행 위치를 함께 기록하므로 체크포인트로
+ * 저장했다가 이어서 처리할 수 있습니다.
+ */
+typedef struct
+{
+    ProblemaCursor cursor;  // 커서 (state.encrypt_mode가 처리 방향)
+    uint64_t char_index;    // 지금까지 처리한 문자 수
+    uint64_t input_offset;  // 지금까지 소비한 입력 바이트 수
+    uint64_t output_offset; // 지금까지 만든 출력 바이트 수
+} ProblemaStream;
+
 /* 함수 선언 */
 
 /**
  * @brief 프로블레마 컨텍스트 초기화
  *
+ * 직접 선언한 컨텍스트의 할당 정보(alloc_size, huge_pages)를 비웁니다.
+ * problema_context_new로 만든 컨텍스트는 다시 초기화하지 말고 problema_reset으로 되돌리십시오.
+ *
  * @param ctx 초기화할 프로블레마 컨텍스트
  * @param key 256비트(32바이트) 키
  * @return int 성공 시 0, 실패 시 오류 코드
@@ -98,6 +461,221 @@ int problema_init(ProblemaContext *ctx, const byte_t *key);
  */
 void problema_cleanup(ProblemaContext *ctx);
 
+/**
+ * @brief 힙에 컨텍스트를 할당하고 초기화
+ *
+ * 컨텍스트는 4MB가 넘으므로 스택 대신 이 함수를 사용하십시오. 테이블은 캐시 라인에
+ * 정렬되며, PROBLEMA_CONTEXT_HUGE_PAGES를 주면 대용량(huge) 페이지 경계에 할당한 뒤
+ * madvise(MADV_HUGEPAGE)를 요청하여 무작위 테이블 접근의 TLB 미스를 줄입니다.
+ *
+ * @param out 생성된 컨텍스트
+ * @param key 256비트(32바이트) 키
+ * @param allocator 메모리 할당자 (NULL이면 기본 할당자)
+ * @param flags PROBLEMA_CONTEXT_* 플래그
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_context_new(ProblemaContext **out, const byte_t *key,
+                         const ProblemaAllocator *allocator, unsigned flags);
+
+/**
+ * @brief problema_context_new로 만든 컨텍스트 정리 및 해제
+ *
+ * @param ctx 해제할 프로블레마 컨텍스트
+ */
+void problema_context_free(ProblemaContext *ctx);
+
+/**
+ * @brief 컨텍스트를 키에서 유도한 시작 상태로 되돌림
+ *
+ * 테이블은 다시 만들지 않고 로터 위치와 피드백, 모드를 되돌리고 블록 프로필, 추적 콜백,
+ * 타임라인, 통계 설정을 기본값으로 돌리므로 비용은 O(로터 수)입니다.
+ * 결과는 같은 키로 problema_init을 다시 호출한 것과 같습니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_reset(ProblemaContext *ctx);
+
+/**
+ * @brief 컨텍스트가 차지하는 메모리를 영역별로 조회
+ *
+ * 키 하나를 쓰는 스레드가 여럿이어도 SHARED 영역은 한 번만 들고, 스레드마다
+ * ProblemaCursor(sizeof(ProblemaCursor))와 SCRATCH 영역이 더 듭니다.
+ * 할당 크기와 대용량(huge) 페이지 여부는 problema_context_new로 만든 컨텍스트 기준이며,
+ * 직접 선언한 컨텍스트의 allocated_bytes는 context_bytes와 같습니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param usage [출력] 영역별 사용량
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_memory_usage(const ProblemaContext *ctx, ProblemaMemoryUsage *usage);
+
+/**
+ * @brief 같은 키의 컨텍스트 풀 생성
+ *
+ * 요청마다 컨텍스트를 초기화하는 대신 풀에서 빌리고 반납합니다. 대여와 반납은
+ * 원자적 슬롯 배열만 사용하므로 잠금이 없으며, 풀이 비었을 때만 새 컨텍스트를 초기화합니다.
+ *
+ * @param key 256비트(32바이트) 키
+ * @param capacity 풀에 보관할 최대 컨텍스트 수
+ * @param prewarm 미리 초기화해 둘 컨텍스트 수 (capacity 이하)
+ * @param allocator 메모리 할당자 (NULL이면 기본 할당자)
+ * @param flags PROBLEMA_CONTEXT_* 플래그
+ * @return ProblemaContextPool* 생성된 풀, 실패 시 NULL
+ */
+ProblemaContextPool *problema_context_pool_create(const byte_t *key, size_t capacity, size_t prewarm,
+                                                  const ProblemaAllocator *allocator, unsigned flags);
+
+/**
+ * @brief 컨텍스트 풀 해제
+ *
+ * 풀에 있는 컨텍스트를 모두 해제합니다. 대여 중인 컨텍스트는 먼저 반납해야 합니다.
+ *
+ * @param pool 해제할 컨텍스트 풀
+ */
+void problema_context_pool_destroy(ProblemaContextPool *pool);
+
+/**
+ * @brief 풀에서 시작 상태의 컨텍스트를 빌림
+ *
+ * @param pool 컨텍스트 풀
+ * @param ctx [출력] 빌린 컨텍스트
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_context_pool_acquire(ProblemaContextPool *pool, ProblemaContext **ctx);
+
+/**
+ * @brief 빌린 컨텍스트를 시작 상태로 되돌려 풀에 반납
+ *
+ * 풀이 가득 차 있으면 컨텍스트를 해제합니다.
+ *
+ * @param pool 컨텍스트 풀
+ * @param ctx 반납할 컨텍스트
+ */
+void problema_context_pool_release(ProblemaContextPool *pool, ProblemaContext *ctx);
+
+/**
+ * @brief 컨텍스트 풀 통계 조회
+ *
+ * @param pool 컨텍스트 풀
+ * @param stats [출력] 통계
+ */
+void problema_context_pool_stats(ProblemaContextPool *pool, ProblemaPoolStats *stats);
+
+/**
+ * @brief 컨텍스트의 가변 상태 저장
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param state [출력] 저장된 상태
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_snapshot(const ProblemaContext *ctx, ProblemaState *state);
+
+/**
+ * @brief 저장한 상태로 컨텍스트 되돌림
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param state 되돌릴 상태
+ * @return int 성공 시 0, 실패 시 오류 코드 (로터 위치가 범위를 벗어나면 PROBLEMA_ERROR_OUT_OF_RANGE)
+ */
+int problema_restore(ProblemaContext *ctx, const ProblemaState *state);
+
+/**
+ * @brief 컨텍스트의 현재 상태에서 커서 복제
+ *
+ * 4MB 테이블은 복사하지 않고 ctx를 가리킵니다. 커서를 쓰는 동안 ctx를 해제하면 안 됩니다.
+ *
+ * @param cursor [출력] 커서
+ * @param ctx 공유할 프로블레마 컨텍스트
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_cursor_init(ProblemaCursor *cursor, const ProblemaContext *ctx);
+
+/**
+ * @brief 커서로 UTF-8 문자열 암호화 (problema_encrypt와 같은 규칙)
+ *
+ * @param cursor 커서
+ * @param input 입력 UTF-8 문자열
+ * @param input_len 입력 길이
+ * @param output 출력 버퍼
+ * @param output_size 출력 버퍼 크기
+ * @param output_len 실제 출력 길이
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_cursor_encrypt(ProblemaCursor *cursor, const byte_t *input, size_t input_len,
+                            byte_t *output, size_t output_size, size_t *output_len);
+
+/**
+ * @brief 커서로 UTF-8 문자열 복호화 (problema_decrypt와 같은 규칙)
+ *
+ * @param cursor 커서
+ * @param input 입력 UTF-8 문자열
+ * @param input_len 입력 길이
+ * @param output 출력 버퍼
+ * @param output_size 출력 버퍼 크기
+ * @param output_len 실제 출력 길이
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_cursor_decrypt(ProblemaCursor *cursor, const byte_t *input, size_t input_len,
+                            byte_t *output, size_t output_size, size_t *output_len);
+
+/**
+ * @brief 컨텍스트의 현재 로터 위치에서 스트림 시작
+ *
+ * @param stream [출력] 스트림
+ * @param ctx 공유할 프로블레마 컨텍스트
+ * @param encrypt 암호화이면 true, 복호화이면 false
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_stream_init(ProblemaStream *stream, const ProblemaContext *ctx, bool encrypt);
+
+/**
+ * @brief 스트림에 입력 조각 하나 처리
+ *
+ * 조각 끝에서 잘린 UTF-8 문자는 소비하지 않고 남기므로, 호출자는 input[*consumed..]를
+ * 다음 조각 앞에 붙여야 합니다. 출력 버퍼가 부족하면 상태를 바꾸지 않고
+ * PROBLEMA_ERROR_BUFFER_TOO_SMALL을 반환하며 output_len에 필요한 크기를 담습니다.
+ *
+ * @param stream 스트림
+ * @param input 입력 조각
+ * @param input_len 입력 조각 길이
+ * @param output 출력 버퍼 (problema_output_bound(input_len)이면 충분)
+ * @param output_size 출력 버퍼 크기
+ * @param output_len 실제 출력 길이
+ * @param consumed 소비한 입력 바이트 수
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_stream_update(ProblemaStream *stream, const byte_t *input, size_t input_len,
+                           byte_t *output, size_t output_size, size_t *output_len,
+                           size_t *consumed);
+
+/**
+ * @brief 스트림 진행 상태를 체크포인트로 직렬화
+ *
+ * 체크포인트에는 키 지문, 방향, 문자 위치, 입력/출력 바이트 위치, 로터 위치와
+ * 피드백 워드가 들어갑니다 (리틀 엔디언, PROBLEMA_CHECKPOINT_SIZE 바이트).
+ *
+ * @param stream 스트림
+ * @param checkpoint [출력] PROBLEMA_CHECKPOINT_SIZE 바이트 버퍼
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_stream_checkpoint(const ProblemaStream *stream, byte_t *checkpoint);
+
+/**
+ * @brief 체크포인트에서 스트림 복원
+ *
+ * 복원 후에는 입력의 input_offset 바이트부터 이어서 처리하고, 출력은 output_offset
+ * 바이트 뒤에 이어 붙이면 중단 없이 처리한 결과와 같아집니다.
+ *
+ * @param stream [출력] 스트림
+ * @param ctx 공유할 프로블레마 컨텍스트 (체크포인트를 만든 키)
+ * @param checkpoint 체크포인트 데이터
+ * @param checkpoint_len 체크포인트 길이
+ * @return int 성공 시 0, 실패 시 오류 코드 (키가 다르면 PROBLEMA_ERROR_KEY_MISMATCH)
+ */
+int problema_stream_resume(ProblemaStream *stream, const ProblemaContext *ctx,
+                           const byte_t *checkpoint, size_t checkpoint_len);
+
 /**
  * @brief 단일 유니코드 문자 암호화
  *
@@ -134,6 +712,94 @@ void problema_encrypt_block(ProblemaContext *ctx, const byte_t *input, byte_t *o
  */
 void problema_decrypt_block(ProblemaContext *ctx, const byte_t *input, byte_t *output);
 
+/**
+ * @brief 블록 변환 프로필 선택
+ *
+ * 기본값은 기존 결과를 유지하는 PROBLEMA_BLOCK_PROFILE_COMPAT입니다.
+ * PROBLEMA_BLOCK_PROFILE_FULL은 키 기반 S-Box와 라운드 키로 PROBLEMA_NUM_ROUNDS 라운드를
+ * 모두 적용하며, 라운드마다 32비트 테이블 조회 16번과 XOR만 사용합니다.
+ * PROBLEMA_BLOCK_PROFILE_AES는 마스터 키를 AES-256 키로 쓰는 표준 AES이며, CPU가 지원하면
+ * AES-NI 명령을, 아니면 같은 결과를 내는 T-테이블 구현을 사용합니다.
+ * 프로필마다 암호문이 서로 호환되지 않습니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param profile PROBLEMA_BLOCK_PROFILE_* 값
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_set_block_profile(ProblemaContext *ctx, int profile);
+
+/**
+ * @brief 여러 블록을 한 번에 암호화
+ *
+ * problema_encrypt_block을 num_blocks 번 호출한 것과 같은 결과이며 피드백도 같게 갱신합니다.
+ * PROBLEMA_BLOCK_PROFILE_COMPAT 변환은 실행 중 CPU 기능에 따라 SIMD 커널(AVX2/SSSE3)을 사용합니다.
+ * input과 output은 같은 버퍼여도 됩니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param input 입력 블록들 (num_blocks * PROBLEMA_BLOCK_SIZE 바이트)
+ * @param output 출력 블록들 (num_blocks * PROBLEMA_BLOCK_SIZE 바이트)
+ * @param num_blocks 블록 수
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_encrypt_blocks(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                            size_t num_blocks);
+
+/**
+ * @brief 여러 블록을 한 번에 복호화
+ *
+ * problema_decrypt_block을 num_blocks 번 호출한 것과 같은 결과입니다. 블록마다 피드백이
+ * 직전 암호문 블록이므로 블록들을 서로 독립적으로 처리하며, AVX2 커널은 두 블록씩 처리합니다.
+ * input과 output은 같은 버퍼여도 됩니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param input 입력 블록들 (num_blocks * PROBLEMA_BLOCK_SIZE 바이트)
+ * @param output 출력 블록들 (num_blocks * PROBLEMA_BLOCK_SIZE 바이트)
+ * @param num_blocks 블록 수
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_decrypt_blocks(ProblemaContext *ctx, const byte_t *input, byte_t *output,
+                            size_t num_blocks);
+
+/**
+ * @brief 카운터 모드 암호화/복호화 (같은 함수가 두 방향 모두 처리)
+ *
+ * (논스 8바이트 || 빅엔디언 블록 번호 8바이트) 카운터 블록을 컨텍스트의 블록 프로필로
+ * 변환한 키스트림을 데이터와 XOR합니다. 피드백 사슬이 없고 컨텍스트를 읽기만 하므로
+ * 여러 스레드가 같은 컨텍스트로 서로 다른 블록 구간을 동시에 처리할 수 있으며,
+ * 임의의 블록 구간을 바로 복호화할 수 있습니다. 같은 키와 논스 조합은 한 메시지에만 사용하십시오.
+ * 키스트림이 카운터마다 달라야 하므로 PROBLEMA_BLOCK_PROFILE_FULL 또는
+ * PROBLEMA_BLOCK_PROFILE_AES 프로필이 필요하며, 기본값인 호환 프로필은 거부합니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param nonce 논스 (PROBLEMA_CTR_NONCE_SIZE 바이트)
+ * @param block_index input[0]이 속한 블록 번호 (메시지 시작에서 0)
+ * @param input 입력 데이터
+ * @param output 출력 데이터 (input과 같아도 됨)
+ * @param len 데이터 길이 (바이트, 블록 크기의 배수가 아니어도 됨)
+ * @return int 성공 시 0, 실패 시 오류 코드 (블록 번호가 넘치면 PROBLEMA_ERROR_OUT_OF_RANGE,
+ *             호환 프로필이면 PROBLEMA_ERROR_INVALID_PROFILE)
+ */
+int problema_ctr_crypt(const ProblemaContext *ctx, const byte_t *nonce, uint64_t block_index,
+                       const byte_t *input, byte_t *output, size_t len);
+
+/**
+ * @brief 다중 블록 API가 사용하는 커널 이름 ("avx2", "ssse3", "scalar")
+ *
+ * PROBLEMA_NO_SIMD를 정의해 빌드하면 SIMD 커널을 빼고 항상 "scalar"입니다.
+ *
+ * @return const char* 커널 이름
+ */
+const char *problema_block_kernel(void);
+
+/**
+ * @brief PROBLEMA_BLOCK_PROFILE_AES가 사용하는 구현 이름 ("aesni", "table")
+ *
+ * PROBLEMA_NO_SIMD 빌드에서는 항상 같은 결과를 내는 "table"입니다.
+ *
+ * @return const char* 구현 이름
+ */
+const char *problema_aes_kernel(void);
+
 /**
  * @brief UTF-8 문자열 암호화
  *
@@ -142,7 +808,7 @@ void problema_decrypt_block(ProblemaContext *ctx, const byte_t *input, byte_t *o
  * @param input_len 입력 문자열 길이 (바이트)
  * @param output 출력 버퍼
  * @param output_size 출력 버퍼 크기
- * @param output_len 실제 출력 길이 (바이트)
+ * @param output_len 실제 출력 길이 (바이트), PROBLEMA_ERROR_BUFFER_TOO_SMALL이면 필요한 길이
  * @return int 성공 시 0, 실패 시 오류 코드
  */
 int problema_encrypt(ProblemaContext *ctx, const byte_t *input, size_t input_len,
@@ -156,19 +822,511 @@ int problema_encrypt(ProblemaContext *ctx, const byte_t *input, size_t input_len
  * @param input_len 입력 데이터 길이 (바이트)
  * @param output 출력 버퍼
  * @param output_size 출력 버퍼 크기
- * @param output_len 실제 출력 길이 (바이트)
+ * @param output_len 실제 출력 길이 (바이트), PROBLEMA_ERROR_BUFFER_TOO_SMALL이면 필요한 길이
  * @return int 성공 시 0, 실패 시 오류 코드
  */
 int problema_decrypt(ProblemaContext *ctx, const byte_t *input, size_t input_len,
                      byte_t *output, size_t output_size, size_t *output_len);
 
+/**
+ * @brief 암호화/복호화 출력 크기의 상한
+ *
+ * 문자 하나는 최소 1바이트로 입력되고 최대 4바이트로 출력되므로 input_len * 4 입니다.
+ * 계산 없이 바로 알 수 있는 값이라 버퍼를 한 번에 할당할 때 사용합니다.
+ *
+ * @param input_len 입력 길이 (바이트)
+ * @return size_t 필요한 출력 버퍼 크기의 상한 (바이트)
+ */
+size_t problema_output_bound(size_t input_len);
+
+/**
+ * @brief problema_encrypt 출력의 정확한 길이
+ *
+ * 출력을 쓰지 않고 길이만 셉니다. 컨텍스트 상태는 바뀌지 않습니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param input 입력 UTF-8 문자열
+ * @param input_len 입력 문자열 길이 (바이트)
+ * @param required 필요한 출력 길이 (바이트)
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_encrypt_length(const ProblemaContext *ctx, const byte_t *input, size_t input_len,
+                            size_t *required);
+
+/**
+ * @brief problema_decrypt 출력의 정확한 길이
+ *
+ * 출력을 쓰지 않고 길이만 셉니다. 컨텍스트 상태는 바뀌지 않습니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param input 암호화된 데이터
+ * @param input_len 입력 데이터 길이 (바이트)
+ * @param required 필요한 출력 길이 (바이트)
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_decrypt_length(const ProblemaContext *ctx, const byte_t *input, size_t input_len,
+                            size_t *required);
+
+/**
+ * @brief 논스로 시작 상태를 정하는 메시지 단위 암호화
+ *
+ * 로터 시작 위치와 초기 피드백 워드를 키와 논스에서 유도하므로 컨텍스트 상태를
+ * 읽거나 바꾸지 않습니다. 초기화된 컨텍스트 하나를 읽기 전용 스케줄로 공유하면서
+ * 여러 스레드가 동시에 서로 다른 메시지를 처리할 수 있습니다.
+ * 같은 키에서 논스를 재사용하지 마십시오.
+ *
+ * @param ctx 프로블레마 컨텍스트 (테이블만 읽음)
+ * @param nonce 논스 (PROBLEMA_NONCE_SIZE 바이트)
+ * @param input 입력 UTF-8 문자열
+ * @param input_len 입력 문자열 길이 (바이트)
+ * @param output 출력 버퍼
+ * @param output_size 출력 버퍼 크기
+ * @param output_len 실제 출력 길이 (바이트)
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_encrypt_nonce(const ProblemaContext *ctx, const byte_t *nonce,
+                           const byte_t *input, size_t input_len,
+                           byte_t *output, size_t output_size, size_t *output_len);
+
+/**
+ * @brief 논스로 시작 상태를 정하는 메시지 단위 복호화
+ *
+ * @param ctx 프로블레마 컨텍스트 (테이블만 읽음)
+ * @param nonce 암호화에 사용한 논스 (PROBLEMA_NONCE_SIZE 바이트)
+ * @param input 암호화된 데이터
+ * @param input_len 입력 데이터 길이 (바이트)
+ * @param output 출력 버퍼
+ * @param output_size 출력 버퍼 크기
+ * @param output_len 실제 출력 길이 (바이트)
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_decrypt_nonce(const ProblemaContext *ctx, const byte_t *nonce,
+                           const byte_t *input, size_t input_len,
+                           byte_t *output, size_t output_size, size_t *output_len);
+
+/**
+ * @brief 배치 처리용 스레드 풀 생성
+ *
+ * @param num_threads 전체 작업 스레드 수 (호출 스레드 포함, 0이면 온라인 코어 수)
+ * @return ProblemaThreadPool* 생성된 풀, 실패 시 NULL
+ */
+ProblemaThreadPool *problema_thread_pool_create(int num_threads);
+
+/**
+ * @brief 스레드 풀 해제
+ *
+ * @param pool 해제할 스레드 풀
+ */
+void problema_thread_pool_destroy(ProblemaThreadPool *pool);
+
+/**
+ * @brief 같은 키의 여러 메시지를 스레드 풀에서 나누어 암호화
+ *
+ * 메시지는 스레드마다 연속 구간으로 나뉘고, 자기 구간을 끝낸 스레드는 다른 스레드
+ * 구간의 뒤쪽 절반을 가져갑니다 (작업 훔치기). 각 스레드는 자기 커서만 사용하고
+ * 컨텍스트는 읽기만 하므로 메시지 길이가 고르지 않아도 부하가 균형을 이룹니다.
+ * 풀 하나는 한 번에 배치 하나만 실행하므로, 여러 스레드가 같은 풀에 배치를 넘기면
+ * 먼저 넘긴 배치가 끝날 때까지 기다렸다가 차례로 실행됩니다.
+ *
+ * @param ctx 프로블레마 컨텍스트 (테이블만 읽음)
+ * @param pool 스레드 풀 (NULL이면 호출 스레드에서 처리)
+ * @param items 메시지 서술자 배열
+ * @param count 메시지 개수
+ * @return int 배치를 실행했으면 0 (메시지별 결과는 items[i].status), 인자 오류 시 오류 코드
+ */
+int problema_encrypt_batch(const ProblemaContext *ctx, ProblemaThreadPool *pool,
+                           ProblemaBatchItem *items, size_t count);
+
+/**
+ * @brief 같은 키의 여러 메시지를 스레드 풀에서 나누어 복호화
+ *
+ * 작업 분배와 같은 풀에 동시에 넘긴 배치의 처리 순서는 problema_encrypt_batch와 같습니다.
+ *
+ * @param ctx 프로블레마 컨텍스트 (테이블만 읽음)
+ * @param pool 스레드 풀 (NULL이면 호출 스레드에서 처리)
+ * @param items 메시지 서술자 배열
+ * @param count 메시지 개수
+ * @return int 배치를 실행했으면 0 (메시지별 결과는 items[i].status), 인자 오류 시 오류 코드
+ */
+int problema_decrypt_batch(const ProblemaContext *ctx, ProblemaThreadPool *pool,
+                           ProblemaBatchItem *items, size_t count);
+
+/**
+ * @brief 컨테이너 출력에 필요한 최대 크기
+ *
+ * @param input_len 입력 길이 (바이트)
+ * @param chunk_chars 청크당 문자 수 (0이면 기본값)
+ * @return size_t 필요한 출력 버퍼 크기 (바이트, 크기가 size_t를 넘으면 SIZE_MAX)
+ */
+size_t problema_container_bound(size_t input_len, uint32_t chunk_chars);
+
+/**
+ * @brief UTF-8 문자열을 청크 단위 컨테이너로 암호화
+ *
+ * 청크 페이로드를 이어 붙이면 problema_encrypt 결과와 같습니다. 이 호환성 때문에 청크의
+ * 진입 피드백은 앞 청크의 마지막 암호문 문자이고, 암호화는 청크 순서대로 진행됩니다.
+ * 청크마다 진입 상태가 기록되므로 복호화와 범위 복호화는 청크별로 나누어 병렬 처리할 수 있습니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param input 입력 UTF-8 문자열
+ * @param input_len 입력 문자열 길이 (바이트)
+ * @param chunk_chars 청크당 문자 수 (0이면 기본값, PROBLEMA_MAX_CHUNK_CHARS 이하)
+ * @param output 출력 버퍼
+ * @param output_size 출력 버퍼 크기
+ * @param output_len 실제 출력 길이 (바이트)
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_container_encrypt(ProblemaContext *ctx, const byte_t *input, size_t input_len,
+                               uint32_t chunk_chars, byte_t *output, size_t output_size,
+                               size_t *output_len);
+
+/**
+ * @brief 컨테이너 헤더와 인덱스 검증
+ *
+ * @param ctx 키 지문 확인용 컨텍스트 (NULL이면 확인 생략)
+ * @param data 컨테이너 데이터
+ * @param data_len 데이터 길이 (바이트)
+ * @param info 헤더 정보
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_container_open(const ProblemaContext *ctx, const byte_t *data, size_t data_len,
+                            ProblemaContainerInfo *info);
+
+/**
+ * @brief 인덱스로 청크 정보 조회 (스캔 없음)
+ *
+ * @param data 컨테이너 데이터
+ * @param data_len 데이터 길이 (바이트)
+ * @param info problema_container_open으로 얻은 헤더 정보
+ * @param chunk 청크 번호
+ * @param chunk_info 청크 정보
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_container_chunk(const byte_t *data, size_t data_len, const ProblemaContainerInfo *info,
+                             uint64_t chunk, ProblemaChunkInfo *chunk_info);
+
+/**
+ * @brief 단일 청크 복호화
+ *
+ * 컨텍스트의 테이블만 읽으므로 여러 스레드에서 청크를 나누어 호출할 수 있습니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param data 컨테이너 데이터
+ * @param data_len 데이터 길이 (바이트)
+ * @param chunk 청크 정보
+ * @param output 출력 버퍼
+ * @param output_size 출력 버퍼 크기
+ * @param output_len 실제 출력 길이 (바이트)
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_container_decrypt_chunk(const ProblemaContext *ctx, const byte_t *data, size_t data_len,
+                                     const ProblemaChunkInfo *chunk, byte_t *output,
+                                     size_t output_size, size_t *output_len);
+
+/**
+ * @brief 컨테이너 전체 복호화
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param data 컨테이너 데이터
+ * @param data_len 데이터 길이 (바이트)
+ * @param output 출력 버퍼
+ * @param output_size 출력 버퍼 크기
+ * @param output_len 실제 출력 길이 (바이트)
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_container_decrypt(const ProblemaContext *ctx, const byte_t *data, size_t data_len,
+                               byte_t *output, size_t output_size, size_t *output_len);
+
+/**
+ * @brief 컨테이너에서 문자 범위 복호화
+ *
+ * 청크 인덱스로 시작 청크를 찾고, 청크 안에서는 로터를 해당 위치로 바로 옮깁니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param data 컨테이너 데이터
+ * @param data_len 데이터 길이 (바이트)
+ * @param start_char 시작 문자 인덱스
+ * @param num_chars 복호화할 문자 수
+ * @param output 출력 버퍼
+ * @param output_size 출력 버퍼 크기
+ * @param output_len 실제 출력 길이 (바이트)
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_container_decrypt_range(const ProblemaContext *ctx, const byte_t *data, size_t data_len,
+                                     uint64_t start_char, uint64_t num_chars,
+                                     byte_t *output, size_t output_size, size_t *output_len);
+
+/**
+ * @brief 암호문 탐색 인덱스 생성
+ *
+ * 암호문을 한 번 훑어 interval 문자마다 (문자 인덱스, 바이트 위치)를 기록합니다.
+ * 인덱스는 problema_index_free로 해제합니다.
+ *
+ * @param data 암호화된 UTF-8 데이터
+ * @param data_len 데이터 길이 (바이트)
+ * @param interval 체크포인트 간격 (0이면 기본값)
+ * @param index 생성된 인덱스
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_index_build(const byte_t *data, size_t data_len, uint64_t interval,
+                         ProblemaSeekIndex *index);
+
+/**
+ * @brief 탐색 인덱스 해제
+ *
+ * @param index 해제할 인덱스
+ */
+void problema_index_free(ProblemaSeekIndex *index);
+
+/**
+ * @brief 암호문의 문자 범위 복호화
+ *
+ * 암호문은 새로 초기화된 컨텍스트로 problema_encrypt 한 결과라고 가정합니다.
+ * 시작 위치 앞의 가장 가까운 체크포인트에서 시작 문자까지만 훑고, 로터는 시작 인덱스로
+ * 바로 옮기며, 피드백 워드는 직전 암호문 문자에서 가져옵니다.
+ * 결과는 암호문 전체를 problema_decrypt 한 결과의 같은 구간과 같습니다.
+ *
+ * @param ctx 프로블레마 컨텍스트 (테이블만 읽음)
+ * @param data 암호화된 UTF-8 데이터
+ * @param data_len 데이터 길이 (바이트)
+ * @param index 탐색 인덱스 (NULL이면 처음부터 훑음)
+ * @param start_char 시작 문자 인덱스
+ * @param num_chars 복호화할 문자 수 (끝을 넘으면 끝까지)
+ * @param output 출력 버퍼
+ * @param output_size 출력 버퍼 크기
+ * @param output_len 실제 출력 길이 (바이트)
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_decrypt_range(const ProblemaContext *ctx, const byte_t *data, size_t data_len,
+                           const ProblemaSeekIndex *index, uint64_t start_char, uint64_t num_chars,
+                           byte_t *output, size_t output_size, size_t *output_len);
+
+/**
+ * @brief 암호문의 바이트 범위 복호화
+ *
+ * [byte_start, byte_start + byte_len) 안에서 시작하는 문자들을 복호화합니다.
+ *
+ * @param ctx 프로블레마 컨텍스트 (테이블만 읽음)
+ * @param data 암호화된 UTF-8 데이터
+ * @param data_len 데이터 길이 (바이트)
+ * @param index 탐색 인덱스 (NULL이면 처음부터 훑음)
+ * @param byte_start 시작 바이트 위치
+ * @param byte_len 범위 길이 (바이트)
+ * @param output 출력 버퍼
+ * @param output_size 출력 버퍼 크기
+ * @param output_len 실제 출력 길이 (바이트)
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_decrypt_byte_range(const ProblemaContext *ctx, const byte_t *data, size_t data_len,
+                                const ProblemaSeekIndex *index, uint64_t byte_start, uint64_t byte_len,
+                                byte_t *output, size_t output_size, size_t *output_len);
+
+/**
+ * @brief 키 지문 계산 (FNV-1a 64비트)
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @return uint64_t 키 지문
+ */
+uint64_t problema_key_fingerprint(const ProblemaContext *ctx);
+
 /**
  * @brief 암호화 과정 디버그 정보 출력 활성화/비활성화
  *
+ * 초기화 메시지와 UTF-8 변환 유틸리티의 출력을 켜고, 이후 초기화하는 컨텍스트에
+ * problema_trace_print 추적 콜백을 설치합니다. 이미 만든 컨텍스트는
+ * problema_set_trace로 켜십시오. 설정은 호출한 스레드에만 적용됩니다.
+ * NDEBUG 릴리스 빌드나 PROBLEMA_TRACE=0 빌드에서는 아무것도 출력하지 않습니다.
+ *
  * @param enable true: 활성화, false: 비활성화
  */
 void problema_set_debug(bool enable);
 
+/**
+ * @brief 컨텍스트의 단계별 추적 콜백 설정
+ *
+ * 콜백은 문자/블록 처리의 각 단계에서 단계 번호, 코드 포인트나 블록, 로터 위치를 담은
+ * 이벤트로 호출됩니다. 콜백이 없으면 단계마다 분기 하나만 실행하며, NDEBUG 릴리스 빌드나
+ * PROBLEMA_TRACE=0 빌드에서는 추적 코드가 모두 빠지고 콜백은 호출되지 않습니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param callback 추적 콜백 (NULL이면 끔)
+ * @param user 콜백에 넘길 사용자 데이터
+ */
+void problema_set_trace(ProblemaContext *ctx, ProblemaTraceCallback callback, void *user);
+
+/**
+ * @brief 추적 이벤트를 기존 [DEBUG] 형식으로 출력하는 기본 콜백
+ *
+ * 이벤트 한 줄은 스트림 잠금 안에서 출력되므로 여러 스레드의 출력이 줄 중간에 섞이지 않습니다.
+ *
+ * @param event 추적 이벤트
+ * @param user 출력할 FILE* (NULL이면 표준 출력)
+ */
+void problema_trace_print(const ProblemaTraceEvent *event, void *user);
+
+/**
+ * @brief 비동기 추적 싱크 생성
+ *
+ * 추적 이벤트를 스레드마다 따로 둔 잠금 없는 링 버퍼에 고정 크기 레코드로 기록하고,
+ * 배경 스레드가 problema_trace_print 형식으로 출력합니다.
+ * problema_set_trace(ctx, problema_log_sink_trace, sink)로 연결합니다.
+ *
+ * 표본 추출은 문자(PROBLEMA_TRACE_CHAR_IN)와 블록(PROBLEMA_TRACE_BLOCK_IN) 단위로 하며,
+ * 선택된 단위의 단계 이벤트는 모두 기록합니다. 입력 디코딩과 UTF-8 오류는 항상 기록합니다.
+ * 스레드가 끝나면 그 링 버퍼는 다음에 기록을 시작하는 스레드가 넘겨받으므로, 동시에 기록하는
+ * 스레드가 PROBLEMA_LOG_SINK_MAX_THREADS를 넘지 않으면 스레드를 계속 바꿔도 이벤트를 버리지 않습니다.
+ *
+ * @param out 출력 스트림 (NULL이면 표준 출력)
+ * @param capacity 스레드별 링 버퍼 레코드 수 (2의 거듭제곱으로 올림, 0이면 65536)
+ * @param sample_every N번째 단위마다 하나씩 기록 (0과 1은 모두 기록)
+ * @param flags PROBLEMA_LOG_SINK_BLOCK을 주면 가득 찬 버퍼에서 대기, 아니면 새 이벤트를 버림
+ * @return ProblemaLogSink* 싱크 (실패 시 NULL)
+ */
+ProblemaLogSink *problema_log_sink_create(FILE *out, size_t capacity, unsigned sample_every,
+                                          unsigned flags);
+
+/**
+ * @brief 비동기 추적 싱크 해제
+ *
+ * 남은 레코드를 모두 출력한 뒤 배경 스레드를 끝냅니다. 싱크에 기록하는 스레드가
+ * 모두 끝난 뒤 호출해야 합니다.
+ *
+ * @param sink 해제할 싱크
+ */
+void problema_log_sink_destroy(ProblemaLogSink *sink);
+
+/**
+ * @brief 지금까지 기록된 레코드가 모두 출력될 때까지 대기
+ *
+ * @param sink 추적 싱크
+ */
+void problema_log_sink_flush(ProblemaLogSink *sink);
+
+/**
+ * @brief 비동기 추적 싱크 통계 조회
+ *
+ * @param sink 추적 싱크
+ * @param stats [출력] 통계
+ */
+void problema_log_sink_stats(ProblemaLogSink *sink, ProblemaLogSinkStats *stats);
+
+/**
+ * @brief 추적 이벤트를 싱크의 링 버퍼에 기록하는 콜백
+ *
+ * 이벤트의 label은 레코드에 포인터로 남으므로 정적 문자열이어야 합니다
+ * (라이브러리가 만드는 이벤트는 모두 정적 문자열입니다).
+ *
+ * @param event 추적 이벤트
+ * @param user ProblemaLogSink*
+ */
+void problema_log_sink_trace(const ProblemaTraceEvent *event, void *user);
+
+/**
+ * @brief 구간 타임라인 생성
+ *
+ * 스레드마다 따로 둔 버퍼에 구간(시작 시각, 길이, 분류, 이름, 인자 하나)을 기록했다가
+ * problema_timeline_write로 Chrome/Perfetto 추적 이벤트 JSON을 씁니다.
+ * problema_set_timeline으로 컨텍스트에 연결하면 라이브러리가 호출, 청크, 배치 항목,
+ * 작업 훔치기, 작업자 대기 구간을 기록합니다. 버퍼가 가득 찬 스레드의 구간은 버립니다.
+ *
+ * @param capacity 스레드별 구간 수 (0이면 65536)
+ * @return ProblemaTimeline* 타임라인 (실패 시 NULL)
+ */
+ProblemaTimeline *problema_timeline_create(size_t capacity);
+
+/**
+ * @brief 구간 타임라인 해제
+ *
+ * @param timeline 해제할 타임라인
+ */
+void problema_timeline_destroy(ProblemaTimeline *timeline);
+
+/**
+ * @brief 컨텍스트에 구간 타임라인 연결
+ *
+ * 이 컨텍스트와 그 위의 커서, 스트림, 배치 처리가 구간을 기록합니다.
+ * NDEBUG 릴리스 빌드나 PROBLEMA_TRACE=0 빌드에서는 라이브러리 구간을 기록하지 않습니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param timeline 타임라인 (NULL이면 끔)
+ */
+void problema_set_timeline(ProblemaContext *ctx, ProblemaTimeline *timeline);
+
+/**
+ * @brief 타임라인 시각 (단조 시계 나노초)
+ *
+ * @return uint64_t 현재 시각
+ */
+uint64_t problema_timeline_clock(void);
+
+/**
+ * @brief 호출 스레드에 start부터 지금까지의 구간 기록
+ *
+ * category, name, arg_name은 포인터로 남으므로 정적 문자열이어야 합니다.
+ *
+ * @param timeline 타임라인 (NULL이면 무시)
+ * @param category 분류
+ * @param name 구간 이름
+ * @param start problema_timeline_clock으로 얻은 시작 시각
+ * @param arg_name 인자 이름 (NULL이면 인자 없음)
+ * @param arg 인자 값
+ */
+void problema_timeline_span(ProblemaTimeline *timeline, const char *category, const char *name,
+                            uint64_t start, const char *arg_name, uint64_t arg);
+
+/**
+ * @brief 호출 스레드의 타임라인 표시 이름 설정
+ *
+ * @param timeline 타임라인
+ * @param name 스레드 이름 (복사해 둠, 31바이트까지)
+ */
+void problema_timeline_thread_name(ProblemaTimeline *timeline, const char *name);
+
+/**
+ * @brief 기록한 구간을 Chrome/Perfetto 추적 이벤트 JSON으로 출력
+ *
+ * chrome://tracing이나 ui.perfetto.dev에서 열 수 있습니다. 버린 구간 수는
+ * otherData.dropped에 담깁니다. 기록하는 스레드가 모두 쉬고 있을 때 호출해야 합니다.
+ *
+ * @param timeline 타임라인
+ * @param out 출력 스트림
+ * @return int 성공 시 0, 쓰기 실패 시 PROBLEMA_ERROR_IO
+ */
+int problema_timeline_write(ProblemaTimeline *timeline, FILE *out);
+
+/**
+ * @brief 컨텍스트의 성능 카운터 수집 켜기/끄기
+ *
+ * 켜면 이 컨텍스트(와 그 위의 커서, 스트림, 배치)로 하는 처리가 호출 스레드의 카운터에
+ * 더해집니다. 끄면 카운터마다 분기 하나만 실행합니다. 카운터 코드는 라이브러리를
+ * -DPROBLEMA_STATS=1로 빌드했을 때만 들어가며, 기본 빌드에서는 켜도 카운터가 0으로 남습니다.
+ *
+ * @param ctx 프로블레마 컨텍스트
+ * @param enable true: 수집, false: 수집 안 함
+ */
+void problema_set_stats(ProblemaContext *ctx, bool enable);
+
+/**
+ * @brief 호출 스레드의 성능 카운터 조회
+ *
+ * 카운터는 컨텍스트가 아니라 스레드마다 하나씩 두고 동기화 없이 갱신합니다. 호출 스레드가
+ * 수집을 켠 모든 컨텍스트로 처리한 양이 함께 담기므로, 컨텍스트별로 나누어 보려면 사이사이
+ * problema_reset_stats를 호출하십시오. 배치 처리에서 풀의 보조 스레드가 처리한 양은 배치가
+ * 끝날 때 배치를 제출한 스레드의 카운터에 더해집니다. 직접 만든 여러 스레드의 값은
+ * 각 스레드에서 조회해 더하십시오.
+ *
+ * @param stats [출력] 카운터
+ * @return int 성공 시 0, 실패 시 오류 코드
+ */
+int problema_get_stats(ProblemaStats *stats);
+
+/**
+ * @brief 호출 스레드의 성능 카운터 초기화
+ *
+ * 호출 스레드의 카운터만 비우며, 다른 스레드의 카운터는 그대로 둡니다.
+ */
+void problema_reset_stats(void);
+
 /**
  * @brief 오류 코드에 대한 설명 문자열 반환
  *
@@ -0,0 +1,1108 @@
+/**
+ * @file problema_test.c
+ * @brief 프로블레마 회귀 테스트
+ *
+ * 손상된 입력과 재사용 경로처럼 CLI로는 재현하기 번거로운 경우를 확인합니다.
+ * 실패한 검사마다 위치를 출력하고, 하나라도 실패하면 1을 돌려줍니다.
+ *
+ * 빌드: gcc -O1 -g -fsanitize=address,undefined -DPROBLEMA_STATS=1 -DPROBLEMA_TRACE=1 -pthread -I.
+ *       -o problema_test tests/problema_test.c problema.c
+ * 경합 검사: 같은 명령에서 -fsanitize=address,undefined 대신 -fsanitize=thread (make tsan)
+ * 스칼라 커널: 같은 명령에 -DPROBLEMA_NO_SIMD (make test-scalar)
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "problema.h"
+
+static int failures = 0;
+
+#define CHECK(cond)                                                      \
+    do                                                                   \
+    {                                                                    \
+        if (!(cond))                                                     \
+        {                                                                \
+            fprintf(stderr, "%s:%d: 실패: %s\n", __FILE__, __LINE__, #cond); \
+            failures++;                                                  \
+        }                                                                \
+    } while (0)
+
+static const char *sample_text = "프로블레마 Problema 암호화 테스트 문장입니다. 😀 한글과 English가 섞여 있습니다.";
+
+// 고정 키로 컨텍스트 초기화
+void init_context(ProblemaContext *ctx)
+{
+    byte_t key[PROBLEMA_KEY_SIZE];
+    for (int i = 0; i < PROBLEMA_KEY_SIZE; i++)
+    {
+        key[i] = (byte_t)(i * 13 + 5);
+    }
+    memset(ctx, 0, sizeof(*ctx));
+    problema_init(ctx, key);
+}
+
+// 새 컨텍스트로 암호화한 뒤 다른 새 컨텍스트로 복호화 (컨테이너 결과와 비교할 기준)
+size_t serial_roundtrip(const byte_t *text, size_t text_len, byte_t *plain, size_t plain_size)
+{
+    ProblemaContext *enc = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    ProblemaContext *dec = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    init_context(enc);
+    init_context(dec);
+
+    size_t cipher_size = problema_output_bound(text_len);
+    byte_t *cipher = (byte_t *)malloc(cipher_size);
+    size_t cipher_len = 0, plain_len = 0;
+    CHECK(problema_encrypt(enc, text, text_len, cipher, cipher_size, &cipher_len) == PROBLEMA_SUCCESS);
+    CHECK(problema_decrypt(dec, cipher, cipher_len, plain, plain_size, &plain_len) == PROBLEMA_SUCCESS);
+
+    free(cipher);
+    problema_cleanup(enc);
+    problema_cleanup(dec);
+    free(enc);
+    free(dec);
+    return plain_len;
+}
+
+// 컨테이너 왕복 결과가 청크 크기와 관계없이 직렬 처리와 같고, 잘린 컨테이너는 거부되는지 확인
+void test_container_roundtrip()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+
+    const byte_t *text = (const byte_t *)sample_text;
+    size_t text_len = strlen(sample_text);
+    byte_t expected[1024], plain[1024];
+    size_t expected_len = serial_roundtrip(text, text_len, expected, sizeof(expected));
+
+    const uint32_t chunk_sizes[] = {1, 3, 8, 0};
+    for (size_t c = 0; c < sizeof(chunk_sizes) / sizeof(chunk_sizes[0]); c++)
+    {
+        /* 컨테이너 암호화도 problema_encrypt처럼 컨텍스트의 현재 로터 위치에서 시작한다 */
+        init_context(ctx);
+        size_t bound = problema_container_bound(text_len, chunk_sizes[c]);
+        byte_t *container = (byte_t *)malloc(bound);
+        size_t len = 0, out_len = 0;
+        CHECK(problema_container_encrypt(ctx, text, text_len, chunk_sizes[c], container, bound, &len) ==
+              PROBLEMA_SUCCESS);
+        CHECK(len <= bound);
+        CHECK(problema_container_decrypt(ctx, container, len, plain, sizeof(plain), &out_len) ==
+              PROBLEMA_SUCCESS);
+        CHECK(out_len == expected_len && memcmp(plain, expected, out_len) == 0);
+
+        /* 어느 길이로 잘려도 성공하거나 범위 밖을 읽으면 안 된다 */
+        for (size_t cut = 0; cut < len; cut++)
+        {
+            CHECK(problema_container_decrypt(ctx, container, cut, plain, sizeof(plain), &out_len) !=
+                  PROBLEMA_SUCCESS);
+        }
+
+        /* 매직이 다른 데이터 */
+        container[0] ^= 0xFF;
+        CHECK(problema_container_decrypt(ctx, container, len, plain, sizeof(plain), &out_len) ==
+              PROBLEMA_ERROR_INVALID_FORMAT);
+        free(container);
+        problema_cleanup(ctx);
+    }
+
+    free(ctx);
+}
+
+// 컨테이너 크기 상한이 넘치지 않고 SIZE_MAX로 포화되는지 확인
+void test_container_bound()
+{
+    size_t per_chunk = PROBLEMA_CHUNK_HEADER_SIZE + 8;
+    size_t fixed = PROBLEMA_CONTAINER_HEADER_SIZE + PROBLEMA_CONTAINER_FOOTER_SIZE;
+    CHECK(problema_container_bound(0, 0) == fixed);
+    CHECK(problema_container_bound(10, 8) == fixed + 2 * per_chunk + 40);
+    CHECK(problema_container_bound(SIZE_MAX, 0) == SIZE_MAX);
+    CHECK(problema_container_bound(SIZE_MAX / 4, 1) == SIZE_MAX);
+    CHECK(problema_container_bound(SIZE_MAX / 50, 1) == SIZE_MAX);
+    CHECK(problema_container_bound(SIZE_MAX / 4 - fixed, UINT32_MAX) == SIZE_MAX);
+}
+
+// 손상된 청크 인덱스와 청크 헤더가 경계 검사에서 걸러지는지 확인
+void test_malformed_container()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    init_context(ctx);
+
+    size_t text_len = strlen(sample_text);
+    size_t bound = problema_container_bound(text_len, 8);
+    byte_t *container = (byte_t *)malloc(bound);
+    byte_t *plain = (byte_t *)malloc(bound);
+    size_t len = 0, out_len = 0;
+    CHECK(problema_container_encrypt(ctx, (const byte_t *)sample_text, text_len, 8,
+                                     container, bound, &len) == PROBLEMA_SUCCESS);
+
+    ProblemaContainerInfo info;
+    ProblemaChunkInfo chunk;
+    CHECK(problema_container_open(ctx, container, len, &info) == PROBLEMA_SUCCESS);
+    CHECK(info.num_chunks > 1);
+
+    /* 더하면 넘쳐서 경계 안으로 돌아오는 청크 위치 */
+    byte_t *index = container + info.index_offset;
+    byte_t saved[8];
+    memcpy(saved, index, 8);
+    memset(index, 0xFF, 8);
+    index[0] = 0xF0;
+    CHECK(problema_container_chunk(container, len, &info, 0, &chunk) == PROBLEMA_ERROR_INVALID_FORMAT);
+    CHECK(problema_container_decrypt(ctx, container, len, plain, bound, &out_len) ==
+          PROBLEMA_ERROR_INVALID_FORMAT);
+    CHECK(problema_container_decrypt_range(ctx, container, len, 0, 5, plain, bound, &out_len) ==
+          PROBLEMA_ERROR_INVALID_FORMAT);
+    memcpy(index, saved, 8);
+
+    /* 시작 문자 인덱스 + 문자 수가 넘치는 청크 헤더 */
+    byte_t *header = container + PROBLEMA_CONTAINER_HEADER_SIZE;
+    memcpy(saved, header, 8);
+    memset(header, 0xFF, 8);
+    CHECK(problema_container_chunk(container, len, &info, 0, &chunk) == PROBLEMA_ERROR_INVALID_FORMAT);
+    memcpy(header, saved, 8);
+
+    /* 인덱스 위치와 청크 개수가 데이터 밖을 가리키는 헤더 정보 */
+    ProblemaContainerInfo bad = info;
+    bad.index_offset = UINT64_MAX - 4;
+    CHECK(problema_container_chunk(container, len, &bad, 0, &chunk) == PROBLEMA_ERROR_INVALID_FORMAT);
+    bad = info;
+    bad.num_chunks = UINT64_MAX / 8 + 2;
+    CHECK(problema_container_chunk(container, len, &bad, 0, &chunk) == PROBLEMA_ERROR_INVALID_FORMAT);
+
+    /* 페이로드 위치 + 길이가 넘치는 청크 정보 */
+    CHECK(problema_container_chunk(container, len, &info, 0, &chunk) == PROBLEMA_SUCCESS);
+    chunk.payload_offset = UINT64_MAX - 2;
+    CHECK(problema_container_decrypt_chunk(ctx, container, len, &chunk, plain, bound, &out_len) ==
+          PROBLEMA_ERROR_INVALID_FORMAT);
+
+    /* 손상을 되돌리면 다시 정상 복호화 */
+    CHECK(problema_container_decrypt(ctx, container, len, plain, bound, &out_len) == PROBLEMA_SUCCESS);
+
+    /* 페이로드 길이가 32비트를 넘을 수 있는 청크 크기 */
+    CHECK(problema_container_encrypt(ctx, (const byte_t *)sample_text, text_len,
+                                     PROBLEMA_MAX_CHUNK_CHARS + 1, container, bound, &len) ==
+          PROBLEMA_ERROR_OUT_OF_RANGE);
+
+    free(plain);
+    free(container);
+    problema_cleanup(ctx);
+    free(ctx);
+}
+
+// 원본과 맞지 않는 탐색 인덱스 항목이 범위 복호화에서 걸러지는지 확인
+void test_malformed_index()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    init_context(ctx);
+
+    const byte_t *data = (const byte_t *)sample_text;
+    size_t data_len = strlen(sample_text);
+    byte_t plain[1024];
+    size_t out_len = 0;
+    ProblemaSeekIndex index;
+    CHECK(problema_index_build(data, data_len, 4, &index) == PROBLEMA_SUCCESS);
+    CHECK(index.num_entries > 2);
+    CHECK(problema_decrypt_byte_range(ctx, data, data_len, &index, 10, 20, plain, sizeof(plain),
+                                      &out_len) == PROBLEMA_SUCCESS);
+
+    /* 원본 밖을 가리키는 체크포인트 */
+    index.entries[1].byte_offset = UINT64_MAX - 8;
+    CHECK(problema_decrypt_range(ctx, data, data_len, &index, 5, 3, plain, sizeof(plain), &out_len) ==
+          PROBLEMA_ERROR_INVALID_FORMAT);
+    index.entries[0].byte_offset = UINT64_MAX - 8;
+    CHECK(problema_decrypt_byte_range(ctx, data, data_len, &index, 0, 20, plain, sizeof(plain),
+                                      &out_len) == PROBLEMA_ERROR_INVALID_FORMAT);
+
+    /* 다른 길이의 원본에서 만든 인덱스 */
+    index.entries[0].byte_offset = 0;
+    index.total_bytes = data_len + 1;
+    CHECK(problema_decrypt_byte_range(ctx, data, data_len, &index, 0, 20, plain, sizeof(plain),
+                                      &out_len) == PROBLEMA_ERROR_INVALID_FORMAT);
+
+    problema_index_free(&index);
+    problema_cleanup(ctx);
+    free(ctx);
+}
+
+// UTF-8 문자열에서 char_index번째 문자가 시작하는 바이트 위치 (끝을 넘으면 길이)
+size_t utf8_char_offset(const byte_t *text, size_t len, uint64_t char_index)
+{
+    uint64_t chars = 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        if ((text[i] & 0xC0) != 0x80 && chars++ == char_index)
+        {
+            return i;
+        }
+    }
+    return len;
+}
+
+// 문자/바이트 범위 복호화가 인덱스 유무와 관계없이 전체 복호화의 같은 구간과 같은지 확인
+void test_decrypt_range()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    init_context(ctx);
+
+    /* 체크포인트 여러 개를 지나도록 예문을 이어 붙인다 */
+    size_t text_len = strlen(sample_text);
+    size_t repeat = 16;
+    byte_t *text = (byte_t *)malloc(text_len * repeat);
+    for (size_t r = 0; r < repeat; r++)
+    {
+        memcpy(text + r * text_len, sample_text, text_len);
+    }
+    text_len *= repeat;
+
+    size_t bound = problema_output_bound(text_len);
+    byte_t *cipher = (byte_t *)malloc(bound);
+    byte_t *full = (byte_t *)malloc(bound);
+    byte_t *part = (byte_t *)malloc(bound);
+    size_t cipher_len = 0, full_len = 0, part_len = 0;
+    CHECK(problema_encrypt(ctx, text, text_len, cipher, bound, &cipher_len) == PROBLEMA_SUCCESS);
+    init_context(ctx);
+    CHECK(problema_decrypt(ctx, cipher, cipher_len, full, bound, &full_len) == PROBLEMA_SUCCESS);
+
+    ProblemaSeekIndex index;
+    CHECK(problema_index_build(cipher, cipher_len, 16, &index) == PROBLEMA_SUCCESS);
+    uint64_t total_chars = index.total_chars;
+    CHECK(total_chars > 16 * 4);
+
+    const uint64_t starts[] = {0, 1, 15, 16, 17, 100, total_chars - 3, total_chars};
+    for (size_t s = 0; s < sizeof(starts) / sizeof(starts[0]); s++)
+    {
+        uint64_t count = 40;
+        size_t from = utf8_char_offset(full, full_len, starts[s]);
+        size_t to = utf8_char_offset(full, full_len, starts[s] + count);
+
+        /* 인덱스가 있든 없든 결과는 같아야 한다 */
+        for (int use_index = 0; use_index < 2; use_index++)
+        {
+            CHECK(problema_decrypt_range(ctx, cipher, cipher_len, use_index ? &index : NULL, starts[s], count,
+                                         part, bound, &part_len) == PROBLEMA_SUCCESS);
+            CHECK(part_len == to - from && memcmp(part, full + from, part_len) == 0);
+        }
+
+        /* 같은 문자들이 시작하는 바이트 범위 */
+        size_t byte_from = utf8_char_offset(cipher, cipher_len, starts[s]);
+        size_t byte_to = utf8_char_offset(cipher, cipher_len, starts[s] + count);
+        CHECK(problema_decrypt_byte_range(ctx, cipher, cipher_len, &index, byte_from, byte_to - byte_from,
+                                          part, bound, &part_len) == PROBLEMA_SUCCESS);
+        CHECK(part_len == to - from && memcmp(part, full + from, part_len) == 0);
+    }
+
+    problema_index_free(&index);
+    free(part);
+    free(full);
+    free(cipher);
+    free(text);
+    problema_cleanup(ctx);
+    free(ctx);
+}
+
+// 입력을 chunk 바이트씩 스트림에 넣되 stop 바이트를 넘기 전에 멈춤 (출력 길이 반환)
+size_t stream_feed(ProblemaStream *stream, const byte_t *input, size_t input_len, size_t chunk, size_t stop,
+                   byte_t *output, size_t output_size)
+{
+    size_t pos = 0, written = 0;
+    while (pos < input_len && pos < stop)
+    {
+        size_t piece = input_len - pos < chunk ? input_len - pos : chunk;
+        size_t out_len = 0, consumed = 0;
+        CHECK(problema_stream_update(stream, input + pos, piece, output + written, output_size - written,
+                                     &out_len, &consumed) == PROBLEMA_SUCCESS);
+        if (consumed == 0)
+        {
+            break;
+        }
+        pos += consumed;
+        written += out_len;
+    }
+    return written;
+}
+
+// 체크포인트에서 이어 처리한 결과가 중단 없이 한 번에 처리한 결과와 같은지 확인
+void test_stream_resume()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    ProblemaContext *other = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    init_context(ctx);
+    byte_t other_key[PROBLEMA_KEY_SIZE] = {0};
+    problema_init(other, other_key);
+
+    const byte_t *text = (const byte_t *)sample_text;
+    size_t text_len = strlen(sample_text);
+    byte_t cipher[512], expected[512], output[512];
+    size_t cipher_len = 0, expected_len = 0;
+    CHECK(problema_encrypt(ctx, text, text_len, cipher, sizeof(cipher), &cipher_len) == PROBLEMA_SUCCESS);
+    init_context(ctx);
+    CHECK(problema_decrypt(ctx, cipher, cipher_len, expected, sizeof(expected), &expected_len) ==
+          PROBLEMA_SUCCESS);
+    init_context(ctx);
+
+    for (int encrypt = 1; encrypt >= 0; encrypt--)
+    {
+        const byte_t *input = encrypt ? text : cipher;
+        size_t input_len = encrypt ? text_len : cipher_len;
+        const byte_t *reference = encrypt ? cipher : expected;
+        size_t reference_len = encrypt ? cipher_len : expected_len;
+
+        /* 7바이트 조각은 여러 바이트 문자를 중간에서 자른다 */
+        ProblemaStream stream;
+        CHECK(problema_stream_init(&stream, ctx, encrypt) == PROBLEMA_SUCCESS);
+        size_t len = stream_feed(&stream, input, input_len, 7, SIZE_MAX, output, sizeof(output));
+        CHECK(len == reference_len && memcmp(output, reference, len) == 0);
+
+        /* 중간에서 멈추고 체크포인트를 남긴 뒤 새 스트림으로 이어 간다 */
+        byte_t checkpoint[PROBLEMA_CHECKPOINT_SIZE];
+        memset(output, 0, sizeof(output));
+        CHECK(problema_stream_init(&stream, ctx, encrypt) == PROBLEMA_SUCCESS);
+        stream_feed(&stream, input, input_len, 7, input_len / 2, output, sizeof(output));
+        CHECK(problema_stream_checkpoint(&stream, checkpoint) == PROBLEMA_SUCCESS);
+        CHECK(problema_stream_resume(&stream, other, checkpoint, sizeof(checkpoint)) ==
+              PROBLEMA_ERROR_KEY_MISMATCH);
+
+        ProblemaStream resumed;
+        CHECK(problema_stream_resume(&resumed, ctx, checkpoint, sizeof(checkpoint)) == PROBLEMA_SUCCESS);
+        CHECK(resumed.input_offset > 0 && resumed.input_offset < input_len);
+        size_t out_offset = (size_t)resumed.output_offset;
+        len = stream_feed(&resumed, input + resumed.input_offset, input_len - (size_t)resumed.input_offset, 5,
+                          SIZE_MAX, output + out_offset, sizeof(output) - out_offset);
+        CHECK(out_offset + len == reference_len && memcmp(output, reference, reference_len) == 0);
+    }
+
+    problema_cleanup(other);
+    problema_cleanup(ctx);
+    free(other);
+    free(ctx);
+}
+
+// 테스트용 추적 콜백 (호출되면 안 됨)
+void unexpected_trace(const ProblemaTraceEvent *event, void *user)
+{
+    (void)event;
+    (*(int *)user)++;
+}
+
+// 풀에 돌려준 컨텍스트가 다음 사용자에게 기본 설정으로 넘어가는지 확인
+void test_pool_reset()
+{
+    byte_t key[PROBLEMA_KEY_SIZE] = {0};
+    ProblemaContextPool *pool = problema_context_pool_create(key, 1, 0, NULL, 0);
+    CHECK(pool != NULL);
+    if (pool == NULL)
+    {
+        return;
+    }
+
+    ProblemaContext *ctx = NULL;
+    int trace_calls = 0;
+    ProblemaTimeline *timeline = problema_timeline_create(0);
+    CHECK(problema_context_pool_acquire(pool, &ctx) == PROBLEMA_SUCCESS);
+    CHECK(problema_set_block_profile(ctx, PROBLEMA_BLOCK_PROFILE_FULL) == PROBLEMA_SUCCESS);
+    problema_set_trace(ctx, unexpected_trace, &trace_calls);
+    problema_set_timeline(ctx, timeline);
+    problema_set_stats(ctx, true);
+    ProblemaContext *first = ctx;
+    problema_context_pool_release(pool, ctx);
+
+    /* 앞 사용자가 자기 타임라인을 해제한 뒤에도 안전해야 한다 */
+    problema_timeline_destroy(timeline);
+    trace_calls = 0;
+
+    ctx = NULL;
+    CHECK(problema_context_pool_acquire(pool, &ctx) == PROBLEMA_SUCCESS);
+    CHECK(ctx == first);
+    CHECK(ctx->block_profile == PROBLEMA_BLOCK_PROFILE_COMPAT);
+    CHECK(ctx->trace == NULL && ctx->trace_user == NULL);
+    CHECK(ctx->timeline == NULL);
+    CHECK(!ctx->stats_enabled);
+
+    byte_t cipher[256];
+    size_t len = 0;
+    CHECK(problema_encrypt(ctx, (const byte_t *)"pool", 4, cipher, sizeof(cipher), &len) ==
+          PROBLEMA_SUCCESS);
+    CHECK(trace_calls == 0);
+
+    problema_context_pool_release(pool, ctx);
+    problema_context_pool_destroy(pool);
+}
+
+// 다중 블록 API가 블록 단위 함수를 반복 호출한 결과(스칼라 기준)와 같은지 확인
+void check_bulk_blocks(ProblemaContext *ctx, int profile, bool roundtrip)
+{
+    /* AVX2 커널의 두 블록 묶음 뒤에 한 블록이 남도록 홀수 개 */
+    enum { NUM_BLOCKS = 37, SIZE = NUM_BLOCKS * PROBLEMA_BLOCK_SIZE };
+    byte_t data[SIZE], bulk[SIZE], single[SIZE], plain_bulk[SIZE], plain_single[SIZE];
+    for (size_t i = 0; i < SIZE; i++)
+    {
+        data[i] = (byte_t)(i * 29 + 11);
+    }
+
+    CHECK(problema_set_block_profile(ctx, profile) == PROBLEMA_SUCCESS);
+    ProblemaState start, after_bulk, after_single;
+    memset(&start, 0, sizeof(start));
+    memset(&after_bulk, 0, sizeof(after_bulk));
+    memset(&after_single, 0, sizeof(after_single));
+    CHECK(problema_snapshot(ctx, &start) == PROBLEMA_SUCCESS);
+
+    CHECK(problema_encrypt_blocks(ctx, data, bulk, NUM_BLOCKS) == PROBLEMA_SUCCESS);
+    CHECK(problema_snapshot(ctx, &after_bulk) == PROBLEMA_SUCCESS);
+    CHECK(problema_restore(ctx, &start) == PROBLEMA_SUCCESS);
+    for (int b = 0; b < NUM_BLOCKS; b++)
+    {
+        problema_encrypt_block(ctx, data + b * PROBLEMA_BLOCK_SIZE, single + b * PROBLEMA_BLOCK_SIZE);
+    }
+    CHECK(problema_snapshot(ctx, &after_single) == PROBLEMA_SUCCESS);
+    CHECK(memcmp(bulk, single, SIZE) == 0);
+    CHECK(memcmp(after_bulk.feedback, after_single.feedback, PROBLEMA_BLOCK_SIZE) == 0);
+
+    CHECK(problema_restore(ctx, &start) == PROBLEMA_SUCCESS);
+    CHECK(problema_decrypt_blocks(ctx, bulk, plain_bulk, NUM_BLOCKS) == PROBLEMA_SUCCESS);
+    CHECK(problema_restore(ctx, &start) == PROBLEMA_SUCCESS);
+    for (int b = 0; b < NUM_BLOCKS; b++)
+    {
+        problema_decrypt_block(ctx, bulk + b * PROBLEMA_BLOCK_SIZE, plain_single + b * PROBLEMA_BLOCK_SIZE);
+    }
+    CHECK(memcmp(plain_bulk, plain_single, SIZE) == 0);
+    CHECK(!roundtrip || memcmp(plain_bulk, data, SIZE) == 0);
+
+    /* 제자리 복호화도 직전 암호문을 피드백으로 써야 한다 */
+    CHECK(problema_restore(ctx, &start) == PROBLEMA_SUCCESS);
+    memcpy(single, bulk, SIZE);
+    CHECK(problema_decrypt_blocks(ctx, single, single, NUM_BLOCKS) == PROBLEMA_SUCCESS);
+    CHECK(memcmp(single, plain_bulk, SIZE) == 0);
+
+    CHECK(problema_restore(ctx, &start) == PROBLEMA_SUCCESS);
+}
+
+// 전체 라운드 프로필의 다중 블록 결과가 블록 단위 결과와 같고 복호화로 되돌아오는지 확인
+void test_full_profile_blocks()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    init_context(ctx);
+
+    check_bulk_blocks(ctx, PROBLEMA_BLOCK_PROFILE_FULL, true);
+
+    /* 전체 라운드 변환은 호환 프로필의 1라운드 변환과 다른 암호문을 낸다 */
+    byte_t block[PROBLEMA_BLOCK_SIZE] = {0}, compat[PROBLEMA_BLOCK_SIZE], full[PROBLEMA_BLOCK_SIZE];
+    ProblemaState start;
+    CHECK(problema_snapshot(ctx, &start) == PROBLEMA_SUCCESS);
+    problema_encrypt_block(ctx, block, full);
+    CHECK(problema_restore(ctx, &start) == PROBLEMA_SUCCESS);
+    CHECK(problema_set_block_profile(ctx, PROBLEMA_BLOCK_PROFILE_COMPAT) == PROBLEMA_SUCCESS);
+    problema_encrypt_block(ctx, block, compat);
+    CHECK(memcmp(full, compat, sizeof(full)) != 0);
+
+    problema_cleanup(ctx);
+    free(ctx);
+}
+
+// 호환 프로필의 SIMD 커널(AVX2/SSSE3)이 1라운드 스칼라 변환과 같은 결과를 내는지 확인
+// (호환 변환은 원래 복호화로 되돌아오지 않으므로 왕복은 검사하지 않는다)
+void test_simd_blocks()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    init_context(ctx);
+
+    const char *kernel = problema_block_kernel();
+    CHECK(strcmp(kernel, "avx2") == 0 || strcmp(kernel, "ssse3") == 0 || strcmp(kernel, "scalar") == 0);
+    check_bulk_blocks(ctx, PROBLEMA_BLOCK_PROFILE_COMPAT, false);
+
+    problema_cleanup(ctx);
+    free(ctx);
+}
+
+// AES 프로필이 FIPS-197 부록 C.3의 AES-256 벡터를 재현하고 다중 블록 결과가 블록 단위와 같은지 확인
+void test_aes_profile()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    byte_t key[PROBLEMA_KEY_SIZE];
+    for (int i = 0; i < PROBLEMA_KEY_SIZE; i++)
+    {
+        key[i] = (byte_t)i;
+    }
+    problema_init(ctx, key);
+    CHECK(problema_set_block_profile(ctx, PROBLEMA_BLOCK_PROFILE_AES) == PROBLEMA_SUCCESS);
+
+    /* 카운터 블록(논스 || 빅엔디언 블록 번호)을 평문 00112233...eeff로 맞추면 키스트림이 곧 암호문 */
+    const byte_t nonce[PROBLEMA_CTR_NONCE_SIZE] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77};
+    const byte_t expected[PROBLEMA_BLOCK_SIZE] = {0x8e, 0xa2, 0xb7, 0xca, 0x51, 0x67, 0x45, 0xbf,
+                                                  0xea, 0xfc, 0x49, 0x90, 0x4b, 0x49, 0x60, 0x89};
+    byte_t zeros[PROBLEMA_BLOCK_SIZE] = {0}, keystream[PROBLEMA_BLOCK_SIZE];
+    CHECK(problema_ctr_crypt(ctx, nonce, 0x8899aabbccddeeffULL, zeros, keystream, sizeof(zeros)) ==
+          PROBLEMA_SUCCESS);
+    CHECK(memcmp(keystream, expected, sizeof(expected)) == 0);
+
+    const char *kernel = problema_aes_kernel();
+    CHECK(strcmp(kernel, "aesni") == 0 || strcmp(kernel, "table") == 0);
+    check_bulk_blocks(ctx, PROBLEMA_BLOCK_PROFILE_AES, true);
+
+    problema_cleanup(ctx);
+    free(ctx);
+}
+
+// 카운터 모드가 구간을 나눠 처리해도 한 번에 처리한 결과와 같은지 확인
+void test_ctr_split()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    init_context(ctx);
+
+    byte_t nonce[PROBLEMA_CTR_NONCE_SIZE] = {1, 2, 3, 4, 5, 6, 7, 8};
+    byte_t data[1000], whole[1000], split[1000], back[1000];
+    for (size_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = (byte_t)(i * 7 + 3);
+    }
+
+    /* 호환 프로필은 키스트림이 겹칠 수 있어 거부 */
+    CHECK(problema_ctr_crypt(ctx, nonce, 0, data, whole, sizeof(data)) == PROBLEMA_ERROR_INVALID_PROFILE);
+
+    const int profiles[] = {PROBLEMA_BLOCK_PROFILE_FULL, PROBLEMA_BLOCK_PROFILE_AES};
+    for (size_t p = 0; p < sizeof(profiles) / sizeof(profiles[0]); p++)
+    {
+        CHECK(problema_set_block_profile(ctx, profiles[p]) == PROBLEMA_SUCCESS);
+        CHECK(problema_ctr_crypt(ctx, nonce, 0, data, whole, sizeof(data)) == PROBLEMA_SUCCESS);
+        CHECK(memcmp(whole, data, sizeof(data)) != 0);
+
+        /* 블록 경계에서 나눈 구간을 뒤에서부터 처리 */
+        size_t cut = 37 * PROBLEMA_BLOCK_SIZE;
+        CHECK(problema_ctr_crypt(ctx, nonce, cut / PROBLEMA_BLOCK_SIZE, data + cut, split + cut,
+                                 sizeof(data) - cut) == PROBLEMA_SUCCESS);
+        CHECK(problema_ctr_crypt(ctx, nonce, 0, data, split, cut) == PROBLEMA_SUCCESS);
+        CHECK(memcmp(whole, split, sizeof(data)) == 0);
+
+        /* 같은 함수로 제자리 복호화 */
+        memcpy(back, whole, sizeof(back));
+        CHECK(problema_ctr_crypt(ctx, nonce, 0, back, back, sizeof(back)) == PROBLEMA_SUCCESS);
+        CHECK(memcmp(back, data, sizeof(data)) == 0);
+
+        /* 카운터가 넘치는 구간 */
+        CHECK(problema_ctr_crypt(ctx, nonce, UINT64_MAX, data, split, PROBLEMA_BLOCK_SIZE + 1) ==
+              PROBLEMA_ERROR_OUT_OF_RANGE);
+    }
+
+    problema_cleanup(ctx);
+    free(ctx);
+}
+
+// 논스 메시지가 컨텍스트 상태와 처리 순서에 상관없이 같은 결과를 내는지 확인
+void test_nonce_messages()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    init_context(ctx);
+
+    enum { NUM_MESSAGES = 6 };
+    const byte_t *text = (const byte_t *)sample_text;
+    size_t text_len = strlen(sample_text);
+    byte_t nonces[NUM_MESSAGES][PROBLEMA_NONCE_SIZE];
+    byte_t cipher[NUM_MESSAGES][512], plain[NUM_MESSAGES][512];
+    size_t cipher_len[NUM_MESSAGES], plain_len[NUM_MESSAGES];
+    for (int m = 0; m < NUM_MESSAGES; m++)
+    {
+        for (int i = 0; i < PROBLEMA_NONCE_SIZE; i++)
+        {
+            nonces[m][i] = (byte_t)(m * 31 + i);
+        }
+        CHECK(problema_encrypt_nonce(ctx, nonces[m], text, text_len, cipher[m], sizeof(cipher[m]),
+                                     &cipher_len[m]) == PROBLEMA_SUCCESS);
+        CHECK(problema_decrypt_nonce(ctx, nonces[m], cipher[m], cipher_len[m], plain[m], sizeof(plain[m]),
+                                     &plain_len[m]) == PROBLEMA_SUCCESS);
+    }
+    CHECK(cipher_len[0] != cipher_len[1] || memcmp(cipher[0], cipher[1], cipher_len[0]) != 0);
+
+    /* 컨텍스트의 로터를 움직여도 논스 메시지는 영향을 받지 않고, 컨텍스트도 바뀌지 않는다 */
+    byte_t scratch[512];
+    size_t scratch_len = 0;
+    CHECK(problema_encrypt(ctx, text, text_len, scratch, sizeof(scratch), &scratch_len) == PROBLEMA_SUCCESS);
+    ProblemaState before, after;
+    memset(&before, 0, sizeof(before));
+    memset(&after, 0, sizeof(after));
+    CHECK(problema_snapshot(ctx, &before) == PROBLEMA_SUCCESS);
+
+    /* 뒤에서부터 다시 처리 */
+    for (int m = NUM_MESSAGES - 1; m >= 0; m--)
+    {
+        byte_t out[512];
+        size_t out_len = 0;
+        CHECK(problema_encrypt_nonce(ctx, nonces[m], text, text_len, out, sizeof(out), &out_len) ==
+              PROBLEMA_SUCCESS);
+        CHECK(out_len == cipher_len[m] && memcmp(out, cipher[m], out_len) == 0);
+        CHECK(problema_decrypt_nonce(ctx, nonces[m], cipher[m], cipher_len[m], out, sizeof(out), &out_len) ==
+              PROBLEMA_SUCCESS);
+        CHECK(out_len == plain_len[m] && memcmp(out, plain[m], out_len) == 0);
+    }
+    CHECK(problema_snapshot(ctx, &after) == PROBLEMA_SUCCESS);
+    CHECK(memcmp(&before, &after, sizeof(before)) == 0);
+
+    /* 논스가 있는 배치 항목은 problema_encrypt_nonce와 같다 */
+    ProblemaThreadPool *pool = problema_thread_pool_create(3);
+    CHECK(pool != NULL);
+    byte_t batch_out[NUM_MESSAGES][512];
+    ProblemaBatchItem items[NUM_MESSAGES];
+    for (int m = 0; m < NUM_MESSAGES; m++)
+    {
+        items[m] = (ProblemaBatchItem){text, text_len, batch_out[m], sizeof(batch_out[m]), nonces[m], 0, -1};
+    }
+    CHECK(problema_encrypt_batch(ctx, pool, items, NUM_MESSAGES) == PROBLEMA_SUCCESS);
+    for (int m = 0; m < NUM_MESSAGES; m++)
+    {
+        CHECK(items[m].status == PROBLEMA_SUCCESS && items[m].output_len == cipher_len[m] &&
+              memcmp(batch_out[m], cipher[m], cipher_len[m]) == 0);
+    }
+
+    problema_thread_pool_destroy(pool);
+    problema_cleanup(ctx);
+    free(ctx);
+}
+
+// 길이가 고르지 않은 배치를 풀에서 나눠 처리해도 메시지마다 직렬 처리와 같은지 확인
+void test_batch_matches_serial()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    ProblemaContext *serial = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    init_context(ctx);
+
+    enum { NUM_ITEMS = 40 };
+    size_t text_len = strlen(sample_text);
+    size_t max_len = text_len * 8;
+    byte_t *text = (byte_t *)malloc(max_len);
+    for (size_t r = 0; r < 8; r++)
+    {
+        memcpy(text + r * text_len, sample_text, text_len);
+    }
+
+    /* 메시지 길이는 0부터 예문 8개까지 들쭉날쭉하게 (예문 단위라 문자 경계에서 끊긴다) */
+    size_t lens[NUM_ITEMS];
+    for (int i = 0; i < NUM_ITEMS; i++)
+    {
+        lens[i] = (i % 7 == 0) ? max_len : (size_t)(i % 5) * text_len;
+    }
+
+    size_t bound = problema_output_bound(max_len);
+    byte_t *expected = (byte_t *)malloc(NUM_ITEMS * bound);
+    byte_t *pooled = (byte_t *)malloc(NUM_ITEMS * bound);
+    byte_t *inline_out = (byte_t *)malloc(NUM_ITEMS * bound);
+    size_t expected_len[NUM_ITEMS];
+    ProblemaThreadPool *pool = problema_thread_pool_create(4);
+    CHECK(pool != NULL);
+
+    for (int encrypt = 1; encrypt >= 0; encrypt--)
+    {
+        /* 기준: 메시지마다 새로 초기화한 컨텍스트로 한 번씩 처리 */
+        const byte_t *inputs[NUM_ITEMS];
+        size_t input_lens[NUM_ITEMS];
+        byte_t *ciphers = encrypt ? NULL : (byte_t *)malloc(NUM_ITEMS * bound);
+        for (int i = 0; i < NUM_ITEMS; i++)
+        {
+            if (encrypt)
+            {
+                inputs[i] = text;
+                input_lens[i] = lens[i];
+            }
+            else
+            {
+                /* 복호화 입력은 앞 단계의 암호문 */
+                memcpy(ciphers + i * bound, expected + i * bound, expected_len[i]);
+                inputs[i] = ciphers + i * bound;
+                input_lens[i] = expected_len[i];
+            }
+        }
+        for (int i = 0; i < NUM_ITEMS; i++)
+        {
+            init_context(serial);
+            int rc = encrypt ? problema_encrypt(serial, inputs[i], input_lens[i], expected + i * bound, bound,
+                                                &expected_len[i])
+                             : problema_decrypt(serial, inputs[i], input_lens[i], expected + i * bound, bound,
+                                                &expected_len[i]);
+            CHECK(rc == PROBLEMA_SUCCESS);
+            problema_cleanup(serial);
+        }
+
+        ProblemaBatchItem with_pool[NUM_ITEMS], without_pool[NUM_ITEMS];
+        for (int i = 0; i < NUM_ITEMS; i++)
+        {
+            with_pool[i] = (ProblemaBatchItem){inputs[i], input_lens[i], pooled + i * bound, bound, NULL, 0, -1};
+            without_pool[i] =
+                (ProblemaBatchItem){inputs[i], input_lens[i], inline_out + i * bound, bound, NULL, 0, -1};
+        }
+        if (encrypt)
+        {
+            CHECK(problema_encrypt_batch(ctx, pool, with_pool, NUM_ITEMS) == PROBLEMA_SUCCESS);
+            CHECK(problema_encrypt_batch(ctx, NULL, without_pool, NUM_ITEMS) == PROBLEMA_SUCCESS);
+        }
+        else
+        {
+            CHECK(problema_decrypt_batch(ctx, pool, with_pool, NUM_ITEMS) == PROBLEMA_SUCCESS);
+            CHECK(problema_decrypt_batch(ctx, NULL, without_pool, NUM_ITEMS) == PROBLEMA_SUCCESS);
+        }
+        for (int i = 0; i < NUM_ITEMS; i++)
+        {
+            CHECK(with_pool[i].status == PROBLEMA_SUCCESS && with_pool[i].output_len == expected_len[i] &&
+                  memcmp(with_pool[i].output, expected + i * bound, expected_len[i]) == 0);
+            CHECK(without_pool[i].status == PROBLEMA_SUCCESS && without_pool[i].output_len == expected_len[i] &&
+                  memcmp(without_pool[i].output, expected + i * bound, expected_len[i]) == 0);
+        }
+        free(ciphers);
+    }
+
+    /* 출력 버퍼가 작은 메시지는 그 항목만 실패한다 */
+    byte_t small[4];
+    ProblemaBatchItem mixed[2] = {{text, max_len, small, sizeof(small), NULL, 0, -1},
+                                  {text, text_len, pooled, bound, NULL, 0, -1}};
+    CHECK(problema_encrypt_batch(ctx, pool, mixed, 2) == PROBLEMA_SUCCESS);
+    CHECK(mixed[0].status == PROBLEMA_ERROR_BUFFER_TOO_SMALL);
+    CHECK(mixed[1].status == PROBLEMA_SUCCESS);
+
+    problema_thread_pool_destroy(pool);
+    free(inline_out);
+    free(pooled);
+    free(expected);
+    free(text);
+    problema_cleanup(ctx);
+    free(serial);
+    free(ctx);
+}
+
+// 성능 카운터가 직렬 처리와 풀의 보조 스레드가 처리한 배치를 모두 세는지 확인
+void test_stats()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    init_context(ctx);
+
+    enum { NUM_ITEMS = 64 };
+    size_t text_len = strlen(sample_text);
+    uint64_t text_chars = 0;
+    for (size_t i = 0; i < text_len; i++)
+    {
+        text_chars += ((byte_t)sample_text[i] & 0xC0) != 0x80;
+    }
+
+    ProblemaStats stats;
+    byte_t out[512];
+    size_t out_len = 0;
+
+    /* 수집을 켜지 않은 컨텍스트는 세지 않는다 */
+    problema_reset_stats();
+    CHECK(problema_encrypt(ctx, (const byte_t *)sample_text, text_len, out, sizeof(out), &out_len) ==
+          PROBLEMA_SUCCESS);
+    CHECK(problema_get_stats(&stats) == PROBLEMA_SUCCESS);
+    CHECK(stats.chars == 0);
+
+    problema_set_stats(ctx, true);
+    CHECK(problema_encrypt(ctx, (const byte_t *)sample_text, text_len, out, sizeof(out), &out_len) ==
+          PROBLEMA_SUCCESS);
+    CHECK(problema_get_stats(&stats) == PROBLEMA_SUCCESS);
+    CHECK(stats.chars == text_chars);
+    CHECK(stats.rotor_steps[0] == text_chars);
+    CHECK(stats.utf8_decoded[0] + stats.utf8_decoded[1] + stats.utf8_decoded[2] + stats.utf8_decoded[3] ==
+          text_chars);
+
+    /* 보조 스레드가 처리한 배치 항목도 제출한 스레드의 카운터에 더해진다 */
+    ProblemaThreadPool *pool = problema_thread_pool_create(4);
+    CHECK(pool != NULL);
+    ProblemaBatchItem items[NUM_ITEMS];
+    byte_t *outputs = (byte_t *)malloc((size_t)NUM_ITEMS * sizeof(out));
+    for (int i = 0; i < NUM_ITEMS; i++)
+    {
+        items[i] = (ProblemaBatchItem){(const byte_t *)sample_text, text_len, outputs + i * sizeof(out),
+                                       sizeof(out), NULL, 0, 0};
+    }
+    problema_reset_stats();
+    CHECK(problema_encrypt_batch(ctx, pool, items, NUM_ITEMS) == PROBLEMA_SUCCESS);
+    CHECK(problema_get_stats(&stats) == PROBLEMA_SUCCESS);
+    CHECK(stats.chars == NUM_ITEMS * text_chars);
+
+    /* 두 번째 배치는 첫 배치의 보조 스레드 카운터를 다시 더하지 않는다 */
+    problema_reset_stats();
+    CHECK(problema_encrypt_batch(ctx, pool, items, NUM_ITEMS) == PROBLEMA_SUCCESS);
+    CHECK(problema_get_stats(&stats) == PROBLEMA_SUCCESS);
+    CHECK(stats.chars == NUM_ITEMS * text_chars);
+
+    /* 블록 API */
+    byte_t blocks[4 * PROBLEMA_BLOCK_SIZE] = {0};
+    CHECK(problema_set_block_profile(ctx, PROBLEMA_BLOCK_PROFILE_FULL) == PROBLEMA_SUCCESS);
+    problema_reset_stats();
+    CHECK(problema_encrypt_blocks(ctx, blocks, blocks, 4) == PROBLEMA_SUCCESS);
+    CHECK(problema_get_stats(&stats) == PROBLEMA_SUCCESS);
+    CHECK(stats.blocks == 4 && stats.chars == 0);
+
+    problema_reset_stats();
+    problema_thread_pool_destroy(pool);
+    free(outputs);
+    problema_cleanup(ctx);
+    free(ctx);
+}
+
+// 추적 싱크에 이벤트를 기록하는 스레드 본체
+void *log_sink_writer(void *arg)
+{
+    ProblemaTraceEvent event = {PROBLEMA_TRACE_MESSAGE, "writer", 0, NULL, NULL, 0, 0};
+    for (int i = 0; i < 10; i++)
+    {
+        problema_log_sink_trace(&event, arg);
+    }
+    return NULL;
+}
+
+// 추적 싱크가 버린/건너뛴/기록한 이벤트를 빠짐없이 세고, 끝난 스레드의 링을 다시 쓰는지 확인
+void test_log_sink()
+{
+    FILE *out = tmpfile();
+    CHECK(out != NULL);
+    if (out == NULL)
+    {
+        return;
+    }
+
+    /* 작은 링에 버리는 모드로 몰아 넣어도 기록 + 버림 = 전체 */
+    ProblemaLogSink *sink = problema_log_sink_create(out, 2, 1, 0);
+    CHECK(sink != NULL);
+    ProblemaTraceEvent event = {PROBLEMA_TRACE_MESSAGE, "overflow", 0, NULL, NULL, 0, 0};
+    for (int i = 0; i < 10000; i++)
+    {
+        problema_log_sink_trace(&event, sink);
+    }
+    problema_log_sink_flush(sink);
+    ProblemaLogSinkStats stats;
+    problema_log_sink_stats(sink, &stats);
+    CHECK(stats.recorded + stats.dropped == 10000);
+    CHECK(stats.written == stats.recorded);
+    CHECK(stats.sampled_out == 0 && stats.threads == 1);
+    problema_log_sink_destroy(sink);
+
+    /* 표본 추출: 문자 단위 4개마다 하나 */
+    sink = problema_log_sink_create(out, 0, 4, 0);
+    CHECK(sink != NULL);
+    event.stage = PROBLEMA_TRACE_CHAR_IN;
+    for (int i = 0; i < 100; i++)
+    {
+        problema_log_sink_trace(&event, sink);
+    }
+    problema_log_sink_flush(sink);
+    problema_log_sink_stats(sink, &stats);
+    CHECK(stats.recorded == 25 && stats.sampled_out == 75 && stats.dropped == 0);
+    problema_log_sink_destroy(sink);
+
+    /* 최대 스레드 수보다 많은 스레드가 차례로 기록해도 끝난 스레드의 링을 이어 쓴다 */
+    sink = problema_log_sink_create(out, 0, 1, PROBLEMA_LOG_SINK_BLOCK);
+    CHECK(sink != NULL);
+    int num_threads = 2 * PROBLEMA_LOG_SINK_MAX_THREADS;
+    for (int t = 0; t < num_threads; t++)
+    {
+        /* 스택 크기를 늘려 가며 만들어 끝난 스레드의 스택(과 pthread_t)을 재사용하지 않게 한다 */
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setstacksize(&attr, (size_t)(256 + 16 * t) * 1024);
+        pthread_t thread;
+        CHECK(pthread_create(&thread, &attr, log_sink_writer, sink) == 0);
+        pthread_join(thread, NULL);
+        pthread_attr_destroy(&attr);
+    }
+    problema_log_sink_flush(sink);
+    problema_log_sink_stats(sink, &stats);
+    CHECK(stats.dropped == 0);
+    CHECK(stats.recorded == (uint64_t)num_threads * 10);
+    CHECK(stats.written == stats.recorded);
+    CHECK(stats.threads < (size_t)PROBLEMA_LOG_SINK_MAX_THREADS);
+    problema_log_sink_destroy(sink);
+
+    fclose(out);
+}
+
+// 여러 스레드가 공유하는 컨텍스트와 풀, 기준 결과
+typedef struct
+{
+    const ProblemaContext *ctx;
+    ProblemaThreadPool *pool;
+    const byte_t *cursor_ref; // 커서 암호화 결과
+    size_t cursor_ref_len;
+    const byte_t *ctr_ref;    // 카운터 모드 결과 (CTR_TEST_SIZE 바이트)
+    const byte_t *batch_ref;  // 배치 항목 하나의 결과 (항목마다 같다)
+    size_t batch_ref_len;
+    int mismatches;           // 기준과 다른 결과 수 (스레드마다 따로 세어 합친다)
+} SharedRun;
+
+#define CTR_TEST_SIZE 4096
+#define SHARED_BATCH_ITEMS 8
+
+// 공유 컨텍스트 작업 스레드: 자기 커서, 카운터 모드 구간, 공유 풀 배치를 번갈아 실행
+void *shared_worker(void *arg)
+{
+    SharedRun *run = (SharedRun *)arg;
+    size_t text_len = strlen(sample_text);
+    byte_t out[512];
+    byte_t *ctr_in = (byte_t *)calloc(1, CTR_TEST_SIZE);
+    byte_t *ctr_out = (byte_t *)malloc(CTR_TEST_SIZE);
+    byte_t *batch_out = (byte_t *)malloc(SHARED_BATCH_ITEMS * sizeof(out));
+    byte_t nonce[PROBLEMA_CTR_NONCE_SIZE] = {9, 8, 7, 6, 5, 4, 3, 2};
+    int mismatches = 0;
+
+    for (int round = 0; round < 20; round++)
+    {
+        ProblemaCursor cursor;
+        size_t out_len = 0;
+        problema_cursor_init(&cursor, run->ctx);
+        if (problema_cursor_encrypt(&cursor, (const byte_t *)sample_text, text_len, out, sizeof(out),
+                                    &out_len) != PROBLEMA_SUCCESS ||
+            out_len != run->cursor_ref_len || memcmp(out, run->cursor_ref, out_len) != 0)
+        {
+            mismatches++;
+        }
+
+        /* 스레드와 회차마다 다른 블록 구간 */
+        size_t block = (size_t)(round * 7) % (CTR_TEST_SIZE / PROBLEMA_BLOCK_SIZE);
+        size_t offset = block * PROBLEMA_BLOCK_SIZE;
+        if (problema_ctr_crypt(run->ctx, nonce, block, ctr_in + offset, ctr_out + offset,
+                               CTR_TEST_SIZE - offset) != PROBLEMA_SUCCESS ||
+            memcmp(ctr_out + offset, run->ctr_ref + offset, CTR_TEST_SIZE - offset) != 0)
+        {
+            mismatches++;
+        }
+
+        ProblemaBatchItem items[SHARED_BATCH_ITEMS];
+        for (int i = 0; i < SHARED_BATCH_ITEMS; i++)
+        {
+            items[i] = (ProblemaBatchItem){(const byte_t *)sample_text, text_len, batch_out + i * sizeof(out),
+                                           sizeof(out), NULL, 0, 0};
+        }
+        problema_encrypt_batch(run->ctx, run->pool, items, SHARED_BATCH_ITEMS);
+        for (int i = 0; i < SHARED_BATCH_ITEMS; i++)
+        {
+            if (items[i].status != PROBLEMA_SUCCESS || items[i].output_len != run->batch_ref_len ||
+                memcmp(items[i].output, run->batch_ref, run->batch_ref_len) != 0)
+            {
+                mismatches++;
+            }
+        }
+
+        /* 유효하지 않은 UTF-8은 자기 스레드의 디버그 설정만 읽는다 */
+        unicode_t codes[4];
+        size_t num_codes = 0;
+        const byte_t invalid[] = {0xC3, 0x28};
+        if (utf8_to_unicode(invalid, sizeof(invalid), codes, 4, &num_codes) != PROBLEMA_ERROR_INVALID_UTF8)
+        {
+            mismatches++;
+        }
+    }
+
+    __atomic_fetch_add(&run->mismatches, mismatches, __ATOMIC_RELAXED);
+    free(batch_out);
+    free(ctr_out);
+    free(ctr_in);
+    return NULL;
+}
+
+// 다른 스레드가 일하는 동안 자기 스레드의 디버그 출력을 켜고 끄는 스레드
+void *debug_toggler(void *arg)
+{
+    (void)arg;
+    for (int i = 0; i < 4; i++)
+    {
+        problema_set_debug(true);
+        problema_set_debug(false);
+    }
+    return NULL;
+}
+
+// 컨텍스트 하나를 커서, 카운터 모드, 풀로 여러 스레드가 동시에 써도 결과가 같은지 확인
+// (make tsan으로 ThreadSanitizer 빌드에서 실행하면 경합도 검사한다)
+void test_shared_context_threads()
+{
+    ProblemaContext *ctx = (ProblemaContext *)calloc(1, sizeof(ProblemaContext));
+    init_context(ctx);
+    CHECK(problema_set_block_profile(ctx, PROBLEMA_BLOCK_PROFILE_FULL) == PROBLEMA_SUCCESS);
+
+    size_t text_len = strlen(sample_text);
+    byte_t cursor_ref[512], batch_ref[512];
+    byte_t *ctr_in = (byte_t *)calloc(1, CTR_TEST_SIZE);
+    byte_t *ctr_ref = (byte_t *)malloc(CTR_TEST_SIZE);
+    byte_t nonce[PROBLEMA_CTR_NONCE_SIZE] = {9, 8, 7, 6, 5, 4, 3, 2};
+    SharedRun run = {ctx, problema_thread_pool_create(3), cursor_ref, 0, ctr_ref, batch_ref, 0, 0};
+    CHECK(run.pool != NULL);
+
+    /* 기준 결과는 스레드를 띄우기 전에 한 스레드에서 만든다 */
+    ProblemaCursor cursor;
+    CHECK(problema_cursor_init(&cursor, ctx) == PROBLEMA_SUCCESS);
+    CHECK(problema_cursor_encrypt(&cursor, (const byte_t *)sample_text, text_len, cursor_ref,
+                                  sizeof(cursor_ref), &run.cursor_ref_len) == PROBLEMA_SUCCESS);
+    CHECK(problema_ctr_crypt(ctx, nonce, 0, ctr_in, ctr_ref, CTR_TEST_SIZE) == PROBLEMA_SUCCESS);
+    ProblemaBatchItem item = {(const byte_t *)sample_text, text_len, batch_ref, sizeof(batch_ref), NULL, 0, 0};
+    CHECK(problema_encrypt_batch(ctx, NULL, &item, 1) == PROBLEMA_SUCCESS && item.status == PROBLEMA_SUCCESS);
+    run.batch_ref_len = item.output_len;
+
+    enum { NUM_WORKERS = 4 };
+    pthread_t workers[NUM_WORKERS], toggler;
+    for (int t = 0; t < NUM_WORKERS; t++)
+    {
+        CHECK(pthread_create(&workers[t], NULL, shared_worker, &run) == 0);
+    }
+    CHECK(pthread_create(&toggler, NULL, debug_toggler, NULL) == 0);
+    pthread_join(toggler, NULL);
+    for (int t = 0; t < NUM_WORKERS; t++)
+    {
+        pthread_join(workers[t], NULL);
+    }
+    CHECK(run.mismatches == 0);
+
+    problema_thread_pool_destroy(run.pool);
+    free(ctr_ref);
+    free(ctr_in);
+    problema_cleanup(ctx);
+    free(ctx);
+}
+
+// 0으로 채우지 않은 직접 선언 컨텍스트도 메모리 사용량이 올바르게 보고되는지 확인
+void test_stack_context_memory()
+{
+    byte_t key[PROBLEMA_KEY_SIZE] = {0};
+    ProblemaContext *ctx = (ProblemaContext *)malloc(sizeof(ProblemaContext));
+    memset(ctx, 0xAB, sizeof(ProblemaContext));
+    CHECK(problema_init(ctx, key) == PROBLEMA_SUCCESS);
+
+    ProblemaMemoryUsage usage;
+    CHECK(problema_memory_usage(ctx, &usage) == PROBLEMA_SUCCESS);
+    CHECK(usage.allocated_bytes == usage.context_bytes);
+    for (int i = 0; i < PROBLEMA_MEMORY_REGIONS; i++)
+    {
+        CHECK((usage.regions[i].flags & PROBLEMA_MEMORY_HUGE_PAGES) == 0);
+    }
+    problema_cleanup(ctx);
+    free(ctx);
+
+    /* problema_context_new는 problema_init 뒤에 할당 정보를 채운다 */
+    ProblemaContext *heap = NULL;
+    CHECK(problema_context_new(&heap, key, NULL, 0) == PROBLEMA_SUCCESS);
+    CHECK(problema_memory_usage(heap, &usage) == PROBLEMA_SUCCESS);
+    CHECK(usage.allocated_bytes >= usage.context_bytes && heap->alloc_size == usage.allocated_bytes);
+    problema_context_free(heap);
+}
+
+int main()
+{
+    test_container_roundtrip();
+    test_container_bound();
+    test_malformed_container();
+    test_malformed_index();
+    test_decrypt_range();
+    test_stream_resume();
+    test_pool_reset();
+    test_full_profile_blocks();
+    test_simd_blocks();
+    test_aes_profile();
+    test_ctr_split();
+    test_nonce_messages();
+    test_batch_matches_serial();
+    test_stats();
+    test_log_sink();
+    test_shared_context_threads();
+    test_stack_context_memory();
+
+    if (failures > 0)
+    {
+        fprintf(stderr, "실패 %d건\n", failures);
+        return 1;
+    }
+    printf("모든 테스트 통과\n");
+    return 0;
+}